@@ -62,6 +62,10 @@ void arch_lmb_reserve(struct lmb *lmb)
 	sp -= 4096;
 	lmb_reserve(lmb, sp,
 		    gd->bd->bi_dram[0].start + gd->bd->bi_dram[0].size - sp);
+#ifdef CONFIG_SKIP_RELOCATE_UBOOT
+	/* U-Boot itself is still where it was loaded, below the stack */
+	lmb_reserve(lmb, gd->relocaddr, gd->mon_len);
+#endif
 }
 
 /**
@@ -4,8 +4,10 @@
  */
 #define DEBUG
 #include <common.h>
+#include <errno.h>
 #include <dm/root.h>
 #include <os.h>
+#include <trace.h>
 #include <asm/io.h>
 #include <asm/state.h>
 
@@ -43,6 +45,12 @@ void __udelay(unsigned long usec)
 		os_usleep(usec);
 }
 
+int cpu_run_parallel(void (*func)(void *priv, int index), void *priv,
+		     int count)
+{
+	return os_run_parallel(func, priv, count);
+}
+
 int cleanup_before_linux(void)
 {
 	return 0;
@@ -136,3 +144,26 @@ done:
 
 	return 0;
 }
+
+ulong timer_get_boot_us(void)
+{
+	static uint64_t base_count;
+	uint64_t count = os_get_nsec();
+
+	if (!base_count)
+		base_count = count;
+
+	return (count - base_count) / 1000;
+}
+
+#ifdef CONFIG_PROFILER
+int arch_profile_start(unsigned int interval_us)
+{
+	return os_profile_start(interval_us, profile_sample);
+}
+
+void arch_profile_stop(void)
+{
+	os_profile_stop();
+}
+#endif
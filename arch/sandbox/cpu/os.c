@@ -5,8 +5,11 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <execinfo.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -184,7 +187,14 @@ void *os_realloc(void *ptr, size_t length)
 
 void os_usleep(unsigned long usec)
 {
-	usleep(usec);
+	struct timespec req, rem;
+
+	req.tv_sec = usec / 1000000;
+	req.tv_nsec = (usec % 1000000) * 1000;
+
+	/* Signals such as the profiler's SIGPROF cut the sleep short */
+	while (nanosleep(&req, &rem) == -1 && errno == EINTR)
+		req = rem;
 }
 
 uint64_t __attribute__((no_instrument_function)) os_get_nsec(void)
@@ -557,3 +567,133 @@ void os_localtime(struct rtc_time *rt)
 	rt->tm_yday = tm->tm_yday;
 	rt->tm_isdst = tm->tm_isdst;
 }
+
+/* Maximum number of threads used by os_run_parallel() */
+#define OS_MAX_THREADS	8
+
+struct os_parallel {
+	void (*func)(void *priv, int index);
+	void *priv;
+	int count;
+	int next;	/* next job to hand out */
+};
+
+static void *os_parallel_thread(void *arg)
+{
+	struct os_parallel *par = arg;
+	int index;
+
+	while ((index = __sync_fetch_and_add(&par->next, 1)) < par->count)
+		par->func(par->priv, index);
+
+	return NULL;
+}
+
+int os_run_parallel(void (*func)(void *priv, int index), void *priv,
+		    int count)
+{
+	pthread_t threads[OS_MAX_THREADS - 1];
+	sigset_t mask, old_mask;
+	struct os_parallel par;
+	int nthreads, i;
+
+	par.func = func;
+	par.priv = priv;
+	par.count = count;
+	par.next = 0;
+
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads > OS_MAX_THREADS)
+		nthreads = OS_MAX_THREADS;
+	if (nthreads > count)
+		nthreads = count;
+
+	/* Leave profiler samples to the main thread */
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGPROF);
+	pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+
+	/* The calling thread does its share of the work too */
+	for (i = 0; i < nthreads - 1; i++) {
+		if (pthread_create(&threads[i], NULL, os_parallel_thread, &par))
+			break;
+	}
+	pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+	os_parallel_thread(&par);
+	nthreads = i + 1;
+	while (i--)
+		pthread_join(threads[i], NULL);
+
+	return nthreads;
+}
+
+/* Stack frames of the signal handler and the kernel's signal return */
+#define OS_PROFILE_SKIP		2
+#define OS_PROFILE_DEPTH	8
+
+static void (*os_profile_func)(void *const *addrs, int count);
+static timer_t os_profile_timer;
+static bool os_profile_timer_valid;
+
+static void os_profile_handler(int sig)
+{
+	void *addrs[OS_PROFILE_SKIP + OS_PROFILE_DEPTH];
+	int saved_errno = errno;
+	int count;
+
+	count = backtrace(addrs, OS_PROFILE_SKIP + OS_PROFILE_DEPTH);
+	if (count > OS_PROFILE_SKIP)
+		os_profile_func(addrs + OS_PROFILE_SKIP,
+				count - OS_PROFILE_SKIP);
+	errno = saved_errno;
+}
+
+int os_profile_start(unsigned int interval_us,
+		     void (*func)(void *const *addrs, int count))
+{
+	struct itimerspec its;
+	struct sigaction act;
+	struct sigevent sev;
+	void *addr;
+
+	/*
+	 * The first backtrace() loads the unwinder, which allocates memory
+	 * and so must not happen in the signal handler
+	 */
+	backtrace(&addr, 1);
+
+	os_profile_func = func;
+	memset(&act, '\0', sizeof(act));
+	act.sa_handler = os_profile_handler;
+	act.sa_flags = SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	if (sigaction(SIGPROF, &act, NULL))
+		return -errno;
+
+	if (!os_profile_timer_valid) {
+		memset(&sev, '\0', sizeof(sev));
+		sev.sigev_notify = SIGEV_SIGNAL;
+		sev.sigev_signo = SIGPROF;
+		if (timer_create(CLOCK_MONOTONIC, &sev, &os_profile_timer))
+			return -errno;
+		os_profile_timer_valid = true;
+	}
+
+	its.it_interval.tv_sec = interval_us / 1000000;
+	its.it_interval.tv_nsec = (interval_us % 1000000) * 1000;
+	its.it_value = its.it_interval;
+	if (timer_settime(os_profile_timer, 0, &its, NULL))
+		return -errno;
+
+	return 0;
+}
+
+void os_profile_stop(void)
+{
+	struct itimerspec its;
+
+	if (!os_profile_timer_valid)
+		return;
+	memset(&its, '\0', sizeof(its));
+	timer_settime(os_profile_timer, 0, &its, NULL);
+}
@@ -8,6 +8,7 @@
 #include <os.h>
 #include <cli.h>
 #include <malloc.h>
+#include <trace.h>
 #include <asm/getopt.h>
 #include <asm/io.h>
 #include <asm/sections.h>
@@ -81,6 +82,10 @@ int sandbox_main_loop_init(void)
 	if (state->cmd || state->run_distro_boot) {
 		int retval = 0;
 
+#ifdef CONFIG_PROFILER_BOOT
+		/* The boot is over, so don't sample the commands */
+		profile_stop();
+#endif
 		cli_init();
 
 		if (state->cmd)
@@ -14,4 +14,48 @@ void sandbox_eth_disable_response(int index, bool disable);
 
 void sandbox_eth_skip_timeout(void);
 
+void sandbox_eth_disable_rx_dest(bool disable);
+
+ulong sandbox_eth_get_rx_placed(void);
+
+/**
+ * struct sandbox_eth_tftp_stats - packets handled by the mock TFTP server
+ *
+ * @data: Number of DATA packets sent
+ * @acks: Number of ACK packets received
+ * @dropped: Number of DATA packets dropped on purpose
+ */
+struct sandbox_eth_tftp_stats {
+	ulong data;
+	ulong acks;
+	ulong dropped;
+};
+
+void sandbox_eth_tftp_set_file(const void *data, ulong size,
+			       int max_windowsize, ulong drop_block);
+
+void sandbox_eth_tftp_send_arp(bool send);
+
+void sandbox_eth_tftp_get_stats(struct sandbox_eth_tftp_stats *stats);
+
+/**
+ * struct sandbox_eth_nfs_stats - READ requests handled by the mock NFS server
+ *
+ * @reads: Number of READ requests
+ * @max_in_flight: Largest number of READ requests waiting for a reply
+ * @max_count: Largest number of bytes asked for by a READ request
+ * @version: NFS version of the last READ request
+ */
+struct sandbox_eth_nfs_stats {
+	ulong reads;
+	ulong max_in_flight;
+	ulong max_count;
+	int version;
+};
+
+void sandbox_eth_nfs_set_file(const void *data, ulong size, int max_version,
+			      bool reorder);
+
+void sandbox_eth_nfs_get_stats(struct sandbox_eth_nfs_stats *stats);
+
 #endif /* __ETH_H */
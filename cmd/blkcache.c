@@ -0,0 +1,86 @@
+/*
+ * Show and configure the block device cache
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <blk.h>
+
+static int blkc_show(cmd_tbl_t *cmdtp, int flag, int argc,
+		     char * const argv[])
+{
+	struct block_cache_stats stats;
+	unsigned total;
+
+	blkcache_stats(&stats);
+	total = stats.hits + stats.misses;
+
+	printf("    hits: %u\n"
+	       "    misses: %u\n"
+	       "    hit rate: %u%%\n"
+	       "    readahead: %u blocks\n"
+	       "    entries: %u\n"
+	       "    max blocks/entry: %u\n"
+	       "    max cache entries: %u\n"
+	       "    readahead window: %u blocks\n",
+	       stats.hits, stats.misses,
+	       total ? stats.hits * 100 / total : 0, stats.readahead,
+	       stats.entries, stats.max_blocks_per_entry, stats.max_entries,
+	       stats.readahead_blocks);
+
+	return 0;
+}
+
+static int blkc_configure(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	struct block_cache_stats stats;
+	unsigned blocks, entries, readahead;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	blkcache_stats(&stats);
+	blocks = simple_strtoul(argv[1], NULL, 0);
+	entries = simple_strtoul(argv[2], NULL, 0);
+	readahead = argc > 3 ? simple_strtoul(argv[3], NULL, 0) :
+		stats.readahead_blocks;
+	blkcache_configure(blocks, entries, readahead);
+	printf("changed to max of %u entries of %u blocks each, readahead %u\n",
+	       entries, blocks, readahead);
+
+	return 0;
+}
+
+static cmd_tbl_t cmd_blkc_sub[] = {
+	U_BOOT_CMD_MKENT(show, 0, 0, blkc_show, "", ""),
+	U_BOOT_CMD_MKENT(configure, 4, 0, blkc_configure, "", ""),
+};
+
+static int do_blkcache(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	cmd_tbl_t *c;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* Strip off leading 'blkcache' command argument */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], cmd_blkc_sub, ARRAY_SIZE(cmd_blkc_sub));
+	if (c)
+		return c->cmd(cmdtp, flag, argc, argv);
+	else
+		return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(blkcache, 5, 0, do_blkcache,
+	"block cache diagnostics and control",
+	"show - show statistics and settings\n"
+	"blkcache configure <blocks> <entries> [<readahead>] - set cache size\n"
+	"    (this empties the cache and resets the counters)"
+);
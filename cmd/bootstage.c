@@ -9,7 +9,28 @@
 static int do_bootstage_report(cmd_tbl_t *cmdtp, int flag, int argc,
 			       char * const argv[])
 {
-	bootstage_report();
+	bool initcalls = false, csv = false, json = false;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--initcalls"))
+			initcalls = true;
+		else if (!strcmp(argv[i], "--csv"))
+			csv = true;
+		else if (!strcmp(argv[i], "--json"))
+			json = true;
+		else
+			return CMD_RET_USAGE;
+	}
+	if ((csv && !initcalls) || (json && (initcalls || csv)))
+		return CMD_RET_USAGE;
+
+	if (json)
+		bootstage_report_json();
+	else if (initcalls)
+		bootstage_report_initcalls(csv);
+	else
+		bootstage_report();
 
 	return 0;
 }
@@ -59,7 +80,7 @@ static int do_bootstage_stash(cmd_tbl_t *cmdtp, int flag, int argc,
 }
 
 static cmd_tbl_t cmd_bootstage_sub[] = {
-	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
+	U_BOOT_CMD_MKENT(report, 3, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
 };
@@ -90,6 +111,10 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	"Boot stage command",
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
+	"report --initcalls [--csv]  - Print the time taken by each initcall,\n"
+	"                              optionally as comma-separated values\n"
+	"report --json               - Print marks and initcalls in Chrome\n"
+	"                              trace-event format\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
 	"unstash [<start> [<size>]]  - Unstash data from memory"
 );
@@ -27,12 +27,14 @@ U_BOOT_CMD(
 static int do_load_wrapper(cmd_tbl_t *cmdtp, int flag, int argc,
 				char * const argv[])
 {
-	efi_set_bootdev(argv[1], (argc > 2) ? argv[2] : "");
+	int dev = (argc > 3 && !strcmp(argv[1], "-z")) ? 3 : 1;
+
+	efi_set_bootdev(argv[dev], (argc > dev + 1) ? argv[dev + 1] : "");
 	return do_load(cmdtp, flag, argc, argv, FS_TYPE_ANY);
 }
 
 U_BOOT_CMD(
-	load,	7,	0,	do_load_wrapper,
+	load,	9,	0,	do_load_wrapper,
 	"load binary file from a filesystem",
 	"<interface> [<dev[:part]> [<addr> [<filename> [bytes [pos]]]]]\n"
 	"    - Load binary file 'filename' from partition 'part' on device\n"
@@ -41,6 +43,13 @@ U_BOOT_CMD(
 	"      If 'bytes' is 0 or omitted, the file is read until the end.\n"
 	"      'pos' gives the file byte position to start reading from.\n"
 	"      If 'pos' is 0 or omitted, the file is read from the start."
+#ifdef CONFIG_CMD_BOOTM
+	"\nload -z <comp> <interface> <dev[:part]> <addr> <filename>\n"
+	"    [bytes [pos]]\n"
+	"    - Load and decompress file 'filename' as it is read, where\n"
+	"      'comp' is gzip, lzma, lz4 or none. 'bytes' gives the maximum\n"
+	"      decompressed size."
+#endif
 )
 
 static int do_save_wrapper(cmd_tbl_t *cmdtp, int flag, int argc,
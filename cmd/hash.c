@@ -12,14 +12,33 @@
 
 #include <common.h>
 #include <command.h>
+#include <errno.h>
 #include <hash.h>
 #include <linux/ctype.h>
 
+/* Default number of bytes hashed by 'hash bench' */
+#define HASH_BENCH_SIZE		(4 << 20)
+
 static int do_hash(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	char *s;
 	int flags = HASH_FLAG_ENV;
 
+	if (argc >= 2 && !strcmp(argv[1], "bench")) {
+		ulong size = HASH_BENCH_SIZE;
+		int ret;
+
+		if (argc > 2)
+			size = simple_strtoul(argv[2], NULL, 16);
+		ret = hash_bench(size);
+		if (ret) {
+			printf("%s %#lx bytes\n", ret == -EINVAL ?
+			       "Cannot hash" : "Cannot allocate", size);
+			return CMD_RET_FAILURE;
+		}
+		return CMD_RET_SUCCESS;
+	}
+
 #ifdef CONFIG_HASH_VERIFY
 	if (argc < 4)
 		return CMD_RET_USAGE;
@@ -53,4 +72,6 @@ U_BOOT_CMD(
 		"    - verify message digest of memory area to immediate value, \n"
 		"      env var or *address"
 #endif
+	"\nhash bench [size]\n"
+		"    - report the throughput of each algorithm over size bytes"
 );
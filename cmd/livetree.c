@@ -0,0 +1,171 @@
+/*
+ * Show information about the live device tree and compare its lookup speed
+ * with the flat tree
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <fdtdec.h>
+#include <of_live.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Properties which drivers commonly look up in every node */
+static const char *const bench_props[] = {
+	"compatible",
+	"reg",
+	"status",
+	"#address-cells",
+	"#size-cells",
+	"clocks",
+	"interrupts",
+	"u-boot,dm-pre-reloc",
+};
+
+/*
+ * Do the lookups that binding and probing a driver for each node would do,
+ * returning a checksum of the results so that the two trees can be compared
+ */
+static ulong bench_pass(const void *blob, bool live, ulong *lookupsp)
+{
+	int offset, depth = 0;
+	ulong sum = 0;
+	int i;
+
+	for (offset = 0; offset >= 0 && depth >= 0;
+	     offset = fdt_next_node(blob, offset, &depth)) {
+		const char *compat = NULL;
+		int len, ret;
+
+		for (i = 0; i < ARRAY_SIZE(bench_props); i++) {
+			const void *val;
+
+			if (live)
+				val = of_live_getprop(offset, bench_props[i],
+						      &len);
+			else
+				val = fdt_getprop(blob, offset, bench_props[i],
+						  &len);
+			sum += (ulong)val + len;
+			if (!i)
+				compat = val;
+		}
+		ret = live ? of_live_parent_offset(offset) :
+			fdt_parent_offset(blob, offset);
+		sum += ret;
+		*lookupsp += ARRAY_SIZE(bench_props) + 1;
+		if (compat) {
+			ret = live ? of_live_node_offset_by_compatible(-1,
+								       compat) :
+				fdt_node_offset_by_compatible(blob, -1, compat);
+			sum += ret;
+			(*lookupsp)++;
+		}
+		ret = fdt_get_phandle(blob, offset);
+		if (ret) {
+			ret = live ? of_live_node_offset_by_phandle(ret) :
+				fdt_node_offset_by_phandle(blob, ret);
+			sum += ret;
+			(*lookupsp)++;
+		}
+	}
+
+	return sum;
+}
+
+static int do_livetree_info(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	struct of_live_stats stats;
+
+	if (!of_live_active(gd->fdt_blob)) {
+		printf("No live tree\n");
+		return CMD_RET_FAILURE;
+	}
+	of_live_get_stats(&stats);
+	printf("Nodes:      %d\n", stats.nodes);
+	printf("Properties: %d\n", stats.props);
+	printf("Phandles:   %d\n", stats.phandles);
+	printf("Size:       %lu bytes\n", stats.size);
+	printf("Build time: %lu us\n", stats.build_us);
+	printf("Lookups:    %lu\n", stats.lookups);
+
+	return 0;
+}
+
+static int do_livetree_bench(cmd_tbl_t *cmdtp, int flag, int argc,
+			     char * const argv[])
+{
+	ulong flat_sum = 0, live_sum = 0;
+	ulong flat_us, live_us;
+	ulong lookups = 0;
+	ulong start;
+	int loops = 100;
+	int i;
+
+	if (argc > 1)
+		loops = simple_strtoul(argv[1], NULL, 0);
+	if (!of_live_active(gd->fdt_blob)) {
+		printf("No live tree\n");
+		return CMD_RET_FAILURE;
+	}
+
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		flat_sum += bench_pass(gd->fdt_blob, false, &lookups);
+	flat_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		live_sum += bench_pass(gd->fdt_blob, true, &lookups);
+	live_us = timer_get_us() - start;
+
+	lookups /= 2;
+	printf("%lu lookups in %d passes\n", lookups, loops);
+	printf("flat tree: %8lu us, %lu ns/lookup\n", flat_us,
+	       lookups ? flat_us * 1000 / lookups : 0);
+	printf("live tree: %8lu us, %lu ns/lookup\n", live_us,
+	       lookups ? live_us * 1000 / lookups : 0);
+	if (live_us)
+		printf("speed-up:  %lu.%02lux\n", flat_us / live_us,
+		       flat_us * 100 / live_us % 100);
+	if (flat_sum != live_sum) {
+		printf("Results differ between the flat and live trees\n");
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static cmd_tbl_t cmd_livetree_sub[] = {
+	U_BOOT_CMD_MKENT(info, 1, 0, do_livetree_info, "", ""),
+	U_BOOT_CMD_MKENT(bench, 2, 0, do_livetree_bench, "", ""),
+};
+
+static int do_livetree(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	cmd_tbl_t *c;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* Strip off leading 'livetree' command argument */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], cmd_livetree_sub,
+			 ARRAY_SIZE(cmd_livetree_sub));
+	if (c)
+		return c->cmd(cmdtp, flag, argc, argv);
+	else
+		return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(livetree, 3, 0, do_livetree,
+	"live device tree information",
+	"info - show the size of the live tree and how often it was used\n"
+	"livetree bench [<passes>] - time lookups in the flat and live trees"
+);
@@ -22,6 +22,7 @@
 #endif
 #include <hash.h>
 #include <inttypes.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <watchdog.h>
 #include <asm/io.h>
@@ -1336,8 +1337,24 @@ __weak void board_show_dram(phys_size_t size)
 static int do_mem_info(cmd_tbl_t *cmdtp, int flag, int argc,
 		       char * const argv[])
 {
+	struct malloc_info info;
+	ulong frag;
+
 	board_show_dram(gd->ram_size);
 
+	malloc_get_info(&info);
+	frag = info.free ? 100 - info.largest_free * 100 / info.free : 0;
+	puts("malloc: ");
+	print_size(info.total, " region\n");
+	printf("  heap:       %lu bytes, peak %lu\n", info.heap,
+	       info.peak_heap);
+	printf("  in use:     %lu bytes in %lu allocations\n", info.in_use,
+	       info.allocs);
+	printf("  free:       %lu bytes in %lu chunks, largest %lu\n",
+	       info.free, info.free_chunks, info.largest_free);
+	printf("  fragmented: %lu%%\n", frag);
+	printf("  malloc():   %lu calls\n", info.malloc_count);
+
 	return 0;
 }
 #endif
@@ -8,6 +8,9 @@
 #include <common.h>
 #include <command.h>
 #include <console.h>
+#include <div64.h>
+#include <malloc.h>
+#include <memalign.h>
 #include <mmc.h>
 
 static int curr_device = -1;
@@ -72,6 +75,64 @@ U_BOOT_CMD(
 );
 #else /* !CONFIG_GENERIC_MMC */
 
+/* Number of bytes read to measure the read speed */
+#define MMC_SPEED_TEST_SIZE	(1 << 20)
+
+static const char *const mmc_timing_names[] = {
+	[MMC_TIMING_LEGACY]	= "Legacy",
+	[MMC_TIMING_MMC_HS]	= "MMC High Speed",
+	[MMC_TIMING_SD_HS]	= "SD High Speed",
+	[MMC_TIMING_MMC_DDR52]	= "MMC DDR52",
+	[MMC_TIMING_MMC_HS200]	= "HS200",
+	[MMC_TIMING_MMC_HS400]	= "HS400",
+};
+
+/* Work out a transfer rate in KiB/s */
+static u64 mmc_rate(u64 blocks, uint blksz, ulong us)
+{
+	return lldiv(blocks * blksz * 1000000 / 1024, max(us, 1UL));
+}
+
+/* Time a read from the start of the current partition */
+static void print_mmc_read_speed(struct mmc *mmc)
+{
+	lbaint_t blkcnt;
+	ulong start, us;
+	void *buf;
+	ulong n;
+
+	blkcnt = min_t(lbaint_t, MMC_SPEED_TEST_SIZE / mmc->read_bl_len,
+		       mmc->block_dev.lba);
+	buf = malloc_cache_aligned(blkcnt * mmc->read_bl_len);
+	if (!buf || !blkcnt) {
+		free(buf);
+		return;
+	}
+
+	start = timer_get_us();
+	n = mmc->block_dev.block_read(&mmc->block_dev, 0, blkcnt, buf);
+	us = timer_get_us() - start;
+	free(buf);
+	if (n != blkcnt) {
+		puts("Read Speed: read failed\n");
+		return;
+	}
+	printf("Read Speed: %llu KiB/s\n",
+	       mmc_rate(blkcnt, mmc->read_bl_len, us));
+}
+
+static void print_mmc_stats(struct mmc *mmc)
+{
+	struct mmc_stats *stats = &mmc->stats;
+
+	printf("Commands: %lu\n", stats->cmds);
+	printf("Blocks Read: %lu, %llu KiB/s\n", stats->read_blocks,
+	       mmc_rate(stats->read_blocks, mmc->read_bl_len, stats->read_us));
+	printf("Blocks Written: %lu, %llu KiB/s\n", stats->write_blocks,
+	       mmc_rate(stats->write_blocks, mmc->write_bl_len,
+			stats->write_us));
+}
+
 static void print_mmcinfo(struct mmc *mmc)
 {
 	int i;
@@ -99,6 +160,13 @@ static void print_mmcinfo(struct mmc *mmc)
 
 	printf("Bus Width: %d-bit%s\n", mmc->bus_width,
 			mmc->ddr_mode ? " DDR" : "");
+	if (mmc->timing < ARRAY_SIZE(mmc_timing_names))
+		printf("Bus Mode: %s, %d MHz\n", mmc_timing_names[mmc->timing],
+		       mmc->clock / 1000000);
+	printf("CMD23 Support: %s\n",
+	       mmc->card_caps & MMC_MODE_CMD23 ? "Yes" : "No");
+	print_mmc_read_speed(mmc);
+	print_mmc_stats(mmc);
 
 	puts("Erase Group Size: ");
 	print_size(((u64)mmc->erase_grp_size) << 9, "\n");
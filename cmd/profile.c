@@ -0,0 +1,115 @@
+/*
+ * Control the sampling profiler
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <mapmem.h>
+#include <trace.h>
+
+static int do_profile_start(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	unsigned int interval_us = CONFIG_PROFILER_INTERVAL_US;
+	int ret;
+
+	if (argc > 1)
+		interval_us = simple_strtoul(argv[1], NULL, 10);
+	ret = profile_start(interval_us);
+	if (ret) {
+		printf("Cannot start profiler (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_profile_stop(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	profile_stop();
+
+	return 0;
+}
+
+static int do_profile_stats(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	profile_print_stats();
+
+	return 0;
+}
+
+/*
+ * Write the samples to the same output buffer as the 'trace' command, so
+ * that they can be saved in one file with the function trace
+ */
+static int do_profile_samples(cmd_tbl_t *cmdtp, int flag, int argc,
+			      char * const argv[])
+{
+	size_t buff_size, avail, buff_ptr, used;
+	unsigned int needed;
+	char *buff;
+
+	if (argc == 2)
+		return CMD_RET_USAGE;
+	if (argc < 3) {
+		buff_size = getenv_ulong("profsize", 16, 0);
+		buff = map_sysmem(getenv_ulong("profbase", 16, 0), buff_size);
+		buff_ptr = getenv_ulong("profoffset", 16, 0);
+	} else {
+		buff_size = simple_strtoul(argv[2], NULL, 16);
+		buff = map_sysmem(simple_strtoul(argv[1], NULL, 16),
+				  buff_size);
+		buff_ptr = 0;
+	}
+
+	avail = buff_size - buff_ptr;
+	if (profile_list_samples(buff + buff_ptr, avail, &needed))
+		printf("Error: truncated (%#x bytes needed)\n", needed);
+	used = min(avail, (size_t)needed);
+	printf("Samples dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
+	setenv_hex("profbase", map_to_sysmem(buff));
+	setenv_hex("profsize", buff_size);
+	setenv_hex("profoffset", buff_ptr + used);
+
+	return 0;
+}
+
+static cmd_tbl_t cmd_profile_sub[] = {
+	U_BOOT_CMD_MKENT(start, 2, 0, do_profile_start, "", ""),
+	U_BOOT_CMD_MKENT(stop, 1, 0, do_profile_stop, "", ""),
+	U_BOOT_CMD_MKENT(stats, 1, 0, do_profile_stats, "", ""),
+	U_BOOT_CMD_MKENT(samples, 3, 0, do_profile_samples, "", ""),
+};
+
+static int do_profile(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char * const argv[])
+{
+	cmd_tbl_t *c;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* Strip off leading 'profile' command argument */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], cmd_profile_sub, ARRAY_SIZE(cmd_profile_sub));
+	if (c)
+		return c->cmd(cmdtp, flag, argc, argv);
+	else
+		return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(profile, 4, 0, do_profile,
+	"sampling profiler",
+	"start [<interval_us>]      - start taking samples\n"
+	"profile stop                       - stop taking samples\n"
+	"profile stats                      - show statistics\n"
+	"profile samples [<addr> <size>]    - dump samples into buffer"
+);
@@ -539,6 +539,99 @@ static int do_spi_flash_test(int argc, char * const argv[])
 
 	return 0;
 }
+
+static const char *const read_mode_name[SF_READ_MODE_COUNT] = {
+	"xfer",
+	"direct",
+	"mmap",
+};
+
+/**
+ * Time a read using each read mode which the flash supports
+ *
+ * @param flash		SPI flash to use
+ * @param offset	Offset within flash to read
+ * @param len		Number of bytes to read
+ * @param buf		Buffer for the data read in the first mode
+ * @param vbuf		Buffer for the data read in later modes
+ * @return 0 if ok, -1 on error
+ */
+static int spi_flash_bench(struct spi_flash *flash, ulong offset, ulong len,
+			   uint8_t *buf, uint8_t *vbuf)
+{
+	uint old_mode = flash->read_mode;
+	uint8_t *dest = buf;
+	int ret = 0;
+	uint mode;
+
+	for (mode = 0; mode < SF_READ_MODE_COUNT; mode++) {
+		uint64_t speed;	/* KiB/s */
+		ulong start, us;
+
+		if (!(flash->read_modes & BIT(mode)))
+			continue;
+		flash->read_mode = mode;
+		start = timer_get_us();
+		if (spi_flash_read(flash, offset, len, dest)) {
+			printf("%s: read failed\n", read_mode_name[mode]);
+			ret = -1;
+			break;
+		}
+		us = max(timer_get_us() - start, 1UL);
+		speed = lldiv((uint64_t)len * 1000000, us * 1024);
+		printf("%-7s%s %lu us, %llu KiB/s\n", read_mode_name[mode],
+		       mode == old_mode ? "*" : " ", us,
+		       (unsigned long long)speed);
+
+		if (dest != buf && memcmp(buf, dest, len)) {
+			printf("%s: data does not match\n",
+			       read_mode_name[mode]);
+			ret = -1;
+			break;
+		}
+		dest = vbuf;
+	}
+	flash->read_mode = old_mode;
+
+	return ret;
+}
+
+static int do_spi_flash_bench(int argc, char * const argv[])
+{
+	unsigned long offset;
+	unsigned long len;
+	uint8_t *buf, *vbuf;
+	char *endp;
+	int ret;
+
+	if (argc < 3)
+		return -1;
+	offset = simple_strtoul(argv[1], &endp, 16);
+	if (*argv[1] == 0 || *endp != 0)
+		return -1;
+	len = simple_strtoul(argv[2], &endp, 16);
+	if (*argv[2] == 0 || *endp != 0)
+		return -1;
+	if (offset + len > flash->size) {
+		printf("ERROR: attempting bench past flash size (%#x)\n",
+		       flash->size);
+		return 1;
+	}
+
+	buf = memalign(ARCH_DMA_MINALIGN, len);
+	vbuf = memalign(ARCH_DMA_MINALIGN, len);
+	if (!buf || !vbuf) {
+		free(buf);
+		free(vbuf);
+		printf("Cannot allocate memory (%lu bytes)\n", len);
+		return 1;
+	}
+	ret = spi_flash_bench(flash, offset, len, buf, vbuf);
+	free(vbuf);
+	free(buf);
+
+	return ret ? 1 : 0;
+}
 #endif /* CONFIG_CMD_SF_TEST */
 
 static int do_spi_flash(cmd_tbl_t *cmdtp, int flag, int argc,
@@ -576,6 +669,8 @@ static int do_spi_flash(cmd_tbl_t *cmdtp, int flag, int argc,
 #ifdef CONFIG_CMD_SF_TEST
 	else if (!strcmp(cmd, "test"))
 		ret = do_spi_flash_test(argc, argv);
+	else if (!strcmp(cmd, "bench"))
+		ret = do_spi_flash_bench(argc, argv);
 #endif
 	else
 		ret = -1;
@@ -590,7 +685,9 @@ usage:
 
 #ifdef CONFIG_CMD_SF_TEST
 #define SF_TEST_HELP "\nsf test offset len		" \
-		"- run a very basic destructive test"
+		"- run a very basic destructive test" \
+	"\nsf bench offset len		" \
+		"- time reads with each read mode"
 #else
 #define SF_TEST_HELP
 #endif
@@ -78,6 +78,33 @@ static int create_call_list(int argc, char * const argv[])
 	return 0;
 }
 
+#ifdef CONFIG_BOOTSTAGE
+static int create_mark_list(int argc, char * const argv[])
+{
+	size_t buff_size, avail, buff_ptr, used;
+	unsigned int needed;
+	char *buff;
+	int err;
+
+	if (get_args(argc, argv, &buff, &buff_ptr, &buff_size))
+		return -1;
+
+	avail = buff_size - buff_ptr;
+	err = bootstage_list_marks(buff + buff_ptr, avail, &needed);
+	if (err)
+		printf("Error: truncated (%#x bytes needed)\n", needed);
+	used = min(avail, (size_t)needed);
+	printf("Bootstage marks dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
+	setenv_hex("profbase", map_to_sysmem(buff));
+	setenv_hex("profsize", buff_size);
+	setenv_hex("profoffset", buff_ptr + used);
+
+	return 0;
+}
+#endif
+
 int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
@@ -99,6 +126,12 @@ int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		if (create_func_list(argc, argv))
 			return cmd_usage(cmdtp);
 		break;
+#ifdef CONFIG_BOOTSTAGE
+	case 'b':
+		if (create_mark_list(argc, argv))
+			return cmd_usage(cmdtp);
+		break;
+#endif
 	case 's':
 		trace_print_stats();
 		break;
@@ -118,4 +151,8 @@ U_BOOT_CMD(
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
 		"- dump function call trace into buffer"
+#ifdef CONFIG_BOOTSTAGE
+	"\ntrace bootstage [<addr> <size>]    "
+		"- dump bootstage marks into buffer"
+#endif
 );
@@ -0,0 +1,120 @@
+/*
+ * Arena allocator for short-lived allocations
+ *
+ * Code which makes many small allocations that all end at the same time
+ * (a filesystem operation, an image load) can take them from an arena and
+ * free them in one go, instead of making a malloc()/free() pair for each.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <arena.h>
+#include <malloc.h>
+
+/* Alignment of each allocation, matching malloc() */
+#define ARENA_ALIGN	(2 * sizeof(size_t))
+
+struct arena_block {
+	struct arena_block *next;
+	size_t size;		/* Bytes available for allocations */
+};
+
+/* Allocations start after the header, rounded up to ARENA_ALIGN */
+#define ARENA_HDR_SIZE	ALIGN(sizeof(struct arena_block), ARENA_ALIGN)
+
+static inline void *arena_block_data(struct arena_block *block)
+{
+	return (char *)block + ARENA_HDR_SIZE;
+}
+
+struct arena *arena_create(size_t block_size)
+{
+	struct arena *arena;
+
+	arena = calloc(1, sizeof(*arena));
+	if (!arena)
+		return NULL;
+	arena->block_size = ALIGN(block_size, ARENA_ALIGN);
+
+	return arena;
+}
+
+void *arena_alloc(struct arena *arena, size_t size)
+{
+	struct arena_block *block;
+	void *ptr;
+
+	size = ALIGN(size, ARENA_ALIGN);
+	while (!arena->cur || arena->used + size > arena->cur->size) {
+		/* Move on to a block kept from before the last reset */
+		if (arena->cur && arena->cur->next) {
+			arena->cur = arena->cur->next;
+			arena->used = 0;
+			continue;
+		}
+
+		block = malloc(ARENA_HDR_SIZE + max(size, arena->block_size));
+		if (!block)
+			return NULL;
+		block->next = NULL;
+		block->size = max(size, arena->block_size);
+		if (arena->cur)
+			arena->cur->next = block;
+		else
+			arena->first = block;
+		arena->cur = block;
+		arena->used = 0;
+	}
+	ptr = (char *)arena_block_data(arena->cur) + arena->used;
+	arena->used += size;
+
+	return ptr;
+}
+
+void *arena_zalloc(struct arena *arena, size_t size)
+{
+	void *ptr;
+
+	ptr = arena_alloc(arena, size);
+	if (ptr)
+		memset(ptr, '\0', size);
+
+	return ptr;
+}
+
+bool arena_contains(struct arena *arena, const void *ptr)
+{
+	struct arena_block *block;
+	const char *data;
+
+	if (!arena)
+		return false;
+	for (block = arena->first; block; block = block->next) {
+		data = arena_block_data(block);
+		if ((const char *)ptr >= data &&
+		    (const char *)ptr < data + block->size)
+			return true;
+	}
+
+	return false;
+}
+
+void arena_reset(struct arena *arena)
+{
+	arena->cur = arena->first;
+	arena->used = 0;
+}
+
+void arena_destroy(struct arena *arena)
+{
+	struct arena_block *block, *next;
+
+	if (!arena)
+		return;
+	for (block = arena->first; block; block = next) {
+		next = block->next;
+		free(block);
+	}
+	free(arena);
+}
@@ -10,10 +10,13 @@
 #include <bootretry.h>
 #include <cli.h>
 #include <console.h>
+#include <dm.h>
 #include <fdtdec.h>
 #include <menu.h>
+#include <mmc.h>
 #include <post.h>
 #include <u-boot/sha256.h>
+#include <dm/device-internal.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -28,6 +31,23 @@ DECLARE_GLOBAL_DATA_PTR;
 /* Stored value of bootdelay, used by autoboot_command() */
 static int stored_bootdelay;
 
+/* Let MMC cards and slow device probes carry on while waiting for a key */
+static void autoboot_idle(void)
+{
+#ifdef CONFIG_DM_PROBE_ASYNC
+	device_probe_poll();
+#endif
+#if defined(CONFIG_MMC_ASYNC_INIT) && defined(CONFIG_GENERIC_MMC)
+	static ulong last_poll;
+
+	/* Each poll sends a command, so don't do it on every loop */
+	if (get_timer(last_poll) >= 10) {
+		mmc_init_poll();
+		last_poll = get_timer(0);
+	}
+#endif
+}
+
 #if defined(CONFIG_AUTOBOOT_KEYED)
 #if defined(CONFIG_AUTOBOOT_STOP_STR_SHA256)
 
@@ -95,6 +115,7 @@ static int passwd_abort(uint64_t etime)
 			if (slow_equals(sha, sha_env, SHA256_SUM_LEN))
 				abort = 1;
 		}
+		autoboot_idle();
 	} while (!abort && get_ticks() <= etime);
 
 	return abort;
@@ -172,6 +193,7 @@ static int passwd_abort(uint64_t etime)
 				abort = 1;
 			}
 		}
+		autoboot_idle();
 	} while (!abort && get_ticks() <= etime);
 
 	return abort;
@@ -259,6 +281,7 @@ static int abortboot_normal(int bootdelay)
 # endif
 				break;
 			}
+			autoboot_idle();
 			udelay(10000);
 		} while (!abort && get_timer(ts) < 1000);
 
@@ -493,8 +493,28 @@ static int reserve_trace(void)
 	return 0;
 }
 
+static int reserve_profile(void)
+{
+#ifdef CONFIG_PROFILER
+	gd->relocaddr -= CONFIG_PROFILER_BUFFER_SIZE;
+	gd->profile_buff = map_sysmem(gd->relocaddr,
+				      CONFIG_PROFILER_BUFFER_SIZE);
+	debug("Reserving %dk for profiler samples at: %08lx\n",
+	      CONFIG_PROFILER_BUFFER_SIZE >> 10, gd->relocaddr);
+#endif
+
+	return 0;
+}
+
 static int reserve_uboot(void)
 {
+#ifdef CONFIG_SKIP_RELOCATE_UBOOT
+	/* We keep running where we were loaded, so no space is needed here */
+	if (gd->flags & GD_FLG_SKIP_RELOC) {
+		gd->start_addr_sp = gd->relocaddr;
+		return 0;
+	}
+#endif
 	/*
 	 * reserve memory for U-Boot code, data & bss
 	 * round down to next 4 kB limit
@@ -519,6 +539,7 @@ static int reserve_uboot(void)
 static int reserve_malloc(void)
 {
 	gd->start_addr_sp = gd->start_addr_sp - TOTAL_MALLOC_LEN;
+	gd->malloc_start = gd->start_addr_sp;
 	debug("Reserving %dk for malloc() at: %08lx\n",
 			TOTAL_MALLOC_LEN >> 10, gd->start_addr_sp);
 	return 0;
@@ -707,10 +728,30 @@ static int setup_dram_config(void)
 	return 0;
 }
 
+/*
+ * When running in place, the device tree only needs to move if it overlaps
+ * BSS (as it does with CONFIG_OF_SEPARATE), since BSS is cleared before
+ * board_init_r() is called. Sandbox reads it into emulated DRAM, where it
+ * would be overwritten by the first file loaded, so it always moves there.
+ */
+static bool fdt_needs_move(void)
+{
+#if defined(CONFIG_SKIP_RELOCATE_UBOOT) && defined(CONFIG_ARM)
+	ulong start = (ulong)gd->fdt_blob;
+
+	return start < (ulong)__bss_end &&
+		start + fdt_totalsize(gd->fdt_blob) > (ulong)__bss_start;
+#elif defined(CONFIG_SKIP_RELOCATE_UBOOT) && defined(CONFIG_SANDBOX)
+	return true;
+#else
+	return false;
+#endif
+}
+
 static int reloc_fdt(void)
 {
 #ifndef CONFIG_OF_EMBED
-	if (gd->flags & GD_FLG_SKIP_RELOC)
+	if ((gd->flags & GD_FLG_SKIP_RELOC) && !fdt_needs_move())
 		return 0;
 	if (gd->new_fdt) {
 		memcpy(gd->new_fdt, gd->fdt_blob, gd->fdt_size);
@@ -725,6 +766,20 @@ static int setup_reloc(void)
 {
 	if (gd->flags & GD_FLG_SKIP_RELOC) {
 		debug("Skipping relocation due to flag\n");
+#ifdef CONFIG_SKIP_RELOCATE_UBOOT
+		/*
+		 * Only global data moves. On ARM, crt0 passes relocaddr to
+		 * relocate_code(), which skips the copy when it matches the
+		 * current location.
+		 */
+#ifdef CONFIG_ARM
+		gd->relocaddr = (ulong)__image_copy_start;
+#endif
+		gd->reloc_off = 0;
+		memcpy(gd->new_gd, (char *)gd, sizeof(gd_t));
+		debug("Running in place, new gd at %08lx, sp at %08lx\n",
+		      (ulong)map_to_sysmem(gd->new_gd), gd->start_addr_sp);
+#endif
 		return 0;
 	}
 
@@ -993,6 +1048,7 @@ static init_fnc_t init_sequence_f[] = {
 # endif
 #endif /* CONFIG_DM_VIDEO */
 	reserve_trace,
+	reserve_profile,
 #if !defined(CONFIG_BLACKFIN)
 	reserve_uboot,
 #endif
@@ -1053,6 +1109,9 @@ void board_init_f(ulong boot_flags)
 	zero_global_data();
 #endif
 
+#ifdef CONFIG_SKIP_RELOCATE_UBOOT
+	boot_flags |= GD_FLG_SKIP_RELOC;
+#endif
 	gd->flags = boot_flags;
 	gd->have_console = 0;
 
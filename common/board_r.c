@@ -112,6 +112,18 @@ static int initr_trace(void)
 	return 0;
 }
 
+static int initr_profile(void)
+{
+#ifdef CONFIG_PROFILER
+	profile_init(gd->profile_buff, CONFIG_PROFILER_BUFFER_SIZE);
+#ifdef CONFIG_PROFILER_BOOT
+	profile_start(CONFIG_PROFILER_INTERVAL_US);
+#endif
+#endif
+
+	return 0;
+}
+
 static int initr_reloc(void)
 {
 	/* tell others: relocation done */
@@ -290,8 +302,8 @@ static int initr_malloc(void)
 	debug("Pre-reloc malloc() used %#lx bytes (%ld KB)\n", gd->malloc_ptr,
 	      gd->malloc_ptr / 1024);
 #endif
-	/* The malloc area is immediately below the monitor copy in DRAM */
-	malloc_start = gd->relocaddr - TOTAL_MALLOC_LEN;
+	/* The malloc area was placed by reserve_malloc() in board_f */
+	malloc_start = gd->malloc_start;
 	mem_malloc_init((ulong)map_sysmem(malloc_start, TOTAL_MALLOC_LEN),
 			TOTAL_MALLOC_LEN);
 	return 0;
@@ -314,6 +326,21 @@ static int initr_noncached(void)
 }
 #endif
 
+#ifdef CONFIG_OF_LIVE
+static int initr_of_live(void)
+{
+	int ret;
+
+	/* Driver model uses this from now on */
+	ret = of_live_build(gd->fdt_blob);
+	if (ret)
+		printf("Live device tree failed (err=%d)\n", ret);
+
+	/* The flat tree still works, so carry on */
+	return 0;
+}
+#endif
+
 #ifdef CONFIG_DM
 static int initr_dm(void)
 {
@@ -322,12 +349,19 @@ static int initr_dm(void)
 	/* Save the pre-reloc driver model and start a new one */
 	gd->dm_root_f = gd->dm_root;
 	gd->dm_root = NULL;
+#ifdef CONFIG_DM_LIST_INDEX
+	/* The driver index was built in the pre-relocation malloc() area */
+	gd->dm_list_index = NULL;
+#endif
 #ifdef CONFIG_TIMER
 	gd->timer = NULL;
 #endif
 	ret = dm_init_and_scan(false);
 	if (ret)
 		return ret;
+#ifdef CONFIG_DM_PROBE_ASYNC
+	dm_probe_async();
+#endif
 #ifdef CONFIG_TIMER_EARLY
 	ret = dm_timer_init();
 	if (ret)
@@ -759,6 +793,7 @@ static int run_main_loop(void)
  */
 init_fnc_t init_sequence_r[] = {
 	initr_trace,
+	initr_profile,
 	initr_reloc,
 	/* TODO: could x86/PPC have this also perhaps? */
 #ifdef CONFIG_ARM
@@ -781,6 +816,9 @@ init_fnc_t init_sequence_r[] = {
 	initr_noncached,
 #endif
 	bootstage_relocate,
+#ifdef CONFIG_OF_LIVE
+	initr_of_live,
+#endif
 #ifdef CONFIG_DM
 	initr_dm,
 #endif
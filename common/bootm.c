@@ -30,11 +30,6 @@
 #include <bootm.h>
 #include <image.h>
 
-#ifndef CONFIG_SYS_BOOTM_LEN
-/* use 8MByte as default max gunzip size */
-#define CONFIG_SYS_BOOTM_LEN	0x800000
-#endif
-
 #define IH_INITRD_ARCH IH_ARCH_DEFAULT
 
 #ifndef USE_HOSTCC
@@ -413,6 +408,70 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 }
 
 #ifndef USE_HOSTCC
+int bootm_decomp_stream(int comp, ulong load, int type, void *load_buf,
+			uint unc_len, decomp_read_func read, void *priv,
+			ulong *load_end)
+{
+	ulong image_len = 0;
+	int ret = 0;
+
+	*load_end = load;
+	print_decomp_msg(comp, type, false);
+
+	switch (comp) {
+	case IH_COMP_NONE: {
+		char extra;
+
+		while (image_len < unc_len) {
+			ret = read(priv, load_buf + image_len,
+				   unc_len - image_len);
+			if (ret <= 0)
+				break;
+			image_len += ret;
+		}
+		/* Make sure that we got the whole image */
+		if (ret > 0)
+			ret = read(priv, &extra, 1) ? -ENOBUFS : 0;
+		break;
+	}
+#ifdef CONFIG_GZIP
+	case IH_COMP_GZIP:
+		ret = gunzip_stream(load_buf, unc_len, read, priv, &image_len);
+		break;
+#endif /* CONFIG_GZIP */
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA: {
+		SizeT lzma_len = unc_len;
+
+		ret = lzmaStreamDecompress(load_buf, &lzma_len, read, priv);
+		image_len = lzma_len;
+		break;
+	}
+#endif /* CONFIG_LZMA */
+#ifdef CONFIG_LZ4
+	case IH_COMP_LZ4: {
+		size_t size = unc_len;
+
+		ret = ulz4fn_stream(read, priv, load_buf, &size);
+		image_len = size;
+		break;
+	}
+#endif /* CONFIG_LZ4 */
+	default:
+		printf("Streaming not supported for compression type %d\n",
+		       comp);
+		return BOOTM_ERR_UNIMPLEMENTED;
+	}
+
+	if (ret)
+		return handle_decomp_error(comp, image_len, unc_len, ret);
+	*load_end = load + image_len;
+
+	puts("OK\n");
+
+	return 0;
+}
+
 static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 			 int boot_progress)
 {
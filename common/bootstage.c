@@ -15,6 +15,7 @@
 #include <common.h>
 #include <libfdt.h>
 #include <malloc.h>
+#include <trace.h>
 #include <linux/compiler.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -25,6 +26,7 @@ struct bootstage_record {
 	const char *name;
 	int flags;		/* see enum bootstage_flags */
 	enum bootstage_id id;
+	ulong func;		/* Initcall address, for BOOTSTAGEF_INITCALL */
 };
 
 static struct bootstage_record record[BOOTSTAGE_ID_COUNT] = { {1} };
@@ -34,6 +36,7 @@ enum {
 	BOOTSTAGE_VERSION	= 0,
 	BOOTSTAGE_MAGIC		= 0xb00757a3,
 	BOOTSTAGE_DIGITS	= 9,
+	BOOTSTAGE_NAME_LEN	= 30,	/* Space for a generated record name */
 };
 
 struct bootstage_hdr {
@@ -150,6 +153,50 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+uint32_t bootstage_accum_time(enum bootstage_id id, const char *name,
+			      uint32_t time_us)
+{
+	struct bootstage_record *rec = &record[id];
+
+	/* A non-zero start time marks this record as an accumulator */
+	if (!rec->start_us)
+		rec->start_us = timer_get_boot_us() ? : 1;
+	rec->name = name;
+	rec->time_us += time_us;
+
+	return rec->time_us;
+}
+
+bool bootstage_initcall_ready(void)
+{
+	return record[BOOTSTAGE_ID_START_UBOOT_F].name != NULL;
+}
+
+ulong bootstage_initcall(ulong func, ulong start_us)
+{
+	struct bootstage_record *rec;
+	ulong duration = timer_get_boot_us() - start_us;
+	__maybe_unused ulong base;
+
+	if (next_id >= BOOTSTAGE_ID_COUNT) {
+		next_id++;
+		return duration;
+	}
+
+	rec = &record[next_id];
+	rec->id = next_id++;
+	/* This is an accumulator, so the start time must be non-zero */
+	rec->start_us = start_us ? : 1;
+	rec->time_us = duration;
+	rec->flags = BOOTSTAGEF_INITCALL;
+	rec->func = func;
+#ifdef CONFIG_KALLSYMS
+	rec->name = symbol_lookup(func, &base);
+#endif
+
+	return duration;
+}
+
 /**
  * Get a record name as a printable string
  *
@@ -163,6 +210,8 @@ static const char *get_record_name(char *buf, int len,
 {
 	if (rec->name)
 		return rec->name;
+	else if (rec->flags & BOOTSTAGEF_INITCALL)
+		snprintf(buf, len, "initcall %#lx", rec->func);
 	else if (rec->id >= BOOTSTAGE_ID_USER)
 		snprintf(buf, len, "user_%d", rec->id - BOOTSTAGE_ID_USER);
 	else
@@ -174,7 +223,7 @@ static const char *get_record_name(char *buf, int len,
 static uint32_t print_time_record(enum bootstage_id id,
 			struct bootstage_record *rec, uint32_t prev)
 {
-	char buf[20];
+	char buf[BOOTSTAGE_NAME_LEN];
 
 	if (prev == -1U) {
 		printf("%11s", "");
@@ -205,7 +254,7 @@ static int h_compare_record(const void *r1, const void *r2)
 static int add_bootstages_devicetree(struct fdt_header *blob)
 {
 	int bootstage;
-	char buf[20];
+	char buf[BOOTSTAGE_NAME_LEN];
 	int id;
 	int i;
 
@@ -262,7 +311,8 @@ int bootstage_fdt_add_report(void)
 void bootstage_report(void)
 {
 	struct bootstage_record *rec = record;
-	int id;
+	ulong total = 0;
+	int id, count;
 	uint32_t prev;
 
 	puts("Timer summary in microseconds:\n");
@@ -287,9 +337,195 @@ void bootstage_report(void)
 
 	puts("\nAccumulated time:\n");
 	for (id = 0, rec = record; id < BOOTSTAGE_ID_COUNT; id++, rec++) {
-		if (rec->start_us)
+		if (rec->start_us && !(rec->flags & BOOTSTAGEF_INITCALL))
 			prev = print_time_record(id, rec, -1);
 	}
+
+	for (id = count = 0, rec = record; id < BOOTSTAGE_ID_COUNT;
+	     id++, rec++) {
+		if (rec->flags & BOOTSTAGEF_INITCALL) {
+			count++;
+			total += rec->time_us;
+		}
+	}
+	if (count) {
+		printf("\n%d initcalls took %lu us, see 'bootstage report --initcalls'\n",
+		       count, total);
+	}
+}
+
+static int h_compare_initcall(const void *r1, const void *r2)
+{
+	const struct bootstage_record *rec1 = *(struct bootstage_record **)r1;
+	const struct bootstage_record *rec2 = *(struct bootstage_record **)r2;
+
+	if (rec1->time_us != rec2->time_us)
+		return rec1->time_us < rec2->time_us ? 1 : -1;
+
+	return rec1->start_us > rec2->start_us ? 1 : -1;
+}
+
+void bootstage_report_initcalls(bool csv)
+{
+	struct bootstage_record **list, *rec;
+	char buf[BOOTSTAGE_NAME_LEN];
+	ulong total = 0;
+	int count = 0;
+	int id, i;
+
+	list = malloc(BOOTSTAGE_ID_COUNT * sizeof(*list));
+	if (!list) {
+		puts("Out of memory\n");
+		return;
+	}
+	for (id = 0, rec = record; id < BOOTSTAGE_ID_COUNT; id++, rec++) {
+		if (rec->flags & BOOTSTAGEF_INITCALL) {
+			list[count++] = rec;
+			total += rec->time_us;
+		}
+	}
+	qsort(list, count, sizeof(*list), h_compare_initcall);
+
+	if (csv) {
+		puts("start_us,duration_us,initcall\n");
+		for (i = 0; i < count; i++) {
+			rec = list[i];
+			printf("%u,%lu,%s\n", rec->start_us, rec->time_us,
+			       get_record_name(buf, sizeof(buf), rec));
+		}
+	} else {
+		puts("Initcall time in microseconds, most expensive first:\n");
+		printf("%11s%11s%5s  %s\n", "Start", "Duration", "%",
+		       "Initcall");
+		for (i = 0; i < count; i++) {
+			rec = list[i];
+			print_grouped_ull(rec->start_us, BOOTSTAGE_DIGITS);
+			print_grouped_ull(rec->time_us, BOOTSTAGE_DIGITS);
+			printf("%5lu  %s\n",
+			       total ? rec->time_us * 100 / total : 0,
+			       get_record_name(buf, sizeof(buf), rec));
+		}
+		printf("%d initcalls, total %lu us\n", count, total);
+	}
+	if (next_id > BOOTSTAGE_ID_COUNT)
+		printf("(Overflowed internal boot id table by %d entries\n"
+			"- please increase CONFIG_BOOTSTAGE_USER_COUNT\n",
+		       next_id - BOOTSTAGE_ID_COUNT);
+	free(list);
+}
+
+/**
+ * Work out where a record sits on a boot timeline
+ *
+ * Plain accumulators are left out, since their time is spread over the
+ * boot with no single position.
+ *
+ * @param rec		Record to check
+ * @param startp	Returns the time of the mark, or the initcall start
+ * @param durationp	Returns the initcall duration, or 0 for a mark
+ * @return true if the record belongs on the timeline
+ */
+static bool get_timeline_record(struct bootstage_record *rec, ulong *startp,
+				ulong *durationp)
+{
+	if (rec->flags & BOOTSTAGEF_INITCALL) {
+		*startp = rec->start_us;
+		*durationp = rec->time_us;
+		return true;
+	}
+	/* The first record is only a placeholder for the reset */
+	if (!rec->time_us || rec->start_us || rec->id == BOOTSTAGE_ID_START)
+		return false;
+	*startp = rec->time_us;
+	*durationp = 0;
+
+	return true;
+}
+
+static void put_json_string(const char *str)
+{
+	putc('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			putc('\\');
+		if ((unsigned char)*str >= ' ')
+			putc(*str);
+	}
+	putc('"');
+}
+
+void bootstage_report_json(void)
+{
+	struct bootstage_record *rec;
+	char buf[BOOTSTAGE_NAME_LEN];
+	ulong start, duration;
+	const char *sep = "";
+	int id;
+
+	puts("{\"traceEvents\":[");
+	for (id = 0, rec = record; id < BOOTSTAGE_ID_COUNT; id++, rec++) {
+		if (!get_timeline_record(rec, &start, &duration))
+			continue;
+		printf("%s\n{\"name\":", sep);
+		put_json_string(get_record_name(buf, sizeof(buf), rec));
+		if (rec->flags & BOOTSTAGEF_INITCALL)
+			printf(",\"cat\":\"initcall\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu",
+			       start, duration);
+		else
+			printf(",\"cat\":\"bootstage\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%lu",
+			       start);
+		puts(",\"pid\":1,\"tid\":1}");
+		sep = ",";
+	}
+	puts("\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+int bootstage_list_marks(void *buff, int buff_size, unsigned *needed)
+{
+	struct trace_output_hdr *output_hdr = NULL;
+	struct bootstage_record *rec;
+	char buf[BOOTSTAGE_NAME_LEN];
+	ulong start, duration, offset;
+	void *end, *ptr = buff;
+	int id, upto;
+
+	end = buff ? buff + buff_size : NULL;
+
+	/* Place some header information */
+	if (ptr + sizeof(struct trace_output_hdr) < end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	/* Move the records onto the timebase used by the function trace */
+	offset = timer_get_us() - timer_get_boot_us();
+	for (id = upto = 0, rec = record; id < BOOTSTAGE_ID_COUNT;
+	     id++, rec++) {
+		if (!get_timeline_record(rec, &start, &duration))
+			continue;
+		if (ptr + sizeof(struct trace_output_mark) < end) {
+			struct trace_output_mark *out = ptr;
+
+			out->start_us = (start + offset) & FUNCF_TIMESTAMP_MASK;
+			out->duration_us = duration;
+			strlcpy(out->name,
+				get_record_name(buf, sizeof(buf), rec),
+				sizeof(out->name));
+			upto++;
+		}
+		ptr += sizeof(struct trace_output_mark);
+	}
+
+	/* Update the header */
+	if (output_hdr) {
+		output_hdr->rec_count = upto;
+		output_hdr->type = TRACE_CHUNK_BOOTSTAGE;
+	}
+
+	*needed = ptr - buff;
+	if (ptr > end)
+		return -1;
+
+	return 0;
 }
 
 ulong __timer_get_boot_us(void)
@@ -335,7 +571,7 @@ int bootstage_stash(void *base, int size)
 {
 	struct bootstage_hdr *hdr = (struct bootstage_hdr *)base;
 	struct bootstage_record *rec;
-	char buf[20];
+	char buf[BOOTSTAGE_NAME_LEN];
 	char *ptr = base, *end = ptr + size;
 	uint32_t count;
 	int id;
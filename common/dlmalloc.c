@@ -1620,6 +1620,9 @@ static unsigned long max_sbrked_mem = 0;
 /* The maximum via either sbrk or mmap */
 static unsigned long max_total_mem = 0;
 
+/* Number of calls to malloc() since it was set up, for malloc_get_info() */
+static ulong malloc_count;
+
 /* internal working copy of mallinfo */
 static struct mallinfo current_mallinfo = {  0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
@@ -2196,6 +2199,7 @@ Void_t* mALLOc(bytes) size_t bytes;
 
   if ((long)bytes < 0) return NULL;
 
+  malloc_count++;
   nb = request2size(bytes);  /* padded request size; */
 
   /* Check for exact match in a bin */
@@ -3241,6 +3245,66 @@ struct mallinfo mALLINFo()
 }
 #endif	/* DEBUG */
 
+/*
+  malloc_get_info fills in a summary of heap usage. Unlike mallinfo it
+  walks the chunks themselves rather than the bins, so that it can report
+  the number of allocations and the largest free chunk, which shows how
+  fragmented the heap has become.
+*/
+
+void malloc_get_info(struct malloc_info *info)
+{
+  mchunkptr p;
+  INTERNAL_SIZE_T sz;
+  ulong misalign;
+
+  memset(info, '\0', sizeof(*info));
+#ifdef CONFIG_SYS_MALLOC_F_LEN
+  if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
+    info->total = gd->malloc_limit;
+    info->heap = gd->malloc_ptr;
+    info->peak_heap = gd->malloc_ptr;
+    info->in_use = gd->malloc_ptr;
+    info->free = gd->malloc_limit - gd->malloc_ptr;
+    info->largest_free = info->free;
+    info->free_chunks = info->free ? 1 : 0;
+    return;
+  }
+#endif
+  info->total = mem_malloc_end - mem_malloc_start;
+  info->heap = sbrked_mem;
+  info->peak_heap = max_sbrked_mem;
+  info->malloc_count = malloc_count;
+  if (sbrk_base == (char*)(-1))
+    return;
+
+  /* The first chunk follows any alignment correction made by malloc_extend_top() */
+  p = (mchunkptr)sbrk_base;
+  misalign = (ulong)chunk2mem(p) & MALLOC_ALIGN_MASK;
+  if (misalign)
+    p = (mchunkptr)((char*)p + MALLOC_ALIGNMENT - misalign);
+
+  for (; p != top && (char*)p < sbrk_base + sbrked_mem; p = next_chunk(p)) {
+    sz = chunksize(p);
+    if (!sz)
+      break;
+    if (inuse(p)) {
+      info->in_use += sz;
+      info->allocs++;
+    } else {
+      info->free += sz;
+      info->free_chunks++;
+      info->largest_free = max(info->largest_free, (ulong)sz);
+    }
+  }
+
+  /* The top chunk can grow until it reaches the end of the region */
+  sz = chunksize(top) + (mem_malloc_end - mem_malloc_brk);
+  info->free += sz;
+  info->free_chunks++;
+  info->largest_free = max(info->largest_free, (ulong)sz);
+}
+
 
 
 
@@ -473,5 +473,39 @@ int hash_command(const char *algo_name, int flags, cmd_tbl_t *cmdtp, int flag,
 
 	return 0;
 }
+
+#ifdef CONFIG_CMD_HASH
+int hash_bench(ulong size)
+{
+	uint8_t output[HASH_MAX_DIGEST_SIZE];
+	ulong start, duration;
+	uint8_t *buf;
+	ulong pos;
+	int i;
+
+	/* The hash functions take an unsigned int length */
+	if (size > UINT_MAX)
+		return -EINVAL;
+	buf = malloc(size);
+	if (!buf)
+		return -ENOMEM;
+	for (pos = 0; pos < size; pos++)
+		buf[pos] = pos * 0x9d + (pos >> 10);
+
+	printf("Hashing %lu bytes:\n", size);
+	for (i = 0; i < ARRAY_SIZE(hash_algo); i++) {
+		struct hash_algo *algo = &hash_algo[i];
+
+		start = timer_get_us();
+		algo->hash_func_ws(buf, size, output, algo->chunk_size);
+		duration = timer_get_us() - start;
+		printf("%-10s %10lu us %8lu KB/s\n", algo->name, duration,
+		       (ulong)((u64)size * 1000 / (duration ? duration : 1)));
+	}
+	free(buf);
+
+	return 0;
+}
+#endif
 #endif
 #endif
@@ -11,6 +11,7 @@
 #include <autoboot.h>
 #include <cli.h>
 #include <console.h>
+#include <trace.h>
 #include <version.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -71,5 +72,10 @@ void main_loop(void)
 
 	autoboot_command(s);
 
+#ifdef CONFIG_PROFILER_BOOT
+	/* The boot is over, so don't fill the buffer at the prompt */
+	profile_stop();
+#endif
+
 	cli_loop();
 }
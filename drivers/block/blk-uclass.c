@@ -10,6 +10,7 @@
 #include <dm.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <malloc.h>
 
 int blk_first_device(int if_type, struct udevice **devp)
 {
@@ -81,10 +82,34 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
 
+	unsigned long blks_read;
+	lbaint_t count;
+	void *buf;
+
 	if (!ops->read)
 		return -ENOSYS;
 
-	return ops->read(dev, start, blkcnt, buffer);
+	if (blkcache_read(block_dev, start, blkcnt, buffer))
+		return blkcnt;
+
+	count = blkcache_readahead(block_dev, start, blkcnt);
+	if (count > blkcnt) {
+		buf = memalign(ARCH_DMA_MINALIGN, count * block_dev->blksz);
+		if (buf && ops->read(dev, start, count, buf) == count) {
+			blkcache_readahead_done(count - blkcnt);
+			blkcache_fill(block_dev, start, count, buf);
+			memcpy(buffer, buf, blkcnt * block_dev->blksz);
+			free(buf);
+			return blkcnt;
+		}
+		free(buf);
+	}
+
+	blks_read = ops->read(dev, start, blkcnt, buffer);
+	if (blks_read == blkcnt)
+		blkcache_fill(block_dev, start, blkcnt, buffer);
+
+	return blks_read;
 }
 
 unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
@@ -96,6 +121,8 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 	if (!ops->write)
 		return -ENOSYS;
 
+	blkcache_invalidate(block_dev);
+
 	return ops->write(dev, start, blkcnt, buffer);
 }
 
@@ -108,6 +135,8 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 	if (!ops->erase)
 		return -ENOSYS;
 
+	blkcache_invalidate(block_dev);
+
 	return ops->erase(dev, start, blkcnt);
 }
 
@@ -168,8 +197,16 @@ int blk_unbind_all(int if_type)
 	return 0;
 }
 
+static int blk_pre_remove(struct udevice *dev)
+{
+	blkcache_invalidate(dev_get_uclass_platdata(dev));
+
+	return 0;
+}
+
 UCLASS_DRIVER(blk) = {
 	.id		= UCLASS_BLK,
 	.name		= "blk",
+	.pre_remove	= blk_pre_remove,
 	.per_device_platdata_auto_alloc_size = sizeof(struct blk_desc),
 };
@@ -0,0 +1,186 @@
+/*
+ * Read cache for block devices
+ *
+ * Filesystems and partition drivers read the same small metadata blocks
+ * (partition tables, FAT sectors, ext4 group descriptors) many times over.
+ * Keep the most recent small reads in an LRU list so that these are served
+ * from memory, and read ahead when a device is being read sequentially.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <malloc.h>
+#include <linux/list.h>
+
+struct block_cache_node {
+	struct list_head lh;
+	struct udevice *dev;
+	int hwpart;
+	lbaint_t start;
+	lbaint_t blkcnt;
+	unsigned long blksz;
+	char *cache;
+};
+
+static LIST_HEAD(block_cache);
+
+static struct block_cache_stats _stats = {
+	.max_blocks_per_entry = 8,
+	.max_entries = 32,
+	.readahead_blocks = 8,
+};
+
+/* End of the last read, used to detect sequential access */
+static struct udevice *last_dev;
+static lbaint_t last_end;
+
+static struct block_cache_node *cache_find(struct blk_desc *desc,
+					   lbaint_t start, lbaint_t blkcnt)
+{
+	struct block_cache_node *node;
+
+	list_for_each_entry(node, &block_cache, lh) {
+		if (node->dev == desc->bdev && node->hwpart == desc->hwpart &&
+		    node->blksz == desc->blksz && node->start <= start &&
+		    node->start + node->blkcnt >= start + blkcnt) {
+			/* Move to the front of the LRU list */
+			if (&node->lh != block_cache.next)
+				list_move(&node->lh, &block_cache);
+			return node;
+		}
+	}
+
+	return NULL;
+}
+
+int blkcache_read(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
+		  void *buffer)
+{
+	struct block_cache_node *node;
+
+	if (blkcnt > _stats.max_blocks_per_entry)
+		return 0;
+
+	node = cache_find(desc, start, blkcnt);
+	if (node) {
+		memcpy(buffer, node->cache + (start - node->start) * desc->blksz,
+		       blkcnt * desc->blksz);
+		debug("hit: start " LBAF ", count " LBAFU "\n", start, blkcnt);
+		_stats.hits++;
+		last_dev = desc->bdev;
+		last_end = start + blkcnt;
+		return 1;
+	}
+
+	debug("miss: start " LBAF ", count " LBAFU "\n", start, blkcnt);
+	_stats.misses++;
+
+	return 0;
+}
+
+lbaint_t blkcache_readahead(struct blk_desc *desc, lbaint_t start,
+			    lbaint_t blkcnt)
+{
+	lbaint_t count = blkcnt;
+
+	if (blkcnt <= _stats.max_blocks_per_entry &&
+	    desc->bdev == last_dev && start == last_end) {
+		count = max(blkcnt, (lbaint_t)_stats.readahead_blocks);
+		count = min(count, (lbaint_t)_stats.max_blocks_per_entry);
+		/* Do not read ahead past the end of the device */
+		if (start + count > desc->lba)
+			count = max(blkcnt, start < desc->lba ?
+				    desc->lba - start : 0);
+	}
+	last_dev = desc->bdev;
+	last_end = start + blkcnt;
+
+	return count;
+}
+
+void blkcache_readahead_done(lbaint_t blkcnt)
+{
+	_stats.readahead += blkcnt;
+}
+
+void blkcache_fill(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
+		   const void *buffer)
+{
+	lbaint_t bytes = blkcnt * desc->blksz;
+	struct block_cache_node *node;
+
+	if (!_stats.max_entries || blkcnt > _stats.max_blocks_per_entry)
+		return;
+
+	if (_stats.entries >= _stats.max_entries) {
+		/* Reuse the least recently used entry */
+		node = list_entry(block_cache.prev, struct block_cache_node,
+				  lh);
+		list_del(&node->lh);
+		_stats.entries--;
+		debug("drop: start " LBAF ", count " LBAFU "\n", node->start,
+		      node->blkcnt);
+		if (node->blkcnt * node->blksz < bytes) {
+			free(node->cache);
+			node->cache = NULL;
+		}
+	} else {
+		node = malloc(sizeof(*node));
+		if (!node)
+			return;
+		node->cache = NULL;
+	}
+
+	if (!node->cache) {
+		node->cache = malloc(bytes);
+		if (!node->cache) {
+			free(node);
+			return;
+		}
+	}
+
+	debug("fill: start " LBAF ", count " LBAFU "\n", start, blkcnt);
+	node->dev = desc->bdev;
+	node->hwpart = desc->hwpart;
+	node->start = start;
+	node->blkcnt = blkcnt;
+	node->blksz = desc->blksz;
+	memcpy(node->cache, buffer, bytes);
+	list_add(&node->lh, &block_cache);
+	_stats.entries++;
+}
+
+void blkcache_invalidate(struct blk_desc *desc)
+{
+	struct block_cache_node *node, *next;
+
+	list_for_each_entry_safe(node, next, &block_cache, lh) {
+		if (!desc || node->dev == desc->bdev) {
+			list_del(&node->lh);
+			free(node->cache);
+			free(node);
+			_stats.entries--;
+		}
+	}
+	if (!desc || last_dev == desc->bdev)
+		last_dev = NULL;
+}
+
+void blkcache_configure(unsigned blocks, unsigned entries,
+			unsigned readahead)
+{
+	blkcache_invalidate(NULL);
+	_stats.max_blocks_per_entry = blocks;
+	_stats.max_entries = entries;
+	_stats.readahead_blocks = readahead;
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.readahead = 0;
+}
+
+void blkcache_stats(struct block_cache_stats *stats)
+{
+	memcpy(stats, &_stats, sizeof(*stats));
+}
@@ -72,7 +72,7 @@ int device_unbind(struct udevice *dev)
 	if (!dev)
 		return -EINVAL;
 
-	if (dev->flags & DM_FLAG_ACTIVATED)
+	if (dev->flags & (DM_FLAG_ACTIVATED | DM_FLAG_PROBE_PENDING))
 		return -EINVAL;
 
 	if (!(dev->flags & DM_FLAG_BOUND))
@@ -157,6 +157,10 @@ int device_remove(struct udevice *dev)
 	if (!dev)
 		return -EINVAL;
 
+	/* Let a background probe finish first, so it can be undone */
+	if (dev->flags & DM_FLAG_PROBE_PENDING)
+		device_probe(dev);
+
 	if (!(dev->flags & DM_FLAG_ACTIVATED))
 		return 0;
 
@@ -223,7 +223,133 @@ static void *alloc_priv(int size, uint flags)
 	return priv;
 }
 
-int device_probe(struct udevice *dev)
+/**
+ * struct probe_pending - A device whose probe is finishing in the background
+ *
+ * @node:	Entry in probe_pending_list
+ * @dev:	Device being probed
+ */
+struct probe_pending {
+	struct list_head node;
+	struct udevice *dev;
+};
+
+/* These are only used after relocation, since they live in BSS */
+static LIST_HEAD(probe_pending_list);
+static bool probe_polling;
+
+static void device_probe_fail(struct udevice *dev)
+{
+	dev->flags &= ~DM_FLAG_ACTIVATED;
+
+	dev->seq = -1;
+	device_free(dev);
+}
+
+/* Complete the probe once the driver has finished, successfully or not */
+static int device_probe_done(struct udevice *dev, int ret)
+{
+	dev->flags &= ~DM_FLAG_PROBE_PENDING;
+	if (ret) {
+		device_probe_fail(dev);
+		return ret;
+	}
+
+	dev->flags |= DM_FLAG_ACTIVATED;
+	ret = uclass_post_probe_device(dev);
+	if (ret) {
+		if (device_remove(dev)) {
+			dm_warn("%s: Device '%s' failed to remove on error path\n",
+				__func__, dev->name);
+		}
+		device_probe_fail(dev);
+	}
+
+	return ret;
+}
+
+static int device_probe_queue(struct udevice *dev)
+{
+	struct probe_pending *pend;
+
+	if (!(gd->flags & GD_FLG_RELOC))
+		return -ENOSYS;
+	pend = malloc(sizeof(*pend));
+	if (!pend)
+		return -ENOMEM;
+	pend->dev = dev;
+	list_add_tail(&pend->node, &probe_pending_list);
+
+	return 0;
+}
+
+static void device_probe_dequeue(struct udevice *dev)
+{
+	struct probe_pending *pend;
+
+	if (!(gd->flags & GD_FLG_RELOC))
+		return;
+	list_for_each_entry(pend, &probe_pending_list, node) {
+		if (pend->dev == dev) {
+			list_del(&pend->node);
+			free(pend);
+			return;
+		}
+	}
+}
+
+/* Wait for a pending probe to finish, letting other probes progress too */
+static int device_probe_wait(struct udevice *dev)
+{
+	int ret;
+
+	device_probe_dequeue(dev);
+	while ((ret = dev->driver->probe_poll(dev)) == -EINPROGRESS)
+		device_probe_poll();
+
+	return device_probe_done(dev, ret);
+}
+
+int device_probe_poll(void)
+{
+	struct probe_pending *pend;
+	struct udevice *dev;
+	int count = 0;
+	int ret;
+
+	if (!(gd->flags & GD_FLG_RELOC))
+		return 0;
+
+	/*
+	 * Finishing a probe runs uclass code which may itself wait for a
+	 * device on the list, so start again after each one.
+	 */
+	if (!probe_polling) {
+		probe_polling = true;
+restart:
+		list_for_each_entry(pend, &probe_pending_list, node) {
+			dev = pend->dev;
+			ret = dev->driver->probe_poll(dev);
+			if (ret == -EINPROGRESS)
+				continue;
+			list_del(&pend->node);
+			free(pend);
+			if (device_probe_done(dev, ret)) {
+				dm_warn("%s: Device '%s' failed to probe\n",
+					__func__, dev->name);
+			}
+			goto restart;
+		}
+		probe_polling = false;
+	}
+
+	list_for_each_entry(pend, &probe_pending_list, node)
+		count++;
+
+	return count;
+}
+
+static int device_do_probe(struct udevice *dev, bool async)
 {
 	const struct driver *drv;
 	int size = 0;
@@ -233,6 +359,9 @@ int device_probe(struct udevice *dev)
 	if (!dev)
 		return -EINVAL;
 
+	if (dev->flags & DM_FLAG_PROBE_PENDING)
+		return async ? -EINPROGRESS : device_probe_wait(dev);
+
 	if (dev->flags & DM_FLAG_ACTIVATED)
 		return 0;
 
@@ -322,31 +451,38 @@ int device_probe(struct udevice *dev)
 
 	if (drv->probe) {
 		ret = drv->probe(dev);
+		if (ret == -EINPROGRESS && drv->probe_poll) {
+			/* The device is not active until probe_poll() is done */
+			dev->flags &= ~DM_FLAG_ACTIVATED;
+			dev->flags |= DM_FLAG_PROBE_PENDING;
+			if (async && !device_probe_queue(dev))
+				return -EINPROGRESS;
+
+			return device_probe_wait(dev);
+		}
 		if (ret) {
 			dev->flags &= ~DM_FLAG_ACTIVATED;
 			goto fail;
 		}
 	}
 
-	ret = uclass_post_probe_device(dev);
-	if (ret)
-		goto fail_uclass;
-
-	return 0;
-fail_uclass:
-	if (device_remove(dev)) {
-		dm_warn("%s: Device '%s' failed to remove on error path\n",
-			__func__, dev->name);
-	}
+	return device_probe_done(dev, 0);
 fail:
-	dev->flags &= ~DM_FLAG_ACTIVATED;
-
-	dev->seq = -1;
-	device_free(dev);
+	device_probe_fail(dev);
 
 	return ret;
 }
 
+int device_probe(struct udevice *dev)
+{
+	return device_do_probe(dev, false);
+}
+
+int device_probe_start(struct udevice *dev)
+{
+	return device_do_probe(dev, true);
+}
+
 void *dev_get_platdata(struct udevice *dev)
 {
 	if (!dev) {
@@ -585,7 +721,7 @@ const char *dev_get_uclass_name(struct udevice *dev)
 
 fdt_addr_t dev_get_addr_index(struct udevice *dev, int index)
 {
-#if CONFIG_IS_ENABLED(OF_CONTROL)
+#if CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)
 	fdt_addr_t addr;
 
 	if (CONFIG_IS_ENABLED(OF_TRANSLATE)) {
@@ -605,7 +741,7 @@ fdt_addr_t dev_get_addr_index(struct udevice *dev, int index)
 			return FDT_ADDR_T_NONE;
 		}
 
-		reg = fdt_getprop(gd->fdt_blob, dev->of_offset, "reg", &len);
+		reg = fdtdec_getprop(gd->fdt_blob, dev->of_offset, "reg", &len);
 		if (!reg || (len <= (index * sizeof(fdt32_t) * (na + ns)))) {
 			debug("Req index out of range\n");
 			return FDT_ADDR_T_NONE;
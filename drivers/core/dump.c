@@ -18,7 +18,8 @@ static void show_devices(struct udevice *dev, int depth, int last_flag)
 	/* print the first 11 characters to not break the tree-format. */
 	strlcpy(class_name, dev->uclass->uc_drv->name, sizeof(class_name));
 	printf(" %-11s [ %c ]    ", class_name,
-	       dev->flags & DM_FLAG_ACTIVATED ? '+' : ' ');
+	       dev->flags & DM_FLAG_ACTIVATED ? '+' :
+	       dev->flags & DM_FLAG_PROBE_PENDING ? '~' : ' ');
 
 	for (i = depth; i >= 0; i--) {
 		is_last = (last_flag >> i) & 1;
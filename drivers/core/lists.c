@@ -16,8 +16,175 @@
 #include <dm/uclass.h>
 #include <dm/util.h>
 #include <fdtdec.h>
+#include <malloc.h>
 #include <linux/compiler.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
+#if CONFIG_IS_ENABLED(DM_LIST_INDEX)
+/**
+ * struct dm_compat_entry - A compatible string which a driver can bind to
+ *
+ * @compatible:	The compatible string
+ * @drv:	Driver which lists it
+ * @match:	Position of the string in the driver's of_match table
+ */
+struct dm_compat_entry {
+	const char *compatible;
+	struct driver *drv;
+	int match;
+};
+
+/**
+ * struct dm_list_index - Sorted index of the driver and uclass linker lists
+ *
+ * This is built on first use and placed in the malloc() area. Since the
+ * pre-relocation malloc() area does not survive relocation, initr_dm() drops
+ * the pointer so that the index is built again after relocation.
+ *
+ * @drv_count:		Number of entries in @by_name
+ * @compat_count:	Number of entries in @compat
+ * @uclass:		Uclass driver for each uclass ID, or NULL if none
+ * @by_name:		Drivers, sorted by name then linker-list position
+ * @compat:		All compatible strings, sorted by string, then driver,
+ *			then position in the driver's of_match table
+ */
+struct dm_list_index {
+	int drv_count;
+	int compat_count;
+	struct uclass_driver *uclass[UCLASS_COUNT];
+	struct driver **by_name;
+	struct dm_compat_entry *compat;
+};
+
+static int lists_drv_compar(const void *a, const void *b)
+{
+	struct driver *const *drva = a, *const *drvb = b;
+	int ret;
+
+	ret = strcmp((*drva)->name, (*drvb)->name);
+	if (ret)
+		return ret;
+
+	/* Keep linker-list order for duplicate names */
+	return *drva < *drvb ? -1 : *drva > *drvb;
+}
+
+static int lists_compat_compar(const void *a, const void *b)
+{
+	const struct dm_compat_entry *compa = a, *compb = b;
+	int ret;
+
+	ret = strcmp(compa->compatible, compb->compatible);
+	if (ret)
+		return ret;
+	/* Linker-list order is address order */
+	if (compa->drv != compb->drv)
+		return compa->drv < compb->drv ? -1 : 1;
+
+	return compa->match - compb->match;
+}
+
+static struct dm_list_index *lists_index(void)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_drv = ll_entry_count(struct driver, driver);
+	struct uclass_driver *uclass =
+		ll_entry_start(struct uclass_driver, uclass);
+	const int n_uc = ll_entry_count(struct uclass_driver, uclass);
+	struct dm_list_index *idx = gd->dm_list_index;
+	const struct udevice_id *of_match;
+	struct dm_compat_entry *comp;
+	struct uclass_driver *uc;
+	struct driver *entry;
+	int n_compat = 0;
+
+	if (idx)
+		return idx;
+
+	for (entry = driver; entry != driver + n_drv; entry++) {
+		for (of_match = entry->of_match;
+		     of_match && of_match->compatible; of_match++)
+			n_compat++;
+	}
+
+	idx = malloc(sizeof(*idx) + n_drv * sizeof(struct driver *) +
+		     n_compat * sizeof(struct dm_compat_entry));
+	if (!idx)
+		return NULL;
+	idx->drv_count = n_drv;
+	idx->compat_count = n_compat;
+	idx->by_name = (struct driver **)(idx + 1);
+	idx->compat = (struct dm_compat_entry *)(idx->by_name + n_drv);
+
+	/* Go backwards so that the first driver for each ID wins */
+	memset(idx->uclass, '\0', sizeof(idx->uclass));
+	for (uc = uclass + n_uc; uc-- != uclass;) {
+		if (uc->id >= 0 && uc->id < UCLASS_COUNT)
+			idx->uclass[uc->id] = uc;
+	}
+
+	comp = idx->compat;
+	for (entry = driver; entry != driver + n_drv; entry++) {
+		idx->by_name[entry - driver] = entry;
+		for (of_match = entry->of_match;
+		     of_match && of_match->compatible; of_match++) {
+			comp->compatible = of_match->compatible;
+			comp->drv = entry;
+			comp->match = of_match - entry->of_match;
+			comp++;
+		}
+	}
+	qsort(idx->by_name, n_drv, sizeof(struct driver *), lists_drv_compar);
+	qsort(idx->compat, n_compat, sizeof(struct dm_compat_entry),
+	      lists_compat_compar);
+	gd->dm_list_index = idx;
+
+	return idx;
+}
+
+/* Find the first driver which is called @name */
+static struct driver *lists_index_lookup_name(struct dm_list_index *idx,
+					      const char *name)
+{
+	int low = 0, high = idx->drv_count;
+
+	while (low < high) {
+		int mid = (low + high) / 2;
+
+		if (strcmp(idx->by_name[mid]->name, name) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low < idx->drv_count && !strcmp(idx->by_name[low]->name, name))
+		return idx->by_name[low];
+
+	return NULL;
+}
+
+/* Find the first entry for @compatible, i.e. the earliest driver */
+static struct dm_compat_entry *lists_index_lookup_compat(
+		struct dm_list_index *idx, const char *compatible)
+{
+	int low = 0, high = idx->compat_count;
+
+	while (low < high) {
+		int mid = (low + high) / 2;
+
+		if (strcmp(idx->compat[mid].compatible, compatible) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low < idx->compat_count &&
+	    !strcmp(idx->compat[low].compatible, compatible))
+		return &idx->compat[low];
+
+	return NULL;
+}
+#endif
+
 struct driver *lists_driver_lookup_name(const char *name)
 {
 	struct driver *drv =
@@ -25,6 +192,12 @@ struct driver *lists_driver_lookup_name(const char *name)
 	const int n_ents = ll_entry_count(struct driver, driver);
 	struct driver *entry;
 
+#if CONFIG_IS_ENABLED(DM_LIST_INDEX)
+	struct dm_list_index *idx = lists_index();
+
+	if (idx)
+		return lists_index_lookup_name(idx, name);
+#endif
 	for (entry = drv; entry != drv + n_ents; entry++) {
 		if (!strcmp(name, entry->name))
 			return entry;
@@ -41,6 +214,12 @@ struct uclass_driver *lists_uclass_lookup(enum uclass_id id)
 	const int n_ents = ll_entry_count(struct uclass_driver, uclass);
 	struct uclass_driver *entry;
 
+#if CONFIG_IS_ENABLED(DM_LIST_INDEX)
+	struct dm_list_index *idx = lists_index();
+
+	if (idx)
+		return id >= 0 && id < UCLASS_COUNT ? idx->uclass[id] : NULL;
+#endif
 	for (entry = uclass; entry != uclass + n_ents; entry++) {
 		if (entry->id == id)
 			return entry;
@@ -99,7 +278,7 @@ int device_bind_driver_to_node(struct udevice *parent, const char *drv_name,
 	return 0;
 }
 
-#if CONFIG_IS_ENABLED(OF_CONTROL)
+#if CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)
 /**
  * driver_check_compatible() - Check if a driver is compatible with this node
  *
@@ -138,57 +317,108 @@ static int driver_check_compatible(const void *blob, int offset,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, const void *blob, int offset,
-		   struct udevice **devp)
+#if CONFIG_IS_ENABLED(DM_LIST_INDEX)
+/*
+ * Pick the same driver as the linear search would: the earliest one in the
+ * linker list which lists any of the node's compatible strings, using the
+ * first matching entry in its of_match table.
+ */
+static int lists_index_check_compatible(struct dm_list_index *idx,
+					const void *blob, int offset,
+					struct driver **drvp,
+					const struct udevice_id **of_idp)
+{
+	struct dm_compat_entry *best = NULL, *comp;
+	const char *compat, *end;
+	int len;
+
+	compat = fdtdec_getprop(blob, offset, "compatible", &len);
+	if (!compat)
+		return len == -FDT_ERR_NOTFOUND ? -ENODEV : -EINVAL;
+
+	for (end = compat + len; compat < end; compat += strlen(compat) + 1) {
+		comp = lists_index_lookup_compat(idx, compat);
+		if (comp && (!best || comp->drv < best->drv ||
+			     (comp->drv == best->drv &&
+			      comp->match < best->match)))
+			best = comp;
+	}
+	if (!best)
+		return -ENOENT;
+
+	*drvp = best->drv;
+	*of_idp = &best->drv->of_match[best->match];
+
+	return 0;
+}
+#endif
+
+int lists_driver_lookup_compatible(const void *blob, int offset,
+				   struct driver **drvp,
+				   const struct udevice_id **of_idp)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+	int ret = -ENOENT;
+#if CONFIG_IS_ENABLED(DM_LIST_INDEX)
+	struct dm_list_index *idx = lists_index();
+#endif
+
+	*drvp = NULL;
+	*of_idp = NULL;
+#if CONFIG_IS_ENABLED(DM_LIST_INDEX)
+	if (idx)
+		return lists_index_check_compatible(idx, blob, offset, drvp,
+						    of_idp);
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		ret = driver_check_compatible(blob, offset, entry->of_match,
+					      of_idp);
+		if (ret != -ENOENT)
+			break;
+	}
+	if (!ret)
+		*drvp = entry;
+
+	return ret;
+}
+
+int lists_bind_fdt(struct udevice *parent, const void *blob, int offset,
+		   struct udevice **devp)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
-	bool found = false;
 	const char *name;
-	int result = 0;
-	int ret = 0;
+	int ret;
 
 	dm_dbg("bind node %s\n", fdt_get_name(blob, offset, NULL));
 	if (devp)
 		*devp = NULL;
-	for (entry = driver; entry != driver + n_ents; entry++) {
-		ret = driver_check_compatible(blob, offset, entry->of_match,
-					      &id);
-		name = fdt_get_name(blob, offset, NULL);
-		if (ret == -ENOENT) {
-			continue;
-		} else if (ret == -ENODEV) {
-			dm_dbg("Device '%s' has no compatible string\n", name);
-			break;
-		} else if (ret) {
-			dm_warn("Device tree error at offset %d\n", offset);
-			result = ret;
-			break;
-		}
-
-		dm_dbg("   - found match at '%s'\n", entry->name);
-		ret = device_bind(parent, entry, name, NULL, offset, &dev);
-		if (ret) {
-			dm_warn("Error binding driver '%s': %d\n", entry->name,
-				ret);
-			return ret;
-		} else {
-			dev->driver_data = id->data;
-			found = true;
-			if (devp)
-				*devp = dev;
-		}
-		break;
+	name = fdt_get_name(blob, offset, NULL);
+	ret = lists_driver_lookup_compatible(blob, offset, &entry, &id);
+	if (ret == -ENOENT) {
+		dm_dbg("No match for node '%s'\n", name);
+		return 0;
+	} else if (ret == -ENODEV) {
+		dm_dbg("Device '%s' has no compatible string\n", name);
+		return 0;
+	} else if (ret) {
+		dm_warn("Device tree error at offset %d\n", offset);
+		return ret;
 	}
 
-	if (!found && !result && ret != -ENODEV) {
-		dm_dbg("No match for node '%s'\n",
-		       fdt_get_name(blob, offset, NULL));
+	dm_dbg("   - found match at '%s'\n", entry->name);
+	ret = device_bind(parent, entry, name, NULL, offset, &dev);
+	if (ret) {
+		dm_warn("Error binding driver '%s': %d\n", entry->name, ret);
+		return ret;
 	}
+	dev->driver_data = id->data;
+	if (devp)
+		*devp = dev;
 
-	return result;
+	return 0;
 }
 #endif
@@ -73,6 +73,8 @@ void fix_drivers(void)
 			entry->bind += gd->reloc_off;
 		if (entry->probe)
 			entry->probe += gd->reloc_off;
+		if (entry->probe_poll)
+			entry->probe_poll += gd->reloc_off;
 		if (entry->remove)
 			entry->remove += gd->reloc_off;
 		if (entry->unbind)
@@ -142,7 +144,7 @@ int dm_init(void)
 	ret = device_bind_by_name(NULL, false, &root_info, &DM_ROOT_NON_CONST);
 	if (ret)
 		return ret;
-#if CONFIG_IS_ENABLED(OF_CONTROL)
+#if CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)
 	DM_ROOT_NON_CONST->of_offset = 0;
 #endif
 	ret = device_probe(DM_ROOT_NON_CONST);
@@ -173,7 +175,7 @@ int dm_scan_platdata(bool pre_reloc_only)
 	return ret;
 }
 
-#if CONFIG_IS_ENABLED(OF_CONTROL)
+#if CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)
 int dm_scan_fdt_node(struct udevice *parent, const void *blob, int offset,
 		     bool pre_reloc_only)
 {
@@ -214,6 +216,30 @@ __weak int dm_scan_other(bool pre_reloc_only)
 	return 0;
 }
 
+static void dm_probe_async_children(struct udevice *parent)
+{
+	struct udevice *dev;
+	int ret;
+
+	list_for_each_entry(dev, &parent->child_head, sibling_node) {
+		if (dev->driver->flags & DM_FLAG_PROBE_ASYNC) {
+			ret = device_probe_start(dev);
+			if (ret && ret != -EINPROGRESS) {
+				dm_warn("%s: Device '%s' failed to probe: %d\n",
+					__func__, dev->name, ret);
+			}
+		}
+		dm_probe_async_children(dev);
+	}
+}
+
+int dm_probe_async(void)
+{
+	dm_probe_async_children(DM_ROOT_NON_CONST);
+
+	return device_probe_poll();
+}
+
 int dm_init_and_scan(bool pre_reloc_only)
 {
 	int ret;
@@ -229,7 +255,7 @@ int dm_init_and_scan(bool pre_reloc_only)
 		return ret;
 	}
 
-	if (CONFIG_IS_ENABLED(OF_CONTROL)) {
+	if (CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)) {
 		ret = dm_scan_fdt(gd->fdt_blob, pre_reloc_only);
 		if (ret) {
 			debug("dm_scan_fdt() failed: %d\n", ret);
@@ -54,6 +54,8 @@ int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 {
 	int ret;
 
+	mmc->stats.cmds++;
+
 #ifdef CONFIG_MMC_TRACE
 	int i;
 	u8 *ptr;
@@ -163,14 +165,33 @@ int mmc_send_status(struct mmc *mmc, int timeout)
 int mmc_set_blocklen(struct mmc *mmc, int len)
 {
 	struct mmc_cmd cmd;
+	int err;
 
-	if (mmc->ddr_mode)
+	if (mmc->ddr_mode || mmc->blocklen == len)
 		return 0;
 
 	cmd.cmdidx = MMC_CMD_SET_BLOCKLEN;
 	cmd.resp_type = MMC_RSP_R1;
 	cmd.cmdarg = len;
 
+	err = mmc_send_cmd(mmc, &cmd, NULL);
+	if (!err)
+		mmc->blocklen = len;
+
+	return err;
+}
+
+int mmc_set_blockcount(struct mmc *mmc, unsigned int blockcount,
+		       bool is_rel_write)
+{
+	struct mmc_cmd cmd = {0};
+
+	cmd.cmdidx = MMC_CMD_SET_BLOCK_COUNT;
+	cmd.cmdarg = blockcount & 0x0000FFFF;
+	if (is_rel_write)
+		cmd.cmdarg |= 1 << 31;
+	cmd.resp_type = MMC_RSP_R1;
+
 	return mmc_send_cmd(mmc, &cmd, NULL);
 }
 
@@ -198,6 +219,11 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 {
 	struct mmc_cmd cmd;
 	struct mmc_data data;
+	bool predefined = blkcnt > 1 && (mmc->card_caps & MMC_MODE_CMD23);
+
+	/* With a block count set first, the card stops by itself */
+	if (predefined && mmc_set_blockcount(mmc, blkcnt, false))
+		return 0;
 
 	if (blkcnt > 1)
 		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
@@ -219,7 +245,7 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 	if (mmc_send_cmd(mmc, &cmd, &data))
 		return 0;
 
-	if (blkcnt > 1) {
+	if (blkcnt > 1 && !predefined) {
 		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
 		cmd.cmdarg = 0;
 		cmd.resp_type = MMC_RSP_R1b;
@@ -240,6 +266,7 @@ static ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start,
 	int dev_num = block_dev->devnum;
 	int err;
 	lbaint_t cur, blocks_todo = blkcnt;
+	ulong start_us;
 
 	if (blkcnt == 0)
 		return 0;
@@ -265,9 +292,9 @@ static ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start,
 		return 0;
 	}
 
+	start_us = timer_get_us();
 	do {
-		cur = (blocks_todo > mmc->cfg->b_max) ?
-			mmc->cfg->b_max : blocks_todo;
+		cur = min(blocks_todo, mmc_max_blocks(mmc));
 		if (mmc_read_blocks(mmc, dst, start, cur) != cur) {
 			debug("%s: Failed to read blocks\n", __func__);
 			return 0;
@@ -276,6 +303,8 @@ static ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start,
 		start += cur;
 		dst += cur * mmc->read_bl_len;
 	} while (blocks_todo > 0);
+	mmc->stats.read_blocks += blkcnt;
+	mmc->stats.read_us += timer_get_us() - start_us;
 
 	return blkcnt;
 }
@@ -301,51 +330,61 @@ static int mmc_go_idle(struct mmc *mmc)
 	return 0;
 }
 
-static int sd_send_op_cond(struct mmc *mmc)
+static int sd_send_op_cond_iter(struct mmc *mmc)
 {
-	int timeout = 1000;
-	int err;
 	struct mmc_cmd cmd;
+	int err;
 
-	while (1) {
-		cmd.cmdidx = MMC_CMD_APP_CMD;
-		cmd.resp_type = MMC_RSP_R1;
-		cmd.cmdarg = 0;
+	cmd.cmdidx = MMC_CMD_APP_CMD;
+	cmd.resp_type = MMC_RSP_R1;
+	cmd.cmdarg = 0;
 
-		err = mmc_send_cmd(mmc, &cmd, NULL);
+	err = mmc_send_cmd(mmc, &cmd, NULL);
 
-		if (err)
-			return err;
+	if (err)
+		return err;
 
-		cmd.cmdidx = SD_CMD_APP_SEND_OP_COND;
-		cmd.resp_type = MMC_RSP_R3;
+	cmd.cmdidx = SD_CMD_APP_SEND_OP_COND;
+	cmd.resp_type = MMC_RSP_R3;
 
-		/*
-		 * Most cards do not answer if some reserved bits
-		 * in the ocr are set. However, Some controller
-		 * can set bit 7 (reserved for low voltages), but
-		 * how to manage low voltages SD card is not yet
-		 * specified.
-		 */
-		cmd.cmdarg = mmc_host_is_spi(mmc) ? 0 :
-			(mmc->cfg->voltages & 0xff8000);
+	/*
+	 * Most cards do not answer if some reserved bits
+	 * in the ocr are set. However, Some controller
+	 * can set bit 7 (reserved for low voltages), but
+	 * how to manage low voltages SD card is not yet
+	 * specified.
+	 */
+	cmd.cmdarg = mmc_host_is_spi(mmc) ? 0 :
+		(mmc->cfg->voltages & 0xff8000);
 
-		if (mmc->version == SD_VERSION_2)
-			cmd.cmdarg |= OCR_HCS;
+	if (mmc->version == SD_VERSION_2)
+		cmd.cmdarg |= OCR_HCS;
 
-		err = mmc_send_cmd(mmc, &cmd, NULL);
+	err = mmc_send_cmd(mmc, &cmd, NULL);
 
-		if (err)
-			return err;
+	if (err)
+		return err;
+	mmc->ocr = cmd.response[0];
+	return 0;
+}
 
-		if (cmd.response[0] & OCR_BUSY)
-			break;
+/* Start the card powering up, without waiting for it to finish */
+static int sd_send_op_cond(struct mmc *mmc)
+{
+	int err;
 
-		if (timeout-- <= 0)
-			return UNUSABLE_ERR;
+	err = sd_send_op_cond_iter(mmc);
+	if (err)
+		return err;
+	mmc->op_cond_pending = MMC_OP_COND_SD;
+	mmc->op_cond_start = get_timer(0);
+	return 0;
+}
 
-		udelay(1000);
-	}
+static int sd_complete_op_cond(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+	int err;
 
 	if (mmc->version != SD_VERSION_2)
 		mmc->version = SD_VERSION_1_0;
@@ -359,9 +398,9 @@ static int sd_send_op_cond(struct mmc *mmc)
 
 		if (err)
 			return err;
-	}
 
-	mmc->ocr = cmd.response[0];
+		mmc->ocr = cmd.response[0];
+	}
 
 	mmc->high_capacity = ((mmc->ocr & OCR_HCS) == OCR_HCS);
 	mmc->rca = 0;
@@ -407,32 +446,16 @@ static int mmc_send_op_cond(struct mmc *mmc)
 		if (mmc->ocr & OCR_BUSY)
 			break;
 	}
-	mmc->op_cond_pending = 1;
+	mmc->op_cond_pending = MMC_OP_COND_MMC;
+	mmc->op_cond_start = get_timer(0);
 	return 0;
 }
 
 static int mmc_complete_op_cond(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
-	int timeout = 1000;
-	uint start;
 	int err;
 
-	mmc->op_cond_pending = 0;
-	if (!(mmc->ocr & OCR_BUSY)) {
-		start = get_timer(0);
-		while (1) {
-			err = mmc_send_op_cond_iter(mmc, 1);
-			if (err)
-				return err;
-			if (mmc->ocr & OCR_BUSY)
-				break;
-			if (get_timer(start) > timeout)
-				return UNUSABLE_ERR;
-			udelay(100);
-		}
-	}
-
 	if (mmc_host_is_spi(mmc)) { /* read OCR for spi */
 		cmd.cmdidx = MMC_CMD_SPI_READ_OCR;
 		cmd.resp_type = MMC_RSP_R3;
@@ -454,6 +477,34 @@ static int mmc_complete_op_cond(struct mmc *mmc)
 	return 0;
 }
 
+/*
+ * Check whether the card has finished powering up, sending one more op_cond
+ * command if needed. This returns -EINPROGRESS while the card is still busy,
+ * so that the caller can get on with something else in the meantime.
+ */
+static int mmc_poll_op_cond(struct mmc *mmc)
+{
+	bool sd = mmc->op_cond_pending == MMC_OP_COND_SD;
+	int err = 0;
+
+	if (!(mmc->ocr & OCR_BUSY)) {
+		if (sd)
+			err = sd_send_op_cond_iter(mmc);
+		else
+			err = mmc_send_op_cond_iter(mmc, 1);
+		if (!err && !(mmc->ocr & OCR_BUSY)) {
+			if (get_timer(mmc->op_cond_start) <= MMC_OP_COND_TIMEOUT)
+				return -EINPROGRESS;
+			err = UNUSABLE_ERR;
+		}
+	}
+
+	mmc->op_cond_pending = 0;
+	if (err)
+		return err;
+
+	return sd ? sd_complete_op_cond(mmc) : mmc_complete_op_cond(mmc);
+}
 
 static int mmc_send_ext_csd(struct mmc *mmc, u8 *ext_csd)
 {
@@ -477,7 +528,8 @@ static int mmc_send_ext_csd(struct mmc *mmc, u8 *ext_csd)
 }
 
 
-static int mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value)
+static int __mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value,
+			bool send_status)
 {
 	struct mmc_cmd cmd;
 	int timeout = 1000;
@@ -492,17 +544,22 @@ static int mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value)
 	ret = mmc_send_cmd(mmc, &cmd, NULL);
 
 	/* Waiting for the ready status */
-	if (!ret)
+	if (!ret && send_status)
 		ret = mmc_send_status(mmc, timeout);
 
 	return ret;
 
 }
 
+static int mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value)
+{
+	return __mmc_switch(mmc, set, index, value, true);
+}
+
 static int mmc_change_freq(struct mmc *mmc)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(u8, ext_csd, MMC_MAX_BLOCK_LEN);
-	char cardtype;
+	u8 cardtype;
 	int err;
 
 	mmc->card_caps = 0;
@@ -514,14 +571,14 @@ static int mmc_change_freq(struct mmc *mmc)
 	if (mmc->version < MMC_VERSION_4)
 		return 0;
 
-	mmc->card_caps |= MMC_MODE_4BIT | MMC_MODE_8BIT;
+	mmc->card_caps |= MMC_MODE_4BIT | MMC_MODE_8BIT | MMC_MODE_CMD23;
 
 	err = mmc_send_ext_csd(mmc, ext_csd);
 
 	if (err)
 		return err;
 
-	cardtype = ext_csd[EXT_CSD_CARD_TYPE] & 0xf;
+	cardtype = ext_csd[EXT_CSD_CARD_TYPE];
 
 	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING, 1);
 
@@ -542,6 +599,10 @@ static int mmc_change_freq(struct mmc *mmc)
 	if (cardtype & EXT_CSD_CARD_TYPE_52) {
 		if (cardtype & EXT_CSD_CARD_TYPE_DDR_1_8V)
 			mmc->card_caps |= MMC_MODE_DDR_52MHz;
+		if (cardtype & EXT_CSD_CARD_TYPE_HS200)
+			mmc->card_caps |= MMC_MODE_HS200;
+		if (cardtype & EXT_CSD_CARD_TYPE_HS400)
+			mmc->card_caps |= MMC_MODE_HS400;
 		mmc->card_caps |= MMC_MODE_HS_52MHz | MMC_MODE_HS;
 	} else {
 		mmc->card_caps |= MMC_MODE_HS;
@@ -924,6 +985,8 @@ retry_scr:
 
 	if (mmc->scr[0] & SD_DATA_4BIT)
 		mmc->card_caps |= MMC_MODE_4BIT;
+	if (mmc->scr[0] & SD_SCR_CMD23_SUPPORT)
+		mmc->card_caps |= MMC_MODE_CMD23;
 
 	/* Version 1.0 doesn't support switching */
 	if (mmc->version == SD_VERSION_1_0)
@@ -1024,6 +1087,144 @@ static void mmc_set_bus_width(struct mmc *mmc, uint width)
 	mmc_set_ios(mmc);
 }
 
+static void mmc_set_timing(struct mmc *mmc, uint timing, uint clock)
+{
+	mmc->timing = timing;
+	mmc->tran_speed = clock;
+	mmc_set_clock(mmc, clock);
+}
+
+/* Check that the read-only fields of the EXT_CSD read back correctly */
+static bool mmc_ext_csd_matches(const u8 *ext_csd, const u8 *test_csd)
+{
+	return ext_csd[EXT_CSD_PARTITIONING_SUPPORT]
+			== test_csd[EXT_CSD_PARTITIONING_SUPPORT] &&
+		ext_csd[EXT_CSD_HC_WP_GRP_SIZE]
+			== test_csd[EXT_CSD_HC_WP_GRP_SIZE] &&
+		ext_csd[EXT_CSD_REV] == test_csd[EXT_CSD_REV] &&
+		ext_csd[EXT_CSD_HC_ERASE_GRP_SIZE]
+			== test_csd[EXT_CSD_HC_ERASE_GRP_SIZE] &&
+		memcmp(&ext_csd[EXT_CSD_SEC_CNT],
+		       &test_csd[EXT_CSD_SEC_CNT], 4) == 0;
+}
+
+static int mmc_execute_tuning(struct mmc *mmc)
+{
+	if (!mmc->cfg->ops->execute_tuning)
+		return 0;
+
+	return mmc->cfg->ops->execute_tuning(mmc,
+					     MMC_CMD_SEND_TUNING_BLOCK_HS200);
+}
+
+/*
+ * Switch an eMMC card which is in high-speed mode to HS200 on a 4- or 8-bit
+ * bus and tune the host. If this fails the card is put back into
+ * high-speed mode so that the other modes can be tried.
+ */
+static int mmc_select_hs200(struct mmc *mmc, const u8 *ext_csd)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(u8, test_csd, MMC_MAX_BLOCK_LEN);
+	uint width;
+	int err;
+
+	if (mmc->card_caps & MMC_MODE_8BIT)
+		width = 8;
+	else if (mmc->card_caps & MMC_MODE_4BIT)
+		width = 4;
+	else
+		return -EINVAL;
+
+	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_BUS_WIDTH,
+			 width == 8 ? EXT_CSD_BUS_WIDTH_8 :
+			 EXT_CSD_BUS_WIDTH_4);
+	if (err)
+		return err;
+	mmc_set_bus_width(mmc, width);
+
+	/* The card only answers reliably once the host has the new timing */
+	err = __mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING,
+			   EXT_CSD_TIMING_HS200, false);
+	if (err)
+		return err;
+	mmc_set_timing(mmc, MMC_TIMING_MMC_HS200, MMC_HS200_MAX_DTR);
+	err = mmc_send_status(mmc, 1000);
+	if (!err)
+		err = mmc_execute_tuning(mmc);
+	if (!err)
+		err = mmc_send_ext_csd(mmc, test_csd);
+	if (!err && !mmc_ext_csd_matches(ext_csd, test_csd))
+		err = SWITCH_ERR;
+	if (err) {
+		debug("%s: HS200 failed (err=%d)\n", __func__, err);
+		mmc_set_timing(mmc, MMC_TIMING_MMC_HS, 52000000);
+		mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING,
+			   EXT_CSD_TIMING_HS);
+		return err;
+	}
+
+	return 0;
+}
+
+/*
+ * Move a card from tuned HS200 to HS400. The card must go back to
+ * high-speed timing to select the 8-bit DDR bus, then on to HS400.
+ */
+static int mmc_select_hs400(struct mmc *mmc)
+{
+	int err;
+
+	mmc_set_timing(mmc, MMC_TIMING_MMC_HS, 52000000);
+	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING,
+			 EXT_CSD_TIMING_HS);
+	if (err)
+		return err;
+
+	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_BUS_WIDTH,
+			 EXT_CSD_DDR_BUS_WIDTH_8);
+	if (err)
+		return err;
+	mmc->ddr_mode = 1;
+
+	err = __mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING,
+			   EXT_CSD_TIMING_HS400, false);
+	if (err)
+		return err;
+	mmc_set_timing(mmc, MMC_TIMING_MMC_HS400, MMC_HS200_MAX_DTR);
+
+	return mmc_send_status(mmc, 1000);
+}
+
+/*
+ * Select HS200 and then HS400 if both sides support it. If HS400 fails the
+ * card is put back into HS200, which must be tuned again. On error the card
+ * is left in high-speed timing, ready to select an ordinary bus width.
+ */
+static int mmc_select_hs200_hs400(struct mmc *mmc, const u8 *ext_csd)
+{
+	int err;
+
+	err = mmc_select_hs200(mmc, ext_csd);
+	if (err)
+		return err;
+
+	/* HS400 is selected from HS200, once the host is tuned */
+	if ((mmc->card_caps & (MMC_MODE_HS400 | MMC_MODE_8BIT)) !=
+	    (MMC_MODE_HS400 | MMC_MODE_8BIT))
+		return 0;
+	err = mmc_select_hs400(mmc);
+	if (!err)
+		return 0;
+
+	debug("%s: HS400 failed (err=%d)\n", __func__, err);
+	mmc->ddr_mode = 0;
+	mmc_set_timing(mmc, MMC_TIMING_MMC_HS, 52000000);
+	mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING,
+		   EXT_CSD_TIMING_HS);
+
+	return mmc_select_hs200(mmc, ext_csd);
+}
+
 static int mmc_startup(struct mmc *mmc)
 {
 	int err, i;
@@ -1223,6 +1424,9 @@ static int mmc_startup(struct mmc *mmc)
 		case 7:
 			mmc->version = MMC_VERSION_5_0;
 			break;
+		case 8:
+			mmc->version = MMC_VERSION_5_1;
+			break;
 		}
 
 		/* The partition data may be non-zero but it is only
@@ -1366,10 +1570,15 @@ static int mmc_startup(struct mmc *mmc)
 			mmc_set_bus_width(mmc, 4);
 		}
 
-		if (mmc->card_caps & MMC_MODE_HS)
+		if (mmc->card_caps & MMC_MODE_HS) {
+			mmc->timing = MMC_TIMING_SD_HS;
 			mmc->tran_speed = 50000000;
-		else
+		} else {
 			mmc->tran_speed = 25000000;
+		}
+	} else if ((mmc->card_caps & MMC_MODE_HS200) &&
+		   !mmc_select_hs200_hs400(mmc, ext_csd)) {
+		/* The bus width and timing are set; otherwise use HS52 below */
 	} else if (mmc->version >= MMC_VERSION_4) {
 		/* Only version 4 of MMC supports wider bus widths */
 		int idx;
@@ -1436,16 +1645,7 @@ static int mmc_startup(struct mmc *mmc)
 				continue;
 
 			/* Only compare read only fields */
-			if (ext_csd[EXT_CSD_PARTITIONING_SUPPORT]
-				== test_csd[EXT_CSD_PARTITIONING_SUPPORT] &&
-			    ext_csd[EXT_CSD_HC_WP_GRP_SIZE]
-				== test_csd[EXT_CSD_HC_WP_GRP_SIZE] &&
-			    ext_csd[EXT_CSD_REV]
-				== test_csd[EXT_CSD_REV] &&
-			    ext_csd[EXT_CSD_HC_ERASE_GRP_SIZE]
-				== test_csd[EXT_CSD_HC_ERASE_GRP_SIZE] &&
-			    memcmp(&ext_csd[EXT_CSD_SEC_CNT],
-				   &test_csd[EXT_CSD_SEC_CNT], 4) == 0)
+			if (mmc_ext_csd_matches(ext_csd, test_csd))
 				break;
 			else
 				err = SWITCH_ERR;
@@ -1459,6 +1659,8 @@ static int mmc_startup(struct mmc *mmc)
 				mmc->tran_speed = 52000000;
 			else
 				mmc->tran_speed = 26000000;
+			mmc->timing = mmc->ddr_mode ? MMC_TIMING_MMC_DDR52 :
+				MMC_TIMING_MMC_HS;
 		}
 	}
 
@@ -1594,7 +1796,8 @@ __weak void board_mmc_power_init(void)
 {
 }
 
-int mmc_start_init(struct mmc *mmc)
+/* Start a card's init, with @quiet saying nothing if the slot is empty */
+static int __mmc_start_init(struct mmc *mmc, bool quiet)
 {
 	int err;
 
@@ -1602,7 +1805,8 @@ int mmc_start_init(struct mmc *mmc)
 	if (mmc_getcd(mmc) == 0 || mmc->cfg->ops->init == NULL) {
 		mmc->has_init = 0;
 #if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
-		printf("MMC: no card present\n");
+		if (!quiet)
+			printf("MMC: no card present\n");
 #endif
 		return NO_CARD_ERR;
 	}
@@ -1622,6 +1826,8 @@ int mmc_start_init(struct mmc *mmc)
 		return err;
 
 	mmc->ddr_mode = 0;
+	mmc->timing = MMC_TIMING_LEGACY;
+	mmc->blocklen = 0;
 	mmc_set_bus_width(mmc, 1);
 	mmc_set_clock(mmc, 1);
 
@@ -1658,14 +1864,23 @@ int mmc_start_init(struct mmc *mmc)
 	return err;
 }
 
-static int mmc_complete_init(struct mmc *mmc)
+int mmc_start_init(struct mmc *mmc)
+{
+	return __mmc_start_init(mmc, false);
+}
+
+/* Move a started init along, returning -EINPROGRESS if the card is busy */
+static int mmc_init_step(struct mmc *mmc)
 {
 	int err = 0;
 
-	mmc->init_in_progress = 0;
-	if (mmc->op_cond_pending)
-		err = mmc_complete_op_cond(mmc);
+	if (mmc->op_cond_pending) {
+		err = mmc_poll_op_cond(mmc);
+		if (err == -EINPROGRESS)
+			return err;
+	}
 
+	mmc->init_in_progress = 0;
 	if (!err)
 		err = mmc_startup(mmc);
 	if (err)
@@ -1675,6 +1890,17 @@ static int mmc_complete_init(struct mmc *mmc)
 	return err;
 }
 
+static int mmc_complete_init(struct mmc *mmc)
+{
+	int err;
+
+	/* Send ACMD41 to SD cards every 1ms and CMD1 to eMMC every 100us */
+	while ((err = mmc_init_step(mmc)) == -EINPROGRESS)
+		udelay(mmc->op_cond_pending == MMC_OP_COND_SD ? 1000 : 100);
+
+	return err;
+}
+
 int mmc_init(struct mmc *mmc)
 {
 	int err = 0;
@@ -1694,6 +1920,26 @@ int mmc_init(struct mmc *mmc)
 	return err;
 }
 
+int mmc_init_poll(void)
+{
+	struct mmc *m;
+	int pending = 0;
+	int err;
+
+	list_for_each_entry(m, &mmc_devices, link) {
+		if (!m->init_in_progress)
+			continue;
+		err = mmc_init_step(m);
+		if (err == -EINPROGRESS)
+			pending++;
+		else if (err)
+			debug("%s: %s: init failed: %d\n", __func__,
+			      m->cfg->name, err);
+	}
+
+	return pending;
+}
+
 int mmc_set_dsr(struct mmc *mmc, u16 val)
 {
 	mmc->dsr = val;
@@ -1764,11 +2010,12 @@ static void do_preinit(void)
 	list_for_each(entry, &mmc_devices) {
 		m = list_entry(entry, struct mmc, link);
 
-#ifdef CONFIG_FSL_ESDHC_ADAPTER_IDENT
+#if defined(CONFIG_FSL_ESDHC_ADAPTER_IDENT) || defined(CONFIG_MMC_ASYNC_INIT)
 		mmc_set_preinit(m, 1);
 #endif
+		/* Background starts say nothing about empty slots */
 		if (m->preinit)
-			mmc_start_init(m);
+			__mmc_start_init(m, IS_ENABLED(CONFIG_MMC_ASYNC_INIT));
 	}
 }
 
@@ -16,6 +16,18 @@ extern int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 			struct mmc_data *data);
 extern int mmc_send_status(struct mmc *mmc, int timeout);
 extern int mmc_set_blocklen(struct mmc *mmc, int len);
+int mmc_set_blockcount(struct mmc *mmc, unsigned int blockcount,
+		       bool is_rel_write);
+
+/* Largest number of blocks to transfer with one command */
+static inline lbaint_t mmc_max_blocks(struct mmc *mmc)
+{
+	/* SET_BLOCK_COUNT only has a 16-bit count */
+	if (mmc->card_caps & MMC_MODE_CMD23)
+		return min_t(lbaint_t, mmc->cfg->b_max, 0xffff);
+
+	return mmc->cfg->b_max;
+}
 #ifdef CONFIG_FSL_ESDHC_ADAPTER_IDENT
 void mmc_adapter_card_type_ident(void);
 #endif
@@ -0,0 +1,105 @@
+/*
+ * SDHCI ADMA2 descriptor tables
+ *
+ * With ADMA2 the controller reads a table of (address, length) descriptors
+ * and transfers a whole multi-block command without help, instead of
+ * stopping at each SDMA buffer boundary for software to restart it.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <sdhci.h>
+#include <linux/sizes.h>
+
+/* Largest transfer which the MMC core will ask for */
+#define ADMA_MAX_BYTES	(CONFIG_SYS_MMC_MAX_BLK_COUNT * MMC_MAX_BLOCK_LEN)
+
+void sdhci_adma_setup(struct sdhci_host *host, u32 caps)
+{
+	host->flags &= ~(SDHCI_USE_ADMA | SDHCI_USE_64BIT_DMA);
+	if (!(caps & SDHCI_CAN_DO_ADMA2) ||
+	    (host->quirks & SDHCI_QUIRK_BROKEN_ADMA))
+		return;
+
+	host->flags |= SDHCI_USE_ADMA;
+	host->adma_desc_len = SDHCI_ADMA_DESC_LEN_32;
+	if (sizeof(dma_addr_t) > 4 && (caps & SDHCI_CAN_64BIT) &&
+	    SDHCI_GET_VERSION(host) >= SDHCI_SPEC_300) {
+		host->flags |= SDHCI_USE_64BIT_DMA;
+		host->adma_desc_len = SDHCI_ADMA_DESC_LEN_64;
+	}
+}
+
+int sdhci_adma_init(struct sdhci_host *host)
+{
+	uint size;
+
+	if (host->adma_desc_table)
+		return 0;
+
+	/* Allow for one extra descriptor where a buffer crosses 128MB */
+	host->adma_entries = DIV_ROUND_UP(ADMA_MAX_BYTES, SDHCI_ADMA_MAX_LEN);
+	if (host->quirks & SDHCI_QUIRK_ADMA_128M_BOUNDARY)
+		host->adma_entries += DIV_ROUND_UP(ADMA_MAX_BYTES, SZ_128M);
+	size = ALIGN(host->adma_entries * host->adma_desc_len,
+		     ARCH_DMA_MINALIGN);
+	host->adma_desc_table = memalign(ARCH_DMA_MINALIGN, size);
+	if (!host->adma_desc_table)
+		return -ENOMEM;
+	debug("%s: %u descriptors of %u bytes\n", __func__, host->adma_entries,
+	      host->adma_desc_len);
+
+	return 0;
+}
+
+static void sdhci_adma_write_desc(struct sdhci_host *host, void *ptr,
+				  dma_addr_t addr, uint len, bool end)
+{
+	struct sdhci_adma_desc *desc = ptr;
+	uint attr = SDHCI_ADMA_VALID | SDHCI_ADMA_TRAN;
+
+	if (end)
+		attr |= SDHCI_ADMA_END;
+	desc->attr = cpu_to_le16(attr);
+	desc->len = cpu_to_le16(len);
+	desc->addr_lo = cpu_to_le32(lower_32_bits(addr));
+	if (host->flags & SDHCI_USE_64BIT_DMA)
+		desc->addr_hi = cpu_to_le32(upper_32_bits(addr));
+}
+
+int sdhci_adma_prepare(struct sdhci_host *host, dma_addr_t addr, uint len)
+{
+	void *desc = host->adma_desc_table;
+	uint count = 0;
+
+	if (!len || (addr & (SDHCI_ADMA_ALIGN - 1)))
+		return -EINVAL;
+	if (!(host->flags & SDHCI_USE_64BIT_DMA) &&
+	    upper_32_bits(addr + len - 1))
+		return -ERANGE;
+
+	while (len) {
+		uint size = min(len, (uint)SDHCI_ADMA_MAX_LEN);
+
+		if (host->quirks & SDHCI_QUIRK_ADMA_128M_BOUNDARY) {
+			dma_addr_t next = (addr | (SZ_128M - 1)) + 1;
+
+			if (next - addr < size)
+				size = next - addr;
+		}
+		if (count == host->adma_entries)
+			return -E2BIG;
+		len -= size;
+		sdhci_adma_write_desc(host, desc, addr, size, !len);
+		desc += host->adma_desc_len;
+		addr += size;
+		count++;
+	}
+	flush_cache((unsigned long)host->adma_desc_table,
+		    ALIGN(count * host->adma_desc_len, ARCH_DMA_MINALIGN));
+
+	return count;
+}
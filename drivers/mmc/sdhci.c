@@ -19,6 +19,9 @@ void *aligned_buffer = (void *)CONFIG_FIXED_SDHCI_ALIGNED_BUFFER;
 void *aligned_buffer;
 #endif
 
+/* Size of the SDMA bounce buffer, which limits the size of a transfer */
+#define SDHCI_BOUNCE_SIZE	(512 * 1024)
+
 static void sdhci_reset(struct sdhci_host *host, u8 mask)
 {
 	unsigned long timeout;
@@ -71,12 +74,6 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 				unsigned int start_addr)
 {
 	unsigned int stat, rdy, mask, timeout, block = 0;
-#ifdef CONFIG_MMC_SDMA
-	unsigned char ctrl;
-	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
-	ctrl &= ~SDHCI_CTRL_DMA_MASK;
-	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
-#endif
 
 	timeout = 1000000;
 	rdy = SDHCI_INT_SPACE_AVAIL | SDHCI_INT_DATA_AVAIL;
@@ -86,6 +83,11 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 		if (stat & SDHCI_INT_ERROR) {
 			printf("%s: Error detected in status(0x%X)!\n",
 			       __func__, stat);
+			if (stat & SDHCI_INT_ADMA_ERROR)
+				printf("%s: ADMA error 0x%x at 0x%x\n",
+				       __func__,
+				       sdhci_readb(host, SDHCI_ADMA_ERROR),
+				       sdhci_readl(host, SDHCI_ADMA_ADDRESS));
 			return -1;
 		}
 		if (stat & rdy) {
@@ -115,6 +117,85 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 	return 0;
 }
 
+#ifdef CONFIG_MMC_SDMA
+static unsigned int sdhci_start_sdma(struct sdhci_host *host,
+				     struct mmc_data *data, int trans_bytes,
+				     int *is_alignedp)
+{
+	unsigned int start_addr;
+	unsigned char ctrl;
+
+	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+	ctrl &= ~SDHCI_CTRL_DMA_MASK;
+	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+
+	if (data->flags == MMC_DATA_READ)
+		start_addr = (unsigned long)data->dest;
+	else
+		start_addr = (unsigned long)data->src;
+	if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
+			(start_addr & 0x7) != 0x0) {
+		*is_alignedp = 0;
+		start_addr = (unsigned long)aligned_buffer;
+		if (data->flags != MMC_DATA_READ)
+			memcpy(aligned_buffer, data->src, trans_bytes);
+	}
+
+#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
+	/*
+	 * Always use this bounce-buffer when
+	 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
+	 */
+	*is_alignedp = 0;
+	start_addr = (unsigned long)aligned_buffer;
+	if (data->flags != MMC_DATA_READ)
+		memcpy(aligned_buffer, data->src, trans_bytes);
+#endif
+
+	sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
+	flush_cache(start_addr, trans_bytes);
+
+	return start_addr;
+}
+#endif
+
+#ifdef CONFIG_MMC_SDHCI_ADMA
+/*
+ * Set up an ADMA2 transfer straight to or from the caller's buffer. This
+ * fails if the buffer cannot be used for ADMA (e.g. it is not aligned), in
+ * which case the transfer is done by PIO instead of through a bounce buffer.
+ */
+static int sdhci_start_adma(struct sdhci_host *host, struct mmc_data *data,
+			    int trans_bytes)
+{
+	dma_addr_t table = (unsigned long)host->adma_desc_table;
+	unsigned long addr = (unsigned long)data->dest;
+	unsigned char ctrl;
+	int ret;
+
+	ret = sdhci_adma_prepare(host, addr, trans_bytes);
+	if (ret < 0) {
+		debug("%s: Using PIO for %p (err=%d)\n", __func__, data->dest,
+		      ret);
+		return ret;
+	}
+	flush_cache(addr, trans_bytes);
+
+	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+	ctrl &= ~SDHCI_CTRL_DMA_MASK;
+	sdhci_writel(host, lower_32_bits(table), SDHCI_ADMA_ADDRESS);
+	if (host->flags & SDHCI_USE_64BIT_DMA) {
+		sdhci_writel(host, upper_32_bits(table), SDHCI_ADMA_ADDRESS_HI);
+		ctrl |= SDHCI_CTRL_ADMA64;
+	} else {
+		ctrl |= SDHCI_CTRL_ADMA32;
+	}
+	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+
+	return 0;
+}
+#endif
+
 /*
  * No command will be sent by driver if card is busy, so driver must wait
  * for card ready state.
@@ -196,32 +277,17 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		if (data->flags == MMC_DATA_READ)
 			mode |= SDHCI_TRNS_READ;
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+		if ((host->flags & SDHCI_USE_ADMA) &&
+		    !sdhci_start_adma(host, data, trans_bytes))
+			mode |= SDHCI_TRNS_DMA;
+#endif
 #ifdef CONFIG_MMC_SDMA
-		if (data->flags == MMC_DATA_READ)
-			start_addr = (unsigned long)data->dest;
-		else
-			start_addr = (unsigned long)data->src;
-		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				(start_addr & 0x7) != 0x0) {
-			is_aligned = 0;
-			start_addr = (unsigned long)aligned_buffer;
-			if (data->flags != MMC_DATA_READ)
-				memcpy(aligned_buffer, data->src, trans_bytes);
+		if (!(host->flags & SDHCI_USE_ADMA)) {
+			start_addr = sdhci_start_sdma(host, data, trans_bytes,
+						      &is_aligned);
+			mode |= SDHCI_TRNS_DMA;
 		}
-
-#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
-		/*
-		 * Always use this bounce-buffer when
-		 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
-		 */
-		is_aligned = 0;
-		start_addr = (unsigned long)aligned_buffer;
-		if (data->flags != MMC_DATA_READ)
-			memcpy(aligned_buffer, data->src, trans_bytes);
-#endif
-
-		sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
-		mode |= SDHCI_TRNS_DMA;
 #endif
 		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 				data->blocksize),
@@ -233,9 +299,6 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	}
 
 	sdhci_writel(host, cmd->cmdarg, SDHCI_ARGUMENT);
-#ifdef CONFIG_MMC_SDMA
-	flush_cache(start_addr, trans_bytes);
-#endif
 	sdhci_writew(host, SDHCI_MAKE_CMD(cmd->cmdidx, flags), SDHCI_COMMAND);
 	start = get_timer(0);
 	do {
@@ -355,6 +418,59 @@ static int sdhci_set_clock(struct mmc *mmc, unsigned int clock)
 	return 0;
 }
 
+static int sdhci_execute_tuning(struct mmc *mmc, uint opcode)
+{
+	struct sdhci_host *host = mmc->priv;
+	u32 flags = SDHCI_CMD_RESP_SHORT | SDHCI_CMD_CRC | SDHCI_CMD_INDEX |
+		SDHCI_CMD_DATA;
+	unsigned int stat;
+	unsigned long start;
+	u16 ctrl;
+	int i;
+
+	if (SDHCI_GET_VERSION(host) < SDHCI_SPEC_300)
+		return 0;
+
+	ctrl = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+	ctrl |= SDHCI_CTRL_EXEC_TUNING;
+	sdhci_writew(host, ctrl, SDHCI_HOST_CONTROL2);
+
+	/*
+	 * The controller checks each tuning block itself and moves its
+	 * sampling point, then clears EXEC_TUNING when it has finished.
+	 */
+	for (i = 0; i < SDHCI_TUNING_LOOP_COUNT; i++) {
+		sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
+				mmc->bus_width == 8 ? 128 : 64),
+				SDHCI_BLOCK_SIZE);
+		sdhci_writew(host, SDHCI_TRNS_READ, SDHCI_TRANSFER_MODE);
+		sdhci_writel(host, 0, SDHCI_ARGUMENT);
+		sdhci_writew(host, SDHCI_MAKE_CMD(opcode, flags), SDHCI_COMMAND);
+		start = get_timer(0);
+		do {
+			stat = sdhci_readl(host, SDHCI_INT_STATUS);
+		} while (!(stat & SDHCI_INT_DATA_AVAIL) &&
+			 get_timer(start) < CONFIG_SDHCI_CMD_DEFAULT_TIMEOUT);
+
+		ctrl = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+		if (!(ctrl & SDHCI_CTRL_EXEC_TUNING))
+			break;
+	}
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+
+	if (!(ctrl & SDHCI_CTRL_TUNED_CLK) || (ctrl & SDHCI_CTRL_EXEC_TUNING)) {
+		printf("%s: Tuning failed after %d blocks\n", __func__, i);
+		ctrl &= ~(SDHCI_CTRL_TUNED_CLK | SDHCI_CTRL_EXEC_TUNING);
+		sdhci_writew(host, ctrl, SDHCI_HOST_CONTROL2);
+		sdhci_reset(host, SDHCI_RESET_CMD);
+		sdhci_reset(host, SDHCI_RESET_DATA);
+		return (ctrl & SDHCI_CTRL_EXEC_TUNING) ? TIMEOUT : COMM_ERR;
+	}
+
+	return 0;
+}
+
 static void sdhci_set_power(struct sdhci_host *host, unsigned short power)
 {
 	u8 pwr = 0;
@@ -396,6 +512,18 @@ static void sdhci_set_ios(struct mmc *mmc)
 	if (host->set_control_reg)
 		host->set_control_reg(host);
 
+	/* HS200 and HS400 need the UHS mode set in host control 2 */
+	if (SDHCI_GET_VERSION(host) >= SDHCI_SPEC_300) {
+		u16 ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+
+		ctrl2 &= ~SDHCI_CTRL_UHS_MASK;
+		if (mmc->timing == MMC_TIMING_MMC_HS200)
+			ctrl2 |= SDHCI_CTRL_UHS_SDR104;
+		else if (mmc->timing == MMC_TIMING_MMC_HS400)
+			ctrl2 |= SDHCI_CTRL_HS400;
+		sdhci_writew(host, ctrl2, SDHCI_HOST_CONTROL2);
+	}
+
 	if (mmc->clock != host->clock)
 		sdhci_set_clock(mmc, mmc->clock);
 
@@ -427,12 +555,27 @@ static void sdhci_set_ios(struct mmc *mmc)
 	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
 }
 
+static void sdhci_set_b_max(struct sdhci_host *host)
+{
+	host->cfg.b_max = CONFIG_SYS_MMC_MAX_BLK_COUNT;
+#ifdef CONFIG_MMC_SDMA
+	/* Transfers which go through the bounce buffer must fit in it */
+	if (!(host->flags & SDHCI_USE_ADMA)) {
+#ifndef CONFIG_FIXED_SDHCI_ALIGNED_BUFFER
+		if (host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR)
+#endif
+			host->cfg.b_max = min_t(uint, host->cfg.b_max,
+					      SDHCI_BOUNCE_SIZE / MMC_MAX_BLOCK_LEN);
+	}
+#endif
+}
+
 static int sdhci_init(struct mmc *mmc)
 {
 	struct sdhci_host *host = mmc->priv;
 
 	if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) && !aligned_buffer) {
-		aligned_buffer = memalign(8, 512*1024);
+		aligned_buffer = memalign(8, SDHCI_BOUNCE_SIZE);
 		if (!aligned_buffer) {
 			printf("%s: Aligned buffer alloc failed!!!\n",
 			       __func__);
@@ -440,6 +583,16 @@ static int sdhci_init(struct mmc *mmc)
 		}
 	}
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/* Without a descriptor table, fall back to SDMA or PIO */
+	if ((host->flags & SDHCI_USE_ADMA) && sdhci_adma_init(host)) {
+		printf("%s: ADMA descriptor table alloc failed, not using ADMA\n",
+		       __func__);
+		host->flags &= ~(SDHCI_USE_ADMA | SDHCI_USE_64BIT_DMA);
+		sdhci_set_b_max(host);
+	}
+#endif
+
 	sdhci_set_power(host, fls(mmc->cfg->voltages) - 1);
 
 	if (host->quirks & SDHCI_QUIRK_NO_CD) {
@@ -476,6 +629,7 @@ static const struct mmc_ops sdhci_ops = {
 	.send_cmd	= sdhci_send_command,
 	.set_ios	= sdhci_set_ios,
 	.init		= sdhci_init,
+	.execute_tuning	= sdhci_execute_tuning,
 };
 
 int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
@@ -493,6 +647,9 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 		return -1;
 	}
 #endif
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	sdhci_adma_setup(host, caps);
+#endif
 
 	if (max_clk)
 		host->cfg.f_max = max_clk;
@@ -533,6 +690,8 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 		host->cfg.voltages |= host->voltages;
 
 	host->cfg.host_caps = MMC_MODE_HS | MMC_MODE_HS_52MHz | MMC_MODE_4BIT;
+	if (!(host->quirks & SDHCI_QUIRK_BROKEN_CMD23))
+		host->cfg.host_caps |= MMC_MODE_CMD23;
 	if (SDHCI_GET_VERSION(host) >= SDHCI_SPEC_300) {
 		if (caps & SDHCI_CAN_DO_8BIT)
 			host->cfg.host_caps |= MMC_MODE_8BIT;
@@ -544,7 +703,7 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 	if (host->host_caps)
 		host->cfg.host_caps |= host->host_caps;
 
-	host->cfg.b_max = CONFIG_SYS_MMC_MAX_BLK_COUNT;
+	sdhci_set_b_max(host);
 
 	sdhci_reset(host, SDHCI_RESET_ALL);
 
@@ -56,7 +56,7 @@ static const char *sandbox_sf_state_name(enum sandbox_sf_state state)
 #define STAT_WIP	(1 << 0)
 #define STAT_WEL	(1 << 1)
 
-/* Assume all SPI flashes have 3 byte addresses since they do atm */
+/* Commands have 3 byte addresses unless they are a 4-byte variant */
 #define SF_ADDR_LEN	3
 
 #define IDCODE_LEN 3
@@ -83,8 +83,8 @@ struct sandbox_spi_flash {
 	uint erase_size;
 	/* Current position in the flash; used when reading/writing/etc... */
 	uint off;
-	/* How many address bytes we've consumed */
-	uint addr_bytes, pad_addr_bytes;
+	/* How many address bytes we've consumed, and expect */
+	uint addr_bytes, pad_addr_bytes, addr_len;
 	/* The current flash status (see STAT_XXX defines above) */
 	u16 status;
 	/* Data describing the flash we're emulating */
@@ -222,6 +222,7 @@ static void sandbox_sf_cs_activate(struct udevice *dev)
 	sbsf->off = 0;
 	sbsf->addr_bytes = 0;
 	sbsf->pad_addr_bytes = 0;
+	sbsf->addr_len = SF_ADDR_LEN;
 	sbsf->state = SF_CMD;
 	sbsf->cmd = SF_CMD;
 }
@@ -244,6 +245,27 @@ static void sandbox_spi_tristate(u8 *buf, uint len)
 	memset(buf, 0xff, len);
 }
 
+/* Map a 4-byte address command to its 3-byte form, or return 0 if not one */
+static uint sandbox_sf_cmd_3b(uint cmd)
+{
+	switch (cmd) {
+	case CMD_READ_ARRAY_SLOW_4B:
+		return CMD_READ_ARRAY_SLOW;
+	case CMD_READ_ARRAY_FAST_4B:
+		return CMD_READ_ARRAY_FAST;
+	case CMD_PAGE_PROGRAM_4B:
+		return CMD_PAGE_PROGRAM;
+	case CMD_ERASE_4K_4B:
+		return CMD_ERASE_4K;
+	case CMD_ERASE_32K_4B:
+		return CMD_ERASE_32K;
+	case CMD_ERASE_64K_4B:
+		return CMD_ERASE_64K;
+	default:
+		return 0;
+	}
+}
+
 /* Figure out what command this stream is telling us to do */
 static int sandbox_sf_process_cmd(struct sandbox_spi_flash *sbsf, const u8 *rx,
 				  u8 *tx)
@@ -254,7 +276,11 @@ static int sandbox_sf_process_cmd(struct sandbox_spi_flash *sbsf, const u8 *rx,
 	if (tx)
 		sandbox_spi_tristate(tx, 1);
 
-	sbsf->cmd = rx[0];
+	sbsf->cmd = sandbox_sf_cmd_3b(rx[0]);
+	if (sbsf->cmd && (sbsf->data->flags & ADDR_4B))
+		sbsf->addr_len = 4;
+	else
+		sbsf->cmd = rx[0];
 	switch (sbsf->cmd) {
 	case CMD_READ_ID:
 		sbsf->state = SF_ID;
@@ -376,7 +402,7 @@ static int sandbox_sf_xfer(struct udevice *dev, unsigned int bitlen,
 			debug(" addr: bytes:%u rx:%02x ", sbsf->addr_bytes,
 			      rx[pos]);
 
-			if (sbsf->addr_bytes++ < SF_ADDR_LEN)
+			if (sbsf->addr_bytes++ < sbsf->addr_len)
 				sbsf->off = (sbsf->off << 8) | rx[pos];
 			debug("addr:%06x\n", sbsf->off);
 
@@ -386,7 +412,7 @@ static int sandbox_sf_xfer(struct udevice *dev, unsigned int bitlen,
 
 			/* See if we're done processing */
 			if (sbsf->addr_bytes <
-					SF_ADDR_LEN + sbsf->pad_addr_bytes)
+					sbsf->addr_len + sbsf->pad_addr_bytes)
 				break;
 
 			/* Next state! */
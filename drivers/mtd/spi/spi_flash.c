@@ -22,12 +22,15 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-static void spi_flash_addr(u32 addr, u8 *cmd)
+static void spi_flash_addr(struct spi_flash *flash, u32 addr, u8 *cmd)
 {
-	/* cmd[0] is actual command */
-	cmd[1] = addr >> 16;
-	cmd[2] = addr >> 8;
-	cmd[3] = addr >> 0;
+	int i;
+
+	/* cmd[0] is actual command, then the address MSB first */
+	for (i = flash->addr_width; i > 0; i--) {
+		cmd[i] = addr;
+		addr >>= 8;
+	}
 }
 
 static int read_sr(struct spi_flash *flash, u8 *rs)
@@ -149,6 +152,10 @@ static int spi_flash_write_bar(struct spi_flash *flash, u32 offset)
 	u8 cmd, bank_sel;
 	int ret;
 
+	/* 4-byte addresses reach the whole flash without banks */
+	if (flash->addr_width == SPI_FLASH_4B_ADDR_LEN)
+		return 0;
+
 	bank_sel = offset / (SPI_FLASH_16MB_BOUN << flash->shift);
 	if (bank_sel == flash->bank_curr)
 		goto bar_end;
@@ -170,7 +177,8 @@ static int spi_flash_read_bar(struct spi_flash *flash, u8 idcode0)
 	u8 curr_bank = 0;
 	int ret;
 
-	if (flash->size <= SPI_FLASH_16MB_BOUN)
+	if (flash->size <= SPI_FLASH_16MB_BOUN ||
+	    flash->addr_width == SPI_FLASH_4B_ADDR_LEN)
 		goto bar_end;
 
 	switch (idcode0) {
@@ -326,7 +334,7 @@ int spi_flash_write_common(struct spi_flash *flash, const u8 *cmd,
 int spi_flash_cmd_erase_ops(struct spi_flash *flash, u32 offset, size_t len)
 {
 	u32 erase_size, erase_addr;
-	u8 cmd[SPI_FLASH_CMD_LEN];
+	u8 cmd[SPI_FLASH_MAX_CMD_LEN];
 	int ret = -1;
 
 	erase_size = flash->erase_size;
@@ -356,12 +364,12 @@ int spi_flash_cmd_erase_ops(struct spi_flash *flash, u32 offset, size_t len)
 		if (ret < 0)
 			return ret;
 #endif
-		spi_flash_addr(erase_addr, cmd);
+		spi_flash_addr(flash, erase_addr, cmd);
 
-		debug("SF: erase %2x %2x %2x %2x (%x)\n", cmd[0], cmd[1],
-		      cmd[2], cmd[3], erase_addr);
+		debug("SF: erase %2x (%x)\n", cmd[0], erase_addr);
 
-		ret = spi_flash_write_common(flash, cmd, sizeof(cmd), NULL, 0);
+		ret = spi_flash_write_common(flash, cmd, 1 + flash->addr_width,
+					     NULL, 0);
 		if (ret < 0) {
 			debug("SF: erase failed\n");
 			break;
@@ -381,7 +389,7 @@ int spi_flash_cmd_write_ops(struct spi_flash *flash, u32 offset,
 	unsigned long byte_addr, page_size;
 	u32 write_addr;
 	size_t chunk_len, actual;
-	u8 cmd[SPI_FLASH_CMD_LEN];
+	u8 cmd[SPI_FLASH_MAX_CMD_LEN];
 	int ret = -1;
 
 	page_size = flash->page_size;
@@ -414,12 +422,12 @@ int spi_flash_cmd_write_ops(struct spi_flash *flash, u32 offset,
 			chunk_len = min(chunk_len,
 					(size_t)spi->max_write_size);
 
-		spi_flash_addr(write_addr, cmd);
+		spi_flash_addr(flash, write_addr, cmd);
 
-		debug("SF: 0x%p => cmd = { 0x%02x 0x%02x%02x%02x } chunk_len = %zu\n",
-		      buf + actual, cmd[0], cmd[1], cmd[2], cmd[3], chunk_len);
+		debug("SF: 0x%p => cmd = { 0x%02x 0x%x } chunk_len = %zu\n",
+		      buf + actual, cmd[0], write_addr, chunk_len);
 
-		ret = spi_flash_write_common(flash, cmd, sizeof(cmd),
+		ret = spi_flash_write_common(flash, cmd, 1 + flash->addr_width,
 					buf + actual, chunk_len);
 		if (ret < 0) {
 			debug("SF: write failed\n");
@@ -468,6 +476,36 @@ void __weak spi_flash_copy_mmap(void *data, void *offset, size_t len)
 	memcpy(data, offset, len);
 }
 
+#ifdef CONFIG_DM_SPI
+/* Have the SPI controller do the whole read, e.g. with DMA */
+static int spi_flash_read_direct(struct spi_flash *flash, u32 offset,
+				 size_t len, void *data)
+{
+	struct spi_slave *spi = flash->spi;
+	struct spi_flash_read_message msg = {
+		.buf		= data,
+		.from		= offset,
+		.len		= len,
+		.read_opcode	= flash->read_cmd,
+		.addr_width	= flash->addr_width,
+		.dummy_bytes	= flash->dummy_byte,
+	};
+	int ret;
+
+	ret = spi_claim_bus(spi);
+	if (ret) {
+		debug("SF: unable to claim SPI bus\n");
+		return ret;
+	}
+	ret = spi_flash_read_msg(spi, &msg);
+	if (ret)
+		debug("SF: direct read failed\n");
+	spi_release_bus(spi);
+
+	return ret;
+}
+#endif
+
 int spi_flash_cmd_read_ops(struct spi_flash *flash, u32 offset,
 		size_t len, void *data)
 {
@@ -477,8 +515,13 @@ int spi_flash_cmd_read_ops(struct spi_flash *flash, u32 offset,
 	int bank_sel = 0;
 	int ret = -1;
 
+#ifdef CONFIG_DM_SPI
+	if (flash->read_mode == SF_READ_DIRECT)
+		return spi_flash_read_direct(flash, offset, len, data);
+#endif
+
 	/* Handle memory-mapped SPI */
-	if (flash->memory_map) {
+	if (flash->read_mode == SF_READ_MMAP) {
 		ret = spi_claim_bus(spi);
 		if (ret) {
 			debug("SF: unable to claim SPI bus\n");
@@ -491,7 +534,7 @@ int spi_flash_cmd_read_ops(struct spi_flash *flash, u32 offset,
 		return 0;
 	}
 
-	cmdsz = SPI_FLASH_CMD_LEN + flash->dummy_byte;
+	cmdsz = 1 + flash->addr_width + flash->dummy_byte;
 	cmd = calloc(1, cmdsz);
 	if (!cmd) {
 		debug("SF: Failed to allocate cmd\n");
@@ -514,12 +557,13 @@ int spi_flash_cmd_read_ops(struct spi_flash *flash, u32 offset,
 #endif
 		remain_len = ((SPI_FLASH_16MB_BOUN << flash->shift) *
 				(bank_sel + 1)) - offset;
-		if (len < remain_len)
+		if (len < remain_len ||
+		    flash->addr_width == SPI_FLASH_4B_ADDR_LEN)
 			read_len = len;
 		else
 			read_len = remain_len;
 
-		spi_flash_addr(read_addr, cmd);
+		spi_flash_addr(flash, read_addr, cmd);
 
 		ret = spi_flash_read_common(flash, cmd, cmdsz, data, read_len);
 		if (ret < 0) {
@@ -945,6 +989,77 @@ static int set_quad_mode(struct spi_flash *flash, u8 idcode0)
 	}
 }
 
+#ifdef CONFIG_SPI_FLASH_4BYTE_ADDR
+/* Switch the read, write and erase commands to their 4-byte address forms */
+static void spi_flash_set_4byte(struct spi_flash *flash)
+{
+	switch (flash->read_cmd) {
+	case CMD_READ_ARRAY_SLOW:
+		flash->read_cmd = CMD_READ_ARRAY_SLOW_4B;
+		break;
+	case CMD_READ_DUAL_OUTPUT_FAST:
+		flash->read_cmd = CMD_READ_DUAL_OUTPUT_FAST_4B;
+		break;
+	case CMD_READ_DUAL_IO_FAST:
+		flash->read_cmd = CMD_READ_DUAL_IO_FAST_4B;
+		break;
+	case CMD_READ_QUAD_OUTPUT_FAST:
+		flash->read_cmd = CMD_READ_QUAD_OUTPUT_FAST_4B;
+		break;
+	case CMD_READ_QUAD_IO_FAST:
+		flash->read_cmd = CMD_READ_QUAD_IO_FAST_4B;
+		break;
+	default:
+		flash->read_cmd = CMD_READ_ARRAY_FAST_4B;
+	}
+
+	/* The 4-byte quad page program opcode differs between vendors */
+	flash->write_cmd = CMD_PAGE_PROGRAM_4B;
+
+	switch (flash->erase_cmd) {
+	case CMD_ERASE_4K:
+		flash->erase_cmd = CMD_ERASE_4K_4B;
+		break;
+	case CMD_ERASE_32K:
+		flash->erase_cmd = CMD_ERASE_32K_4B;
+		break;
+	default:
+		flash->erase_cmd = CMD_ERASE_64K_4B;
+	}
+	flash->addr_width = SPI_FLASH_4B_ADDR_LEN;
+}
+#endif
+
+/* Work out which ways of reading the flash are available */
+static void spi_flash_set_read_modes(struct spi_flash *flash)
+{
+#ifdef CONFIG_DM_SPI
+	ulong map_base;
+	uint map_size;
+#endif
+
+	flash->read_modes = BIT(SF_READ_XFER);
+#ifdef CONFIG_DM_SPI
+	/* Use the controller's memory-mapped window if it covers the flash */
+	if (!flash->memory_map &&
+	    !spi_get_mmap(flash->spi, &map_base, &map_size) &&
+	    map_size >= flash->size)
+		flash->memory_map = map_sysmem(map_base, flash->size);
+
+	/* Direct reads are single transfers, so cannot switch banks */
+	if (spi_has_flash_read(flash->spi) &&
+	    flash->dual_flash == SF_SINGLE_FLASH &&
+	    (flash->addr_width == SPI_FLASH_4B_ADDR_LEN ||
+	     flash->size <= SPI_FLASH_16MB_BOUN))
+		flash->read_modes |= BIT(SF_READ_DIRECT);
+#endif
+	if (flash->memory_map)
+		flash->read_modes |= BIT(SF_READ_MMAP);
+
+	/* Prefer memory-mapped reads, then direct reads */
+	flash->read_mode = fls(flash->read_modes) - 1;
+}
+
 #if CONFIG_IS_ENABLED(OF_CONTROL)
 int spi_flash_decode_fdt(const void *blob, struct spi_flash *flash)
 {
@@ -1150,6 +1265,14 @@ int spi_flash_scan(struct spi_flash *flash)
 		flash->dummy_byte = 1;
 	}
 
+	flash->addr_width = SPI_FLASH_3B_ADDR_LEN;
+#ifdef CONFIG_SPI_FLASH_4BYTE_ADDR
+	/* Use 4-byte addresses where the flash supports them */
+	if (flash->dual_flash == SF_SINGLE_FLASH &&
+	    flash->size > SPI_FLASH_16MB_BOUN && (params->flags & ADDR_4B))
+		spi_flash_set_4byte(flash);
+#endif
+
 #ifdef CONFIG_SPI_FLASH_STMICRO
 	if (params->flags & E_FSR)
 		flash->flags |= SNOR_F_USE_FSR;
@@ -1169,6 +1292,7 @@ int spi_flash_scan(struct spi_flash *flash)
 		return -EINVAL;
 	}
 #endif
+	spi_flash_set_read_modes(flash);
 
 #ifndef CONFIG_SPL_BUILD
 	printf("SF: Detected %s with page size ", flash->name);
@@ -1181,10 +1305,11 @@ int spi_flash_scan(struct spi_flash *flash)
 #endif
 
 #ifndef CONFIG_SPI_FLASH_BAR
-	if (((flash->dual_flash == SF_SINGLE_FLASH) &&
+	if (flash->addr_width != SPI_FLASH_4B_ADDR_LEN &&
+	    (((flash->dual_flash == SF_SINGLE_FLASH) &&
 	     (flash->size > SPI_FLASH_16MB_BOUN)) ||
 	     ((flash->dual_flash > SF_SINGLE_FLASH) &&
-	     (flash->size > SPI_FLASH_16MB_BOUN << 1))) {
+	     (flash->size > SPI_FLASH_16MB_BOUN << 1)))) {
 		puts("SF: Warning - Only lower 16MiB accessible,");
 		puts(" Full access #define CONFIG_SPI_FLASH_BAR\n");
 	}
@@ -11,27 +11,113 @@
 #include <dm.h>
 #include <malloc.h>
 #include <net.h>
+#include <asm/eth.h>
 #include <asm/test.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Number of packets which can be queued for reception */
+#define SB_ETH_RECV_QUEUE	64
+
+/* TFTP opcodes and the port the mock server answers from */
+#define SB_TFTP_RRQ		1
+#define SB_TFTP_DATA		3
+#define SB_TFTP_ACK		4
+#define SB_TFTP_ERROR		5
+#define SB_TFTP_OACK		6
+#define SB_TFTP_SERVER_PORT	69
+#define SB_TFTP_DATA_PORT	1069
+#define SB_TFTP_MAX_BLKSIZE	1468
+
+/* Largest IP payload which fits in an Ethernet frame, a multiple of 8 */
+#define SB_ETH_IP_FRAG		1480
+
+/* Smallest Ethernet frame, without the FCS */
+#define SB_ETH_MIN_FRAME	60
+
+/* RPC programs and ports of the mock NFS server */
+#define SB_RPC_PORTMAP		100000
+#define SB_RPC_NFS		100003
+#define SB_RPC_MOUNT		100005
+#define SB_RPC_PORTMAP_PORT	111
+#define SB_RPC_MOUNT_PORT	635
+#define SB_RPC_NFS_PORT		2049
+#define SB_RPC_PROG_MISMATCH	2
+#define SB_NFS_MAX_READ		8192
+#define SB_NFS3_FHSIZE		20
+#define SB_NFSERR_STALE		70
+#define SB_NFS3ERR_BADHANDLE	10001
+
+/**
+ * struct sb_tftp_server - state of the mock TFTP server
+ *
+ * client_port: UDP port of the client, 0 if no transfer is active
+ * blksize: negotiated block size
+ * windowsize: negotiated window size
+ * last_block: number of the last block of the file
+ */
+struct sb_tftp_server {
+	int client_port;
+	int blksize;
+	int windowsize;
+	ulong last_block;
+};
+
 /**
  * struct eth_sandbox_priv - memory for sandbox mock driver
  *
  * fake_host_hwaddr: MAC address of mocked machine
  * fake_host_ipaddr: IP address of mocked machine
- * recv_packet_buffer: buffer of the packet returned as received
- * recv_packet_length: length of the packet returned as received
+ * recv_packets: queue of packets to be returned as received
+ * recv_packet_length: length of each queued packet
+ * recv_nfs_read: true for a packet which completes an NFS READ reply
+ * recv_head: index of the next packet to return
+ * recv_count: number of packets queued
+ * rx_dest: where to place received data, NULL for the packet buffer
+ * rx_offset: offset in the packet of the data to place
+ * rx_len: largest amount of data to place
+ * tftp: mock TFTP server
  */
 struct eth_sandbox_priv {
 	uchar fake_host_hwaddr[ARP_HLEN];
 	struct in_addr fake_host_ipaddr;
-	uchar *recv_packet_buffer;
-	int recv_packet_length;
+	uchar *recv_packets;
+	int recv_packet_length[SB_ETH_RECV_QUEUE];
+	bool recv_nfs_read[SB_ETH_RECV_QUEUE];
+	int recv_head;
+	int recv_count;
+	void *rx_dest;
+	int rx_offset;
+	int rx_len;
+	struct sb_tftp_server tftp;
 };
 
 static bool disabled[8] = {false};
 static bool skip_timeout;
+static bool rx_dest_disabled;
+static ulong rx_placed;
+
+/* The file served by the mock TFTP server, for every file name */
+static const uchar *tftp_file;
+static ulong tftp_file_size;
+static int tftp_max_windowsize;
+static ulong tftp_drop_block;
+static bool tftp_send_arp;
+static struct sandbox_eth_tftp_stats tftp_stats;
+
+/* The file served by the mock NFS server, for every path */
+static const uchar *nfs_file;
+static ulong nfs_file_size;
+static int nfs_max_version;
+static bool nfs_reorder;
+static struct sandbox_eth_nfs_stats nfs_stats;
+static ulong nfs_in_flight;
+
+/* A READ reply held back to send after the next one */
+static uint32_t nfs_held[(SB_NFS_MAX_READ + 512) / 4];
+static int nfs_held_len;
+static struct ethernet_hdr nfs_held_eth;
+static struct ip_udp_hdr nfs_held_ip;
 
 /*
  * sandbox_eth_disable_response()
@@ -54,6 +140,582 @@ void sandbox_eth_skip_timeout(void)
 	skip_timeout = true;
 }
 
+/*
+ * sandbox_eth_disable_rx_dest()
+ *
+ * disable - true to receive everything into the packet buffer, as if
+ *	the hardware could not place data elsewhere
+ */
+void sandbox_eth_disable_rx_dest(bool disable)
+{
+	rx_dest_disabled = disable;
+}
+
+/*
+ * sandbox_eth_get_rx_placed()
+ *
+ * Return the number of packets placed at the rx_dest, and reset the count
+ */
+ulong sandbox_eth_get_rx_placed(void)
+{
+	ulong count = rx_placed;
+
+	rx_placed = 0;
+
+	return count;
+}
+
+/*
+ * sandbox_eth_tftp_set_file()
+ *
+ * data - Contents of the file to serve over TFTP, NULL to stop serving
+ * size - Size of the file in bytes
+ * max_windowsize - Largest RFC 7440 window the server agrees to, 1 to
+ *	refuse the option
+ * drop_block - Block number to drop the first time it is sent, 0 for none
+ */
+void sandbox_eth_tftp_set_file(const void *data, ulong size,
+			       int max_windowsize, ulong drop_block)
+{
+	tftp_file = data;
+	tftp_file_size = size;
+	tftp_max_windowsize = min(max_windowsize, SB_ETH_RECV_QUEUE / 2);
+	tftp_drop_block = drop_block;
+	memset(&tftp_stats, '\0', sizeof(tftp_stats));
+}
+
+/*
+ * sandbox_eth_tftp_send_arp()
+ *
+ * send - true to follow the last block of the file with an ARP request,
+ *	padded to the smallest Ethernet frame, as other hosts may send
+ */
+void sandbox_eth_tftp_send_arp(bool send)
+{
+	tftp_send_arp = send;
+}
+
+/*
+ * sandbox_eth_tftp_get_stats()
+ *
+ * Get the number of packets handled by the mock TFTP server since
+ * sandbox_eth_tftp_set_file() was called
+ */
+void sandbox_eth_tftp_get_stats(struct sandbox_eth_tftp_stats *stats)
+{
+	*stats = tftp_stats;
+}
+
+/* Get the buffer for the next packet to be received, NULL if full */
+static uchar *sb_eth_recv_slot(struct eth_sandbox_priv *priv)
+{
+	int slot;
+
+	if (priv->recv_count == SB_ETH_RECV_QUEUE)
+		return NULL;
+	slot = (priv->recv_head + priv->recv_count) % SB_ETH_RECV_QUEUE;
+
+	return priv->recv_packets + slot * PKTSIZE_ALIGN;
+}
+
+/* Queue the packet just written to sb_eth_recv_slot() */
+static void sb_eth_recv_queue(struct eth_sandbox_priv *priv, int length)
+{
+	int slot = (priv->recv_head + priv->recv_count) % SB_ETH_RECV_QUEUE;
+
+	priv->recv_packet_length[slot] = length;
+	priv->recv_nfs_read[slot] = false;
+	priv->recv_count++;
+}
+
+/* Queue a UDP packet from the fake host, returning the payload to fill in */
+static uchar *sb_eth_udp_reply(struct eth_sandbox_priv *priv,
+			       struct ethernet_hdr *eth, struct ip_udp_hdr *ip,
+			       int sport, int len)
+{
+	struct ethernet_hdr *eth_recv;
+	struct ip_udp_hdr *ipr;
+	uchar *pkt;
+
+	pkt = sb_eth_recv_slot(priv);
+	if (!pkt)
+		return NULL;
+	eth_recv = (void *)pkt;
+	memcpy(eth_recv->et_dest, eth->et_src, ARP_HLEN);
+	memcpy(eth_recv->et_src, priv->fake_host_hwaddr, ARP_HLEN);
+	eth_recv->et_protlen = htons(PROT_IP);
+
+	ipr = (void *)pkt + ETHER_HDR_SIZE;
+	net_set_ip_header((uchar *)ipr, net_read_ip(&ip->ip_src),
+			  priv->fake_host_ipaddr);
+	ipr->ip_len = htons(IP_UDP_HDR_SIZE + len);
+	ipr->ip_p = IPPROTO_UDP;
+	ipr->ip_sum = compute_ip_checksum(ipr, IP_HDR_SIZE);
+	ipr->udp_src = htons(sport);
+	ipr->udp_dst = ip->udp_src;
+	ipr->udp_len = htons(UDP_HDR_SIZE + len);
+	ipr->udp_xsum = 0;
+	sb_eth_recv_queue(priv, ETHER_HDR_SIZE + IP_UDP_HDR_SIZE + len);
+
+	return pkt + ETHER_HDR_SIZE + IP_UDP_HDR_SIZE;
+}
+
+/* Queue an ARP request from the fake host for 'ip' */
+static void sb_eth_arp_request(struct eth_sandbox_priv *priv,
+			       struct in_addr ip)
+{
+	struct ethernet_hdr *eth_recv;
+	struct arp_hdr *arp_recv;
+	uchar *pkt;
+
+	pkt = sb_eth_recv_slot(priv);
+	if (!pkt)
+		return;
+	memset(pkt, '\0', SB_ETH_MIN_FRAME);
+	eth_recv = (void *)pkt;
+	memcpy(eth_recv->et_dest, net_bcast_ethaddr, ARP_HLEN);
+	memcpy(eth_recv->et_src, priv->fake_host_hwaddr, ARP_HLEN);
+	eth_recv->et_protlen = htons(PROT_ARP);
+
+	arp_recv = (void *)pkt + ETHER_HDR_SIZE;
+	arp_recv->ar_hrd = htons(ARP_ETHER);
+	arp_recv->ar_pro = htons(PROT_IP);
+	arp_recv->ar_hln = ARP_HLEN;
+	arp_recv->ar_pln = ARP_PLEN;
+	arp_recv->ar_op = htons(ARPOP_REQUEST);
+	memcpy(&arp_recv->ar_sha, priv->fake_host_hwaddr, ARP_HLEN);
+	net_write_ip(&arp_recv->ar_spa, priv->fake_host_ipaddr);
+	net_write_ip(&arp_recv->ar_tpa, ip);
+
+	sb_eth_recv_queue(priv, SB_ETH_MIN_FRAME);
+}
+
+/* Send the window of blocks following 'block' */
+static void sb_tftp_send_window(struct eth_sandbox_priv *priv,
+				struct ethernet_hdr *eth,
+				struct ip_udp_hdr *ip, ulong block)
+{
+	struct sb_tftp_server *tftp = &priv->tftp;
+	ulong offset, len;
+	__be16 *data;
+	int i;
+
+	for (i = 0; i < tftp->windowsize; i++) {
+		if (++block > tftp->last_block)
+			break;
+		if (block == tftp_drop_block) {
+			tftp_drop_block = 0;
+			tftp_stats.dropped++;
+			continue;
+		}
+		offset = (block - 1) * tftp->blksize;
+		len = min(tftp_file_size - offset, (ulong)tftp->blksize);
+		data = (__be16 *)sb_eth_udp_reply(priv, eth, ip,
+						  SB_TFTP_DATA_PORT, 4 + len);
+		if (!data)
+			break;
+		data[0] = htons(SB_TFTP_DATA);
+		data[1] = htons(block & 0xffff);
+		memcpy(data + 2, tftp_file + offset, len);
+		tftp_stats.data++;
+		if (block == tftp->last_block && tftp_send_arp)
+			sb_eth_arp_request(priv, net_read_ip(&ip->ip_src));
+	}
+}
+
+/* Handle a read request, which starts a new transfer */
+static void sb_tftp_rrq(struct eth_sandbox_priv *priv,
+			struct ethernet_hdr *eth, struct ip_udp_hdr *ip,
+			char *req, int len)
+{
+	struct sb_tftp_server *tftp = &priv->tftp;
+	char *end = req + len, *opt, *val;
+	bool options = false;
+	uchar *pkt;
+	int olen;
+
+	tftp->client_port = ntohs(ip->udp_src);
+	tftp->blksize = 512;
+	tftp->windowsize = 1;
+	tftp->last_block = tftp_file_size / 512 + 1;
+
+	/* Skip the file name and mode, then look at the options */
+	opt = req + strnlen(req, end - req) + 1;
+	opt += strnlen(opt, end - opt) + 1;
+	while (opt < end) {
+		val = opt + strnlen(opt, end - opt) + 1;
+		if (val >= end)
+			break;
+		if (!strcmp(opt, "blksize")) {
+			tftp->blksize = min((int)simple_strtoul(val, NULL, 10),
+					    SB_TFTP_MAX_BLKSIZE);
+			options = true;
+		} else if (!strcmp(opt, "windowsize") &&
+			   tftp_max_windowsize > 1) {
+			tftp->windowsize = min((int)simple_strtoul(val, NULL,
+								   10),
+					       tftp_max_windowsize);
+			options = true;
+		}
+		opt = val + strnlen(val, end - val) + 1;
+	}
+	tftp->last_block = tftp_file_size / tftp->blksize + 1;
+
+	if (!options) {
+		sb_tftp_send_window(priv, eth, ip, 0);
+		return;
+	}
+	pkt = sb_eth_udp_reply(priv, eth, ip, SB_TFTP_DATA_PORT, 64);
+	if (!pkt)
+		return;
+	*(__be16 *)pkt = htons(SB_TFTP_OACK);
+	olen = 2;
+	olen += sprintf((char *)pkt + olen, "blksize%c%d%c", 0, tftp->blksize,
+			0);
+	if (tftp->windowsize > 1)
+		olen += sprintf((char *)pkt + olen, "windowsize%c%d%c", 0,
+				tftp->windowsize, 0);
+	/* Fix up the length now that we know it */
+	priv->recv_count--;
+	sb_eth_udp_reply(priv, eth, ip, SB_TFTP_DATA_PORT, olen);
+}
+
+/* Act as a TFTP server which serves tftp_file for any file name */
+static void sb_tftp_handle(struct eth_sandbox_priv *priv,
+			   struct ethernet_hdr *eth, struct ip_udp_hdr *ip)
+{
+	struct sb_tftp_server *tftp = &priv->tftp;
+	int len = ntohs(ip->udp_len) - UDP_HDR_SIZE;
+	__be16 *s = (__be16 *)(ip + 1);
+
+	if (!tftp_file || len < 4)
+		return;
+	if (ntohs(ip->udp_dst) == SB_TFTP_SERVER_PORT &&
+	    ntohs(s[0]) == SB_TFTP_RRQ) {
+		sb_tftp_rrq(priv, eth, ip, (char *)(s + 1), len - 2);
+	} else if (ntohs(ip->udp_dst) == SB_TFTP_DATA_PORT &&
+		   ntohs(ip->udp_src) == tftp->client_port &&
+		   ntohs(s[0]) == SB_TFTP_ACK) {
+		ulong block = ntohs(s[1]);
+
+		tftp_stats.acks++;
+		/* Find the full block number nearest to what we sent */
+		while (block + 0x8000 < tftp->last_block &&
+		       block < tftp_stats.data - 0x8000)
+			block += 0x10000;
+		if (block >= tftp->last_block)
+			tftp->client_port = 0;
+		else
+			sb_tftp_send_window(priv, eth, ip, block);
+	}
+}
+
+/*
+ * sandbox_eth_nfs_set_file()
+ *
+ * data - Contents of the file to serve over NFS, NULL to stop serving
+ * size - Size of the file in bytes
+ * max_version - Highest NFS version the server speaks, 2 or 3
+ * reorder - true to send every other READ reply after the following one
+ */
+void sandbox_eth_nfs_set_file(const void *data, ulong size, int max_version,
+			      bool reorder)
+{
+	nfs_file = data;
+	nfs_file_size = size;
+	nfs_max_version = max_version;
+	nfs_reorder = reorder;
+	nfs_held_len = 0;
+	nfs_in_flight = 0;
+	memset(&nfs_stats, '\0', sizeof(nfs_stats));
+}
+
+/*
+ * sandbox_eth_nfs_get_stats()
+ *
+ * Get the READ requests handled by the mock NFS server since
+ * sandbox_eth_nfs_set_file() was called
+ */
+void sandbox_eth_nfs_get_stats(struct sandbox_eth_nfs_stats *stats)
+{
+	*stats = nfs_stats;
+}
+
+/*
+ * Queue a UDP datagram from the fake host, split into IP fragments when it
+ * does not fit in one frame. Returns the last packet queued, NULL if the
+ * queue is full.
+ */
+static uchar *sb_eth_udp_send(struct eth_sandbox_priv *priv,
+			      struct ethernet_hdr *eth, struct ip_udp_hdr *ip,
+			      int sport, const void *data, int len)
+{
+	static uchar dgram[UDP_HDR_SIZE + SB_NFS_MAX_READ + 512];
+	static ushort ip_id;
+	__be16 *udp = (__be16 *)dgram;
+	int ulen = UDP_HDR_SIZE + len;
+	uchar *pkt = NULL;
+	int off, flen;
+
+	/* Build the UDP header in front of the data, as sent on the wire */
+	udp[0] = htons(sport);
+	udp[1] = ip->udp_src;
+	udp[2] = htons(ulen);
+	udp[3] = 0;			/* no checksum */
+	memcpy(dgram + UDP_HDR_SIZE, data, len);
+
+	ip_id++;
+	for (off = 0; off < ulen; off += flen) {
+		struct ethernet_hdr *eth_recv;
+		struct ip_hdr *iph;
+
+		flen = min(ulen - off, SB_ETH_IP_FRAG);
+		pkt = sb_eth_recv_slot(priv);
+		if (!pkt)
+			return NULL;
+		eth_recv = (void *)pkt;
+		memcpy(eth_recv->et_dest, eth->et_src, ARP_HLEN);
+		memcpy(eth_recv->et_src, priv->fake_host_hwaddr, ARP_HLEN);
+		eth_recv->et_protlen = htons(PROT_IP);
+
+		iph = (void *)pkt + ETHER_HDR_SIZE;
+		net_set_ip_header((uchar *)iph, net_read_ip(&ip->ip_src),
+				  priv->fake_host_ipaddr);
+		iph->ip_len = htons(IP_HDR_SIZE + flen);
+		iph->ip_id = htons(ip_id);
+		iph->ip_off = htons(off / 8 |
+				    (off + flen < ulen ? IP_FLAGS_MFRAG : 0));
+		iph->ip_p = IPPROTO_UDP;
+		iph->ip_sum = compute_ip_checksum(iph, IP_HDR_SIZE);
+		memcpy(iph + 1, dgram + off, flen);
+		sb_eth_recv_queue(priv, ETHER_HDR_SIZE + IP_HDR_SIZE + flen);
+	}
+
+	return pkt;
+}
+
+/* Send a READ reply, marking its last packet so it is counted when read */
+static void sb_nfs_send_read(struct eth_sandbox_priv *priv,
+			     struct ethernet_hdr *eth, struct ip_udp_hdr *ip,
+			     const void *data, int len)
+{
+	uchar *pkt;
+
+	pkt = sb_eth_udp_send(priv, eth, ip, SB_RPC_NFS_PORT, data, len);
+	if (pkt)
+		priv->recv_nfs_read[(pkt - priv->recv_packets) /
+				    PKTSIZE_ALIGN] = true;
+}
+
+/* Fill in NFS file attributes (fattr for v2, fattr3 for v3) */
+static uint32_t *sb_nfs_add_attr(uint32_t *r, int version)
+{
+	int words = version == 3 ? 21 : 17;
+
+	memset(r, '\0', words * sizeof(*r));
+	r[0] = htonl(1);		/* regular file */
+	if (version == 3) {
+		r[5] = htonl((u64)nfs_file_size >> 32);
+		r[6] = htonl(nfs_file_size);
+	} else {
+		r[5] = htonl(nfs_file_size);
+	}
+
+	return r + words;
+}
+
+/* Add a file handle, made of 'c' bytes */
+static uint32_t *sb_nfs_add_fh(uint32_t *r, int version, char c)
+{
+	int len = version == 3 ? SB_NFS3_FHSIZE : 32;
+
+	if (version == 3)
+		*r++ = htonl(len);
+	memset(r, c, len);
+
+	return r + len / 4;
+}
+
+/* Check the file handle at 'p', returning NULL if it is not made of 'c' */
+static uint32_t *sb_nfs_check_fh(uint32_t *p, int version, char c)
+{
+	int len = version == 3 ? SB_NFS3_FHSIZE : 32;
+	uchar *fh;
+	int i;
+
+	if (version == 3 && ntohl(*p++) != len)
+		return NULL;
+	for (fh = (uchar *)p, i = 0; i < len; i++) {
+		if (fh[i] != c)
+			return NULL;
+	}
+
+	return p + len / 4;
+}
+
+/* Handle an NFS READ call with arguments at 'p', adding the reply at 'r' */
+static uint32_t *sb_nfs_read(int version, uint32_t *p, uint32_t *r)
+{
+	ulong offset, count;
+	bool eof;
+
+	p = sb_nfs_check_fh(p, version, 'F');
+	if (!p) {
+		*r++ = htonl(version == 3 ? SB_NFS3ERR_BADHANDLE :
+			     SB_NFSERR_STALE);
+		if (version == 3)
+			*r++ = 0;	/* no attributes */
+		return r;
+	}
+	if (version == 3) {
+		offset = (u64)ntohl(p[0]) << 32 | ntohl(p[1]);
+		count = ntohl(p[2]);
+	} else {
+		offset = ntohl(p[0]);
+		count = ntohl(p[1]);
+	}
+
+	nfs_stats.reads++;
+	nfs_stats.version = version;
+	nfs_stats.max_count = max(nfs_stats.max_count, count);
+	nfs_stats.max_in_flight = max(nfs_stats.max_in_flight,
+				      ++nfs_in_flight);
+
+	count = min(count, (ulong)SB_NFS_MAX_READ);
+	if (offset >= nfs_file_size)
+		count = 0;
+	else
+		count = min(count, nfs_file_size - offset);
+	eof = offset + count >= nfs_file_size;
+
+	*r++ = 0;			/* NFS_OK */
+	if (version == 3)
+		*r++ = htonl(1);	/* attributes follow */
+	r = sb_nfs_add_attr(r, version);
+	if (version == 3) {
+		*r++ = htonl(count);
+		*r++ = htonl(eof);
+	}
+	*r++ = htonl(count);
+	r[count / 4] = 0;		/* zero padding */
+	memcpy(r, nfs_file + offset, count);
+
+	return r + (count + 3) / 4;
+}
+
+/* Send the READ reply held back, if any */
+static void sb_nfs_release(struct eth_sandbox_priv *priv)
+{
+	if (!nfs_held_len)
+		return;
+	sb_nfs_send_read(priv, &nfs_held_eth, &nfs_held_ip, nfs_held,
+			 nfs_held_len);
+	nfs_held_len = 0;
+}
+
+/*
+ * Act as a portmapper, mount daemon and NFS server, which serve nfs_file
+ * for any path
+ */
+static void sb_nfs_handle(struct eth_sandbox_priv *priv,
+			  struct ethernet_hdr *eth, struct ip_udp_hdr *ip)
+{
+	static uint32_t call[512];
+	static uint32_t reply[(SB_NFS_MAX_READ + 512) / 4];
+	int len = ntohs(ip->udp_len) - UDP_HDR_SIZE;
+	int dport = ntohs(ip->udp_dst);
+	uint32_t prog, vers, proc;
+	uint32_t *p, *r, *astatus;
+
+	if (!nfs_file || len < 40 || len > sizeof(call))
+		return;
+	if (dport != SB_RPC_PORTMAP_PORT && dport != SB_RPC_MOUNT_PORT &&
+	    dport != SB_RPC_NFS_PORT)
+		return;
+	memcpy(call, ip + 1, len);
+	if (ntohl(call[1]) != 0)	/* not a call */
+		return;
+	prog = ntohl(call[3]);
+	vers = ntohl(call[4]);
+	proc = ntohl(call[5]);
+	/* Skip the credentials and the verifier */
+	p = call + 6;
+	p += 2 + (ntohl(p[1]) + 3) / 4;
+	p += 2 + (ntohl(p[1]) + 3) / 4;
+
+	r = reply;
+	*r++ = call[0];
+	*r++ = htonl(1);		/* reply */
+	*r++ = 0;			/* accepted */
+	*r++ = 0;			/* AUTH_NONE verifier */
+	*r++ = 0;
+	astatus = r++;
+	*astatus = 0;
+
+	if (prog == SB_RPC_PORTMAP && proc == 3) {
+		uint32_t port = 0;
+
+		/* GETPORT */
+		vers = ntohl(p[1]);
+		if (ntohl(p[0]) == SB_RPC_MOUNT && vers <= nfs_max_version)
+			port = SB_RPC_MOUNT_PORT;
+		else if (ntohl(p[0]) == SB_RPC_NFS && vers >= 2 &&
+			 vers <= nfs_max_version)
+			port = SB_RPC_NFS_PORT;
+		*r++ = htonl(port);
+	} else if (vers > nfs_max_version) {
+		*astatus = htonl(SB_RPC_PROG_MISMATCH);
+		*r++ = htonl(2);
+		*r++ = htonl(nfs_max_version);
+	} else if (prog == SB_RPC_MOUNT && proc == 1) {
+		/* MNT */
+		*r++ = 0;
+		r = sb_nfs_add_fh(r, vers, 'D');
+		if (vers == 3) {
+			*r++ = htonl(1);	/* one auth flavour */
+			*r++ = htonl(1);	/* AUTH_UNIX */
+		}
+	} else if (prog == SB_RPC_NFS &&
+		   proc == (vers == 3 ? 3 : 4)) {
+		/* LOOKUP, which finds the file for any name */
+		if (!sb_nfs_check_fh(p, vers, 'D')) {
+			*r++ = htonl(vers == 3 ? SB_NFS3ERR_BADHANDLE :
+				     SB_NFSERR_STALE);
+			if (vers == 3)
+				*r++ = 0;
+		} else {
+			*r++ = 0;
+			r = sb_nfs_add_fh(r, vers, 'F');
+			if (vers == 3) {
+				*r++ = htonl(1);
+				r = sb_nfs_add_attr(r, vers);
+				*r++ = 0;	/* no directory attributes */
+			} else {
+				r = sb_nfs_add_attr(r, vers);
+			}
+		}
+	} else if (prog == SB_RPC_NFS && proc == 6) {
+		r = sb_nfs_read(vers, p, r);
+		len = (r - reply) * sizeof(*r);
+		if (nfs_reorder && !nfs_held_len) {
+			memcpy(nfs_held, reply, len);
+			nfs_held_len = len;
+			nfs_held_eth = *eth;
+			nfs_held_ip = *ip;
+			return;
+		}
+		sb_nfs_send_read(priv, eth, ip, reply, len);
+		sb_nfs_release(priv);
+		return;
+	} else if (prog != SB_RPC_MOUNT || proc != 4) {
+		/* Anything but UMNTALL, which has no result */
+		*astatus = htonl(3);	/* PROC_UNAVAIL */
+	}
+
+	sb_eth_udp_send(priv, eth, ip, dport, reply,
+			(r - reply) * sizeof(*r));
+}
+
 static int sb_eth_start(struct udevice *dev)
 {
 	struct eth_sandbox_priv *priv = dev_get_priv(dev);
@@ -62,7 +724,16 @@ static int sb_eth_start(struct udevice *dev)
 
 	fdtdec_get_byte_array(gd->fdt_blob, dev->of_offset, "fake-host-hwaddr",
 			      priv->fake_host_hwaddr, ARP_HLEN);
-	priv->recv_packet_buffer = net_rx_packets[0];
+	if (!priv->recv_packets) {
+		priv->recv_packets = malloc(SB_ETH_RECV_QUEUE * PKTSIZE_ALIGN);
+		if (!priv->recv_packets)
+			return -ENOMEM;
+	}
+	priv->recv_head = 0;
+	priv->recv_count = 0;
+	priv->rx_dest = NULL;
+	priv->tftp.client_port = 0;
+
 	return 0;
 }
 
@@ -83,18 +754,20 @@ static int sb_eth_send(struct udevice *dev, void *packet, int length)
 		if (ntohs(arp->ar_op) == ARPOP_REQUEST) {
 			struct ethernet_hdr *eth_recv;
 			struct arp_hdr *arp_recv;
+			uchar *pkt = sb_eth_recv_slot(priv);
 
+			if (!pkt)
+				return 0;
 			/* store this as the assumed IP of the fake host */
 			priv->fake_host_ipaddr = net_read_ip(&arp->ar_tpa);
 			/* Formulate a fake response */
-			eth_recv = (void *)priv->recv_packet_buffer;
+			eth_recv = (void *)pkt;
 			memcpy(eth_recv->et_dest, eth->et_src, ARP_HLEN);
 			memcpy(eth_recv->et_src, priv->fake_host_hwaddr,
 			       ARP_HLEN);
 			eth_recv->et_protlen = htons(PROT_ARP);
 
-			arp_recv = (void *)priv->recv_packet_buffer +
-				ETHER_HDR_SIZE;
+			arp_recv = (void *)pkt + ETHER_HDR_SIZE;
 			arp_recv->ar_hrd = htons(ARP_ETHER);
 			arp_recv->ar_pro = htons(PROT_IP);
 			arp_recv->ar_hln = ARP_HLEN;
@@ -106,8 +779,7 @@ static int sb_eth_send(struct udevice *dev, void *packet, int length)
 			memcpy(&arp_recv->ar_tha, &arp->ar_sha, ARP_HLEN);
 			net_copy_ip(&arp_recv->ar_tpa, &arp->ar_spa);
 
-			priv->recv_packet_length = ETHER_HDR_SIZE +
-				ARP_HDR_SIZE;
+			sb_eth_recv_queue(priv, ETHER_HDR_SIZE + ARP_HDR_SIZE);
 		}
 	} else if (ntohs(eth->et_protlen) == PROT_IP) {
 		struct ip_udp_hdr *ip = packet + ETHER_HDR_SIZE;
@@ -119,13 +791,14 @@ static int sb_eth_send(struct udevice *dev, void *packet, int length)
 				struct ethernet_hdr *eth_recv;
 				struct ip_udp_hdr *ipr;
 				struct icmp_hdr *icmpr;
+				uchar *pkt = sb_eth_recv_slot(priv);
 
+				if (!pkt)
+					return 0;
 				/* reply to the ping */
-				memcpy(priv->recv_packet_buffer, packet,
-				       length);
-				eth_recv = (void *)priv->recv_packet_buffer;
-				ipr = (void *)priv->recv_packet_buffer +
-					ETHER_HDR_SIZE;
+				memcpy(pkt, packet, length);
+				eth_recv = (void *)pkt;
+				ipr = (void *)pkt + ETHER_HDR_SIZE;
 				icmpr = (struct icmp_hdr *)&ipr->udp_src;
 				memcpy(eth_recv->et_dest, eth->et_src,
 				       ARP_HLEN);
@@ -144,8 +817,11 @@ static int sb_eth_send(struct udevice *dev, void *packet, int length)
 				icmpr->checksum = compute_ip_checksum(icmpr,
 					ICMP_HDR_SIZE);
 
-				priv->recv_packet_length = length;
+				sb_eth_recv_queue(priv, length);
 			}
+		} else if (ip->ip_p == IPPROTO_UDP) {
+			sb_tftp_handle(priv, eth, ip);
+			sb_nfs_handle(priv, eth, ip);
 		}
 	}
 
@@ -161,21 +837,76 @@ static int sb_eth_recv(struct udevice *dev, int flags, uchar **packetp)
 		skip_timeout = false;
 	}
 
-	if (priv->recv_packet_length) {
-		int lcl_recv_packet_length = priv->recv_packet_length;
+	/* The network delivers the held back reply when it goes quiet */
+	if (!priv->recv_count)
+		sb_nfs_release(priv);
+
+	if (priv->recv_count) {
+		int length = priv->recv_packet_length[priv->recv_head];
+		uchar *pkt = priv->recv_packets +
+			priv->recv_head * PKTSIZE_ALIGN;
+		int len = length - priv->rx_offset;
+
+		debug("eth_sandbox: received packet %d\n", length);
+		if (priv->recv_nfs_read[priv->recv_head]) {
+			priv->recv_nfs_read[priv->recv_head] = false;
+			nfs_in_flight--;
+		}
+		/*
+		 * Act like hardware which splits the headers from the data
+		 * of the flow it was set up for. Scribble over the data left
+		 * in the packet buffer, so that anything which reads it from
+		 * there fails.
+		 */
+		if (priv->rx_dest && len > 0 && len <= priv->rx_len &&
+		    net_rx_dest_match(pkt, priv->rx_offset)) {
+			memcpy(priv->rx_dest, pkt + priv->rx_offset, len);
+			memset(pkt + priv->rx_offset, 0xa5, len);
+			eth_rx_placed(dev);
+			rx_placed++;
+		}
+		*packetp = pkt;
+		return length;
+	}
+	return 0;
+}
+
+static int sb_eth_rx_dest(struct udevice *dev, void *dest, int offset,
+			  int len)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+
+	if (rx_dest_disabled)
+		return -ENOSYS;
+	priv->rx_dest = dest;
+	priv->rx_offset = offset;
+	priv->rx_len = len;
+
+	return 0;
+}
 
-		debug("eth_sandbox: received packet %d\n",
-		      priv->recv_packet_length);
-		priv->recv_packet_length = 0;
-		*packetp = priv->recv_packet_buffer;
-		return lcl_recv_packet_length;
+static int sb_eth_free_pkt(struct udevice *dev, uchar *packet, int length)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+
+	/*
+	 * The packet stays queued until it has been processed, since
+	 * processing it may queue replies behind it
+	 */
+	if (length && priv->recv_count) {
+		priv->recv_head = (priv->recv_head + 1) % SB_ETH_RECV_QUEUE;
+		priv->recv_count--;
 	}
+
 	return 0;
 }
 
 static void sb_eth_stop(struct udevice *dev)
 {
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+
 	debug("eth_sandbox: Stop\n");
+	priv->rx_dest = NULL;
 }
 
 static int sb_eth_write_hwaddr(struct udevice *dev)
@@ -191,12 +922,19 @@ static const struct eth_ops sb_eth_ops = {
 	.start			= sb_eth_start,
 	.send			= sb_eth_send,
 	.recv			= sb_eth_recv,
+	.free_pkt		= sb_eth_free_pkt,
 	.stop			= sb_eth_stop,
 	.write_hwaddr		= sb_eth_write_hwaddr,
+	.rx_dest		= sb_eth_rx_dest,
 };
 
 static int sb_eth_remove(struct udevice *dev)
 {
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+
+	free(priv->recv_packets);
+	priv->recv_packets = NULL;
+
 	return 0;
 }
 
@@ -26,6 +26,9 @@ DECLARE_GLOBAL_DATA_PTR;
 # define CONFIG_SPI_IDLE_VAL 0xFF
 #endif
 
+/* Opcode, 4 address bytes and up to 3 dummy bytes */
+#define SANDBOX_FLASH_CMD_MAX	8
+
 const char *sandbox_spi_parse_spec(const char *arg, unsigned long *bus,
 				   unsigned long *cs)
 {
@@ -49,27 +52,14 @@ __weak int sandbox_spi_get_emul(struct sandbox_state *state,
 	return -ENOENT;
 }
 
-static int sandbox_spi_xfer(struct udevice *slave, unsigned int bitlen,
-			    const void *dout, void *din, unsigned long flags)
+/* Find and probe the emulator attached to a slave */
+static int sandbox_spi_find_emul(struct udevice *slave, struct udevice **emulp)
 {
 	struct udevice *bus = slave->parent;
 	struct sandbox_state *state = state_get_current();
-	struct dm_spi_emul_ops *ops;
 	struct udevice *emul;
-	uint bytes = bitlen / 8, i;
-	int ret;
-	u8 *tx = (void *)dout, *rx = din;
 	uint busnum, cs;
-
-	if (bitlen == 0)
-		return 0;
-
-	/* we can only do 8 bit transfers */
-	if (bitlen % 8) {
-		printf("sandbox_spi: xfer: invalid bitlen size %u; needs to be 8bit\n",
-		       bitlen);
-		return -EINVAL;
-	}
+	int ret;
 
 	busnum = bus->seq;
 	cs = spi_chip_select(slave);
@@ -86,6 +76,33 @@ static int sandbox_spi_xfer(struct udevice *slave, unsigned int bitlen,
 		return -ENOENT;
 	}
 	ret = device_probe(emul);
+	if (ret)
+		return ret;
+	*emulp = emul;
+
+	return 0;
+}
+
+static int sandbox_spi_xfer(struct udevice *slave, unsigned int bitlen,
+			    const void *dout, void *din, unsigned long flags)
+{
+	struct dm_spi_emul_ops *ops;
+	struct udevice *emul;
+	uint bytes = bitlen / 8, i;
+	int ret;
+	u8 *tx = (void *)dout, *rx = din;
+
+	if (bitlen == 0)
+		return 0;
+
+	/* we can only do 8 bit transfers */
+	if (bitlen % 8) {
+		printf("sandbox_spi: xfer: invalid bitlen size %u; needs to be 8bit\n",
+		       bitlen);
+		return -EINVAL;
+	}
+
+	ret = sandbox_spi_find_emul(slave, &emul);
 	if (ret)
 		return ret;
 
@@ -124,6 +141,39 @@ static int sandbox_spi_xfer(struct udevice *slave, unsigned int bitlen,
 	return ret;
 }
 
+/*
+ * Read from a SPI flash in one go, as a controller with a flash-read engine
+ * would. The data goes straight into the caller's buffer, without the
+ * scratch buffers needed by a general transfer.
+ */
+static int sandbox_spi_flash_read(struct udevice *slave,
+				  struct spi_flash_read_message *msg)
+{
+	struct dm_spi_emul_ops *ops;
+	struct udevice *emul;
+	u8 cmd[SANDBOX_FLASH_CMD_MAX];
+	int cmd_len, i, ret;
+
+	cmd_len = 1 + msg->addr_width + msg->dummy_bytes;
+	if (cmd_len > sizeof(cmd))
+		return -EINVAL;
+	ret = sandbox_spi_find_emul(slave, &emul);
+	if (ret)
+		return ret;
+
+	memset(cmd, '\0', sizeof(cmd));
+	cmd[0] = msg->read_opcode;
+	for (i = 0; i < msg->addr_width; i++)
+		cmd[msg->addr_width - i] = msg->from >> (i * 8);
+	ops = spi_emul_get_ops(emul);
+	ret = ops->xfer(emul, cmd_len * 8, cmd, NULL, SPI_XFER_BEGIN);
+	if (!ret)
+		ret = ops->xfer(emul, msg->len * 8, NULL, msg->buf,
+				SPI_XFER_END);
+
+	return ret;
+}
+
 static int sandbox_spi_set_speed(struct udevice *bus, uint speed)
 {
 	return 0;
@@ -146,6 +196,7 @@ static int sandbox_cs_info(struct udevice *bus, uint cs,
 
 static const struct dm_spi_ops sandbox_spi_ops = {
 	.xfer		= sandbox_spi_xfer,
+	.flash_read	= sandbox_spi_flash_read,
 	.set_speed	= sandbox_spi_set_speed,
 	.set_mode	= sandbox_spi_set_mode,
 	.cs_info	= sandbox_cs_info,
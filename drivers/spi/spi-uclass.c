@@ -95,6 +95,39 @@ int spi_xfer(struct spi_slave *slave, unsigned int bitlen,
 	return spi_get_ops(bus)->xfer(dev, bitlen, dout, din, flags);
 }
 
+int spi_flash_read_msg(struct spi_slave *slave,
+		       struct spi_flash_read_message *msg)
+{
+	struct udevice *dev = slave->dev;
+	struct udevice *bus = dev->parent;
+	struct dm_spi_ops *ops = spi_get_ops(bus);
+
+	if (bus->uclass->uc_drv->id != UCLASS_SPI || !ops->flash_read)
+		return -ENOSYS;
+
+	return ops->flash_read(dev, msg);
+}
+
+bool spi_has_flash_read(struct spi_slave *slave)
+{
+	struct udevice *bus = slave->dev->parent;
+
+	return bus->uclass->uc_drv->id == UCLASS_SPI &&
+		spi_get_ops(bus)->flash_read;
+}
+
+int spi_get_mmap(struct spi_slave *slave, ulong *map_basep, uint *map_sizep)
+{
+	struct udevice *dev = slave->dev;
+	struct udevice *bus = dev->parent;
+	struct dm_spi_ops *ops = spi_get_ops(bus);
+
+	if (bus->uclass->uc_drv->id != UCLASS_SPI || !ops->get_mmap)
+		return -ENOSYS;
+
+	return ops->get_mmap(dev, map_basep, map_sizep);
+}
+
 static int spi_post_bind(struct udevice *dev)
 {
 	/* Scan the bus for devices */
@@ -130,6 +163,10 @@ static int spi_post_probe(struct udevice *bus)
 		ops->set_wordlen += gd->reloc_off;
 	if (ops->xfer)
 		ops->xfer += gd->reloc_off;
+	if (ops->flash_read)
+		ops->flash_read += gd->reloc_off;
+	if (ops->get_mmap)
+		ops->get_mmap += gd->reloc_off;
 	if (ops->set_speed)
 		ops->set_speed += gd->reloc_off;
 	if (ops->set_mode)
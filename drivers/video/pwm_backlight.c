@@ -23,24 +23,19 @@ struct pwm_backlight_priv {
 	uint default_level;
 	uint min_level;
 	uint max_level;
+	ulong power_on_time;
 };
 
+/* Time for the supply to settle before the PWM is started */
+#define PWM_BACKLIGHT_POWER_ON_MS	120
+
 static int pwm_backlight_enable(struct udevice *dev)
 {
 	struct pwm_backlight_priv *priv = dev_get_priv(dev);
 	uint duty_cycle;
 	int ret;
 
-	debug("%s: Enable '%s', regulator '%s'\n", __func__, dev->name,
-	      priv->reg->name);
-	ret = regulator_set_enable(priv->reg, true);
-	if (ret) {
-		debug("%s: Cannot enable regulator for PWM '%s'\n", __func__,
-		      dev->name);
-		return ret;
-	}
-	mdelay(120);
-
+	debug("%s: Enable '%s'\n", __func__, dev->name);
 	duty_cycle = priv->period_ns * (priv->default_level - priv->min_level) /
 		(priv->max_level - priv->min_level + 1);
 	ret = pwm_set_config(priv->pwm, priv->channel, priv->period_ns,
@@ -109,8 +104,35 @@ static int pwm_backlight_ofdata_to_platdata(struct udevice *dev)
 	return 0;
 }
 
+/*
+ * Power up the backlight supply here rather than in pwm_backlight_enable(),
+ * so that the rest of the board is set up while it settles.
+ */
 static int pwm_backlight_probe(struct udevice *dev)
 {
+	struct pwm_backlight_priv *priv = dev_get_priv(dev);
+	int ret;
+
+	debug("%s: Power up '%s', regulator '%s'\n", __func__, dev->name,
+	      priv->reg->name);
+	ret = regulator_set_enable(priv->reg, true);
+	if (ret) {
+		debug("%s: Cannot enable regulator for PWM '%s'\n", __func__,
+		      dev->name);
+		return ret;
+	}
+	priv->power_on_time = get_timer(0);
+
+	return -EINPROGRESS;
+}
+
+static int pwm_backlight_probe_poll(struct udevice *dev)
+{
+	struct pwm_backlight_priv *priv = dev_get_priv(dev);
+
+	if (get_timer(priv->power_on_time) < PWM_BACKLIGHT_POWER_ON_MS)
+		return -EINPROGRESS;
+
 	return 0;
 }
 
@@ -130,5 +152,7 @@ U_BOOT_DRIVER(pwm_backlight) = {
 	.ops	= &pwm_backlight_ops,
 	.ofdata_to_platdata	= pwm_backlight_ofdata_to_platdata,
 	.probe		= pwm_backlight_probe,
+	.probe_poll	= pwm_backlight_probe_poll,
 	.priv_auto_alloc_size	= sizeof(struct pwm_backlight_priv),
+	.flags		= DM_FLAG_PROBE_ASYNC,
 };
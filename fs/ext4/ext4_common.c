@@ -20,6 +20,7 @@
  */
 
 #include <common.h>
+#include <arena.h>
 #include <ext_common.h>
 #include <ext4fs.h>
 #include <inttypes.h>
@@ -45,6 +46,7 @@ int ext4fs_indir3_size;
 int ext4fs_indir3_blkno = -1;
 struct ext2_inode *g_parent_inode;
 static int symlinknest;
+static struct arena *ext4fs_scratch;	/* Buffers for extent lookups */
 
 #if defined(CONFIG_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n)
@@ -372,6 +374,12 @@ void ext4fs_update_parent_dentry(char *filename, int *p_ino, int file_type)
 		printf("No Memory\n");
 		return;
 	}
+	/*
+	 * New entries are appended to the last block, which would leave them
+	 * in the wrong place in a hash-indexed directory. Drop the index so
+	 * the directory is searched linearly from now on.
+	 */
+	g_parent_inode->flags &= cpu_to_le32(~EXT4_INDEX_FL);
 restart:
 
 	/* read the block no allocated to a file */
@@ -1467,6 +1475,148 @@ static int ext4fs_blockgroup
 			      (char *)blkgrp);
 }
 
+#if CONFIG_IS_ENABLED(EXT4_CACHE)
+/*
+ * Loading several files from the same tree resolves the same directories
+ * over and over, so remember recent name lookups (including failed ones)
+ * and recently read inodes. The caches belong to the volume recorded by
+ * ext4fs_cache_check() and are not used while the filesystem is written.
+ */
+#define EXT4_DCACHE_ENTRIES	32
+#define EXT4_DCACHE_NAME_LEN	64
+#define EXT4_ICACHE_ENTRIES	32
+
+struct ext4_dcache_entry {
+	int dir;		/* inode number of the directory, 0 if unused */
+	int ino;		/* 0 if the name does not exist */
+	int type;
+	ulong last_used;
+	char name[EXT4_DCACHE_NAME_LEN];
+};
+
+struct ext4_icache_entry {
+	int ino;		/* 0 if unused */
+	struct ext2_inode inode;
+};
+
+static struct ext4_dcache_entry ext4_dcache[EXT4_DCACHE_ENTRIES];
+static struct ext4_icache_entry ext4_icache[EXT4_ICACHE_ENTRIES];
+static ulong ext4_dcache_seq;
+static struct blk_desc *ext4_cache_dev;
+static lbaint_t ext4_cache_part;
+static struct ext2_sblock ext4_cache_sblock;
+
+void ext4fs_cache_flush(void)
+{
+	memset(ext4_dcache, '\0', sizeof(ext4_dcache));
+	memset(ext4_icache, '\0', sizeof(ext4_icache));
+	ext4_cache_dev = NULL;
+}
+
+/*
+ * Keep the caches if the superblock just read is the one they were filled
+ * from. Linux updates the superblock when it writes to the filesystem, so
+ * this also catches changes made outside U-Boot.
+ */
+static void ext4fs_cache_check(struct ext2_sblock *sblock)
+{
+	struct blk_desc *dev = get_fs()->dev_desc;
+
+	if (ext4_cache_dev == dev && ext4_cache_part == part_offset &&
+	    !memcmp(&ext4_cache_sblock, sblock, sizeof(*sblock)))
+		return;
+
+	ext4fs_cache_flush();
+	memcpy(&ext4_cache_sblock, sblock, sizeof(*sblock));
+	ext4_cache_dev = dev;
+	ext4_cache_part = part_offset;
+}
+
+static bool ext4fs_cache_active(void)
+{
+	/* fs->sb is only set between ext4fs_init() and ext4fs_deinit() */
+	return ext4_cache_dev && !get_fs()->sb;
+}
+
+static int ext4fs_dcache_find(int dir, const char *name, int *ino, int *type)
+{
+	struct ext4_dcache_entry *ent;
+	int i;
+
+	if (!ext4fs_cache_active())
+		return 0;
+	for (i = 0, ent = ext4_dcache; i < EXT4_DCACHE_ENTRIES; i++, ent++) {
+		if (ent->dir == dir && !strcmp(ent->name, name)) {
+			ent->last_used = ++ext4_dcache_seq;
+			*ino = ent->ino;
+			*type = ent->type;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void ext4fs_dcache_add(int dir, const char *name, int ino, int type)
+{
+	struct ext4_dcache_entry *ent, *victim = ext4_dcache;
+	int i;
+
+	if (!ext4fs_cache_active() || strlen(name) >= EXT4_DCACHE_NAME_LEN)
+		return;
+	for (i = 0, ent = ext4_dcache; i < EXT4_DCACHE_ENTRIES; i++, ent++) {
+		if (ent->last_used < victim->last_used)
+			victim = ent;
+	}
+	victim->dir = dir;
+	victim->ino = ino;
+	victim->type = type;
+	victim->last_used = ++ext4_dcache_seq;
+	strcpy(victim->name, name);
+}
+
+static int ext4fs_icache_find(int ino, struct ext2_inode *inode)
+{
+	struct ext4_icache_entry *ent;
+
+	ent = &ext4_icache[ino % EXT4_ICACHE_ENTRIES];
+	if (!ext4fs_cache_active() || ent->ino != ino)
+		return 0;
+	memcpy(inode, &ent->inode, sizeof(*inode));
+
+	return 1;
+}
+
+static void ext4fs_icache_add(int ino, struct ext2_inode *inode)
+{
+	struct ext4_icache_entry *ent;
+
+	if (!ext4fs_cache_active())
+		return;
+	ent = &ext4_icache[ino % EXT4_ICACHE_ENTRIES];
+	ent->ino = ino;
+	memcpy(&ent->inode, inode, sizeof(*inode));
+}
+#else
+static inline void ext4fs_cache_check(struct ext2_sblock *sblock) {}
+
+static inline int ext4fs_dcache_find(int dir, const char *name, int *ino,
+				     int *type)
+{
+	return 0;
+}
+
+static inline void ext4fs_dcache_add(int dir, const char *name, int ino,
+				     int type) {}
+
+static inline int ext4fs_icache_find(int ino, struct ext2_inode *inode)
+{
+	return 0;
+}
+
+static inline void ext4fs_icache_add(int ino, struct ext2_inode *inode) {}
+#endif
+
 int ext4fs_read_inode(struct ext2_data *data, int ino, struct ext2_inode *inode)
 {
 	struct ext2_block_group blkgrp;
@@ -1477,6 +1627,9 @@ int ext4fs_read_inode(struct ext2_data *data, int ino, struct ext2_inode *inode)
 	long int blkno;
 	unsigned int blkoff;
 
+	if (ext4fs_icache_find(ino, inode))
+		return 1;
+
 	/* It is easier to calculate if the first inode is 0. */
 	ino--;
 	status = ext4fs_blockgroup(data, ino / __le32_to_cpu
@@ -1494,6 +1647,7 @@ int ext4fs_read_inode(struct ext2_data *data, int ino, struct ext2_inode *inode)
 				sizeof(struct ext2_inode), (char *)inode);
 	if (status == 0)
 		return 0;
+	ext4fs_icache_add(ino + 1, inode);
 
 	return 1;
 }
@@ -1514,12 +1668,23 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 		- get_fs()->dev_desc->log2blksz;
 
 	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL) {
-		char *buf = zalloc(blksz);
-		if (!buf)
-			return -ENOMEM;
 		struct ext4_extent_header *ext_block;
 		struct ext4_extent *extent;
 		int i = -1;
+		char *buf;
+
+		/*
+		 * This runs for every block of a file, so take the buffer
+		 * from an arena rather than making a malloc()/free() pair
+		 */
+		if (!ext4fs_scratch) {
+			ext4fs_scratch = arena_create(blksz);
+			if (!ext4fs_scratch)
+				return -ENOMEM;
+		}
+		buf = arena_alloc(ext4fs_scratch, blksz);
+		if (!buf)
+			return -ENOMEM;
 		ext_block =
 			ext4fs_get_extent_block(ext4fs_root, buf,
 						(struct ext4_extent_header *)
@@ -1527,7 +1692,7 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 						fileblock, log2_blksz);
 		if (!ext_block) {
 			printf("invalid extent block\n");
-			free(buf);
+			arena_reset(ext4fs_scratch);
 			return -EINVAL;
 		}
 
@@ -1541,20 +1706,22 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 		if (--i >= 0) {
 			fileblock -= le32_to_cpu(extent[i].ee_block);
 			if (fileblock >= le16_to_cpu(extent[i].ee_len)) {
-				free(buf);
-				return 0;
-			}
-
-			start = le16_to_cpu(extent[i].ee_start_hi);
-			start = (start << 32) +
+				blknr = 0;
+			} else {
+				start = le16_to_cpu(extent[i].ee_start_hi);
+				start = (start << 32) +
 					le32_to_cpu(extent[i].ee_start_lo);
-			free(buf);
-			return fileblock + start;
+				blknr = fileblock + start;
+			}
+		} else {
+			printf("Extent Error\n");
+			blknr = -1;
 		}
 
-		printf("Extent Error\n");
-		free(buf);
-		return -1;
+		/* extent points into buf, so keep it until we are done */
+		arena_reset(ext4fs_scratch);
+
+		return blknr;
 	}
 
 	/* Direct blocks. */
@@ -1885,10 +2052,66 @@ void ext4fs_close(void)
 		free(ext4fs_root);
 		ext4fs_root = NULL;
 	}
+	arena_destroy(ext4fs_scratch);
+	ext4fs_scratch = NULL;
 
 	ext4fs_reinit_global();
 }
 
+static int ext4fs_inode_type(struct ext2_inode *inode)
+{
+	switch (__le16_to_cpu(inode->mode) & FILETYPE_INO_MASK) {
+	case FILETYPE_INO_DIRECTORY:
+		return FILETYPE_DIRECTORY;
+	case FILETYPE_INO_SYMLINK:
+		return FILETYPE_SYMLINK;
+	case FILETYPE_INO_REG:
+		return FILETYPE_REG;
+	}
+
+	return FILETYPE_UNKNOWN;
+}
+
+/* Look up a single name in a directory, using the index if it has one */
+static int ext4fs_lookup(struct ext2fs_node *dir, char *name,
+			 struct ext2fs_node **fnode, int *ftype)
+{
+	struct ext2fs_node *fdiro;
+	int ino, type, status;
+
+	if (!ext4fs_dcache_find(dir->ino, name, &ino, &type)) {
+		status = ext4fs_dir_find(dir, name, &ino, &type);
+		if (status < 0)
+			return 0;
+		if (!status)
+			ino = 0;
+		/* The type is read from the inode below if not known */
+		if (ino && type != FILETYPE_DIRECTORY &&
+		    type != FILETYPE_SYMLINK && type != FILETYPE_REG)
+			type = FILETYPE_UNKNOWN;
+		if (ino && type == FILETYPE_UNKNOWN) {
+			struct ext2_inode inode;
+
+			if (!ext4fs_read_inode(dir->data, ino, &inode))
+				return 0;
+			type = ext4fs_inode_type(&inode);
+		}
+		ext4fs_dcache_add(dir->ino, name, ino, type);
+	}
+	if (!ino)
+		return 0;
+
+	fdiro = zalloc(sizeof(struct ext2fs_node));
+	if (!fdiro)
+		return 0;
+	fdiro->data = dir->data;
+	fdiro->ino = ino;
+	*fnode = fdiro;
+	*ftype = type;
+
+	return 1;
+}
+
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 				struct ext2fs_node **fnode, int *ftype)
 {
@@ -1906,7 +2129,10 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 		if (status == 0)
 			return 0;
 	}
-	/* Search the file.  */
+	if (name && fnode && ftype)
+		return ext4fs_lookup(diro, name, fnode, ftype);
+
+	/* List the directory */
 	while (fpos < __le32_to_cpu(diro->inode.size)) {
 		struct ext2_dirent dirent;
 
@@ -2188,7 +2414,11 @@ int ext4fs_open(const char *filename, loff_t *len)
 	if (ext4fs_root == NULL)
 		return -1;
 
-	ext4fs_file = NULL;
+	/* Drop the file from any earlier open, e.g. when reading in chunks */
+	if (ext4fs_file) {
+		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
+		ext4fs_file = NULL;
+	}
 	status = ext4fs_find_file(filename, &ext4fs_root->diropen, &fdiro,
 				  FILETYPE_REG);
 	if (status == 0)
@@ -2229,6 +2459,8 @@ int ext4fs_mount(unsigned part_length)
 	if (__le16_to_cpu(data->sblock.magic) != EXT2_MAGIC)
 		goto fail;
 
+	ext4fs_cache_check(&data->sblock);
+
 	if (__le32_to_cpu(data->sblock.revision_level == 0))
 		fs->inodesz = 128;
 	else
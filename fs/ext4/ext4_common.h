@@ -56,6 +56,14 @@ int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
 			struct ext2fs_node **foundnode, int expecttype);
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			struct ext2fs_node **fnode, int *ftype);
+int ext4fs_dir_find(struct ext2fs_node *dir, const char *name, int *ino,
+		    int *filetype);
+
+#if CONFIG_IS_ENABLED(EXT4_CACHE)
+void ext4fs_cache_flush(void);
+#else
+static inline void ext4fs_cache_flush(void) {}
+#endif
 
 #if defined(CONFIG_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n);
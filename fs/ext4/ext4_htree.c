@@ -0,0 +1,508 @@
+/*
+ * Directory lookup for ext4, using the hash tree index (dir_index) where
+ * the directory has one.
+ *
+ * The hash functions are taken from the Linux kernel, fs/ext4/hash.c:
+ * Copyright (C) 2002 by Theodore Ts'o
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <ext_common.h>
+#include <ext4fs.h>
+#include <malloc.h>
+#include "ext4_common.h"
+
+/* Hash versions, as stored in the superblock and the index root */
+#define DX_HASH_LEGACY			0
+#define DX_HASH_HALF_MD4		1
+#define DX_HASH_TEA			2
+#define DX_HASH_LEGACY_UNSIGNED		3
+#define DX_HASH_HALF_MD4_UNSIGNED	4
+#define DX_HASH_TEA_UNSIGNED		5
+
+/* Superblock flag: hashes are calculated with unsigned chars */
+#define EXT2_FLAGS_UNSIGNED_HASH	0x0002
+
+#define EXT4_HTREE_EOF_32BIT		0x7fffffff
+
+/* The most index levels below the root we are prepared to follow */
+#define DX_MAX_LEVELS			3
+
+/* Header of the index, found after the '.' and '..' entries in block 0 */
+struct dx_root_info {
+	__le32 reserved_zero;
+	u8 hash_version;
+	u8 info_length;		/* 8 */
+	u8 indirect_levels;
+	u8 unused_flags;
+};
+
+/*
+ * An index entry. The first entry of each index block holds a
+ * struct dx_countlimit in place of the hash.
+ */
+struct dx_entry {
+	__le32 hash;
+	__le32 block;
+};
+
+struct dx_countlimit {
+	__le16 limit;
+	__le16 count;
+};
+
+#define DELTA 0x9E3779B9
+
+static void TEA_transform(u32 buf[4], u32 const in[])
+{
+	u32 sum = 0;
+	u32 b0 = buf[0], b1 = buf[1];
+	u32 a = in[0], b = in[1], c = in[2], d = in[3];
+	int n = 16;
+
+	do {
+		sum += DELTA;
+		b0 += ((b1 << 4) + a) ^ (b1 + sum) ^ ((b1 >> 5) + b);
+		b1 += ((b0 << 4) + c) ^ (b0 + sum) ^ ((b0 >> 5) + d);
+	} while (--n);
+
+	buf[0] += b0;
+	buf[1] += b1;
+}
+
+/* F, G and H are basic MD4 functions: selection, majority, parity */
+#define F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define G(x, y, z) (((x) & (y)) + (((x) ^ (y)) & (z)))
+#define H(x, y, z) ((x) ^ (y) ^ (z))
+
+#define MD4_ROUND(f, a, b, c, d, x, s)	\
+	(a += f(b, c, d) + x, a = (a << s) | (a >> (32 - s)))
+#define K1 0
+#define K2 013240474631UL
+#define K3 015666365641UL
+
+/* Basic cut-down MD4 transform */
+static void half_md4_transform(u32 buf[4], u32 const in[8])
+{
+	u32 a = buf[0], b = buf[1], c = buf[2], d = buf[3];
+
+	/* Round 1 */
+	MD4_ROUND(F, a, b, c, d, in[0] + K1,  3);
+	MD4_ROUND(F, d, a, b, c, in[1] + K1,  7);
+	MD4_ROUND(F, c, d, a, b, in[2] + K1, 11);
+	MD4_ROUND(F, b, c, d, a, in[3] + K1, 19);
+	MD4_ROUND(F, a, b, c, d, in[4] + K1,  3);
+	MD4_ROUND(F, d, a, b, c, in[5] + K1,  7);
+	MD4_ROUND(F, c, d, a, b, in[6] + K1, 11);
+	MD4_ROUND(F, b, c, d, a, in[7] + K1, 19);
+
+	/* Round 2 */
+	MD4_ROUND(G, a, b, c, d, in[1] + K2,  3);
+	MD4_ROUND(G, d, a, b, c, in[3] + K2,  5);
+	MD4_ROUND(G, c, d, a, b, in[5] + K2,  9);
+	MD4_ROUND(G, b, c, d, a, in[7] + K2, 13);
+	MD4_ROUND(G, a, b, c, d, in[0] + K2,  3);
+	MD4_ROUND(G, d, a, b, c, in[2] + K2,  5);
+	MD4_ROUND(G, c, d, a, b, in[4] + K2,  9);
+	MD4_ROUND(G, b, c, d, a, in[6] + K2, 13);
+
+	/* Round 3 */
+	MD4_ROUND(H, a, b, c, d, in[3] + K3,  3);
+	MD4_ROUND(H, d, a, b, c, in[7] + K3,  9);
+	MD4_ROUND(H, c, d, a, b, in[2] + K3, 11);
+	MD4_ROUND(H, b, c, d, a, in[6] + K3, 15);
+	MD4_ROUND(H, a, b, c, d, in[1] + K3,  3);
+	MD4_ROUND(H, d, a, b, c, in[5] + K3,  9);
+	MD4_ROUND(H, c, d, a, b, in[0] + K3, 11);
+	MD4_ROUND(H, b, c, d, a, in[4] + K3, 15);
+
+	buf[0] += a;
+	buf[1] += b;
+	buf[2] += c;
+	buf[3] += d;
+}
+
+#undef MD4_ROUND
+#undef K1
+#undef K2
+#undef K3
+#undef F
+#undef G
+#undef H
+
+/* The old legacy hash */
+static u32 dx_hack_hash(const char *name, int len, bool unsigned_char)
+{
+	u32 hash, hash0 = 0x12a3fe2d, hash1 = 0x37abe8f9;
+	int c;
+
+	while (len--) {
+		c = unsigned_char ? (int)(unsigned char)*name :
+			(int)(signed char)*name;
+		name++;
+		hash = hash1 + (hash0 ^ (c * 7152373));
+
+		if (hash & 0x80000000)
+			hash -= 0x7fffffff;
+		hash1 = hash0;
+		hash0 = hash;
+	}
+
+	return hash0 << 1;
+}
+
+static void str2hashbuf(const char *msg, int len, u32 *buf, int num,
+			bool unsigned_char)
+{
+	u32 pad, val;
+	int i, c;
+
+	pad = (u32)len | ((u32)len << 8);
+	pad |= pad << 16;
+
+	val = pad;
+	if (len > num * 4)
+		len = num * 4;
+	for (i = 0; i < len; i++) {
+		c = unsigned_char ? (int)(unsigned char)msg[i] :
+			(int)(signed char)msg[i];
+		val = c + (val << 8);
+		if ((i % 4) == 3) {
+			*buf++ = val;
+			val = pad;
+			num--;
+		}
+	}
+	if (--num >= 0)
+		*buf++ = val;
+	while (--num >= 0)
+		*buf++ = pad;
+}
+
+/*
+ * Calculate the directory hash of a name, as used to place it in the
+ * index. Returns 0 on success, -1 for an unknown hash version.
+ */
+static int ext4fs_dirhash(const char *name, int len, int version,
+			  const __le32 *seed, u32 *hashp)
+{
+	bool unsigned_char = false;
+	u32 hash, in[8], buf[4];
+	int i;
+
+	/* Initialize the default seed for the hash checksum functions */
+	buf[0] = 0x67452301;
+	buf[1] = 0xefcdab89;
+	buf[2] = 0x98badcfe;
+	buf[3] = 0x10325476;
+
+	/* Use the filesystem's seed unless it is all zeroes */
+	for (i = 0; i < 4; i++) {
+		if (seed[i]) {
+			for (i = 0; i < 4; i++)
+				buf[i] = le32_to_cpu(seed[i]);
+			break;
+		}
+	}
+
+	switch (version) {
+	case DX_HASH_LEGACY_UNSIGNED:
+		unsigned_char = true;
+		/* fall through */
+	case DX_HASH_LEGACY:
+		hash = dx_hack_hash(name, len, unsigned_char);
+		break;
+	case DX_HASH_HALF_MD4_UNSIGNED:
+		unsigned_char = true;
+		/* fall through */
+	case DX_HASH_HALF_MD4:
+		for (; len > 0; len -= 32, name += 32) {
+			str2hashbuf(name, len, in, 8, unsigned_char);
+			half_md4_transform(buf, in);
+		}
+		hash = buf[1];
+		break;
+	case DX_HASH_TEA_UNSIGNED:
+		unsigned_char = true;
+		/* fall through */
+	case DX_HASH_TEA:
+		for (; len > 0; len -= 16, name += 16) {
+			str2hashbuf(name, len, in, 4, unsigned_char);
+			TEA_transform(buf, in);
+		}
+		hash = buf[0];
+		break;
+	default:
+		return -1;
+	}
+
+	hash &= ~1;
+	if (hash == (EXT4_HTREE_EOF_32BIT << 1))
+		hash = (EXT4_HTREE_EOF_32BIT - 1) << 1;
+	*hashp = hash;
+
+	return 0;
+}
+
+/* Read logical block 'blk' of a directory into 'buf' */
+static int ext4fs_dir_read_block(struct ext2fs_node *dir, u32 blk, char *buf)
+{
+	int blksz = EXT2_BLOCK_SIZE(dir->data);
+	loff_t actread;
+
+	if (ext4fs_read_file(dir, (loff_t)blk * blksz, blksz, buf,
+			     &actread) < 0 || actread != blksz)
+		return -EIO;
+
+	return 0;
+}
+
+/*
+ * Look for a name in a block of directory 'dir', already read into 'buf'.
+ * Returns 1 if found, 0 if not, -ve if the block is corrupt.
+ */
+static int ext4fs_dir_search_block(struct ext2fs_node *dir, const char *buf,
+				   const char *name, int len, int *ino,
+				   int *filetype)
+{
+	int blksz = EXT2_BLOCK_SIZE(dir->data);
+	const struct ext2_dirent *dirent;
+	int pos, direntlen;
+
+	for (pos = 0; pos < blksz; pos += direntlen) {
+		dirent = (const struct ext2_dirent *)(buf + pos);
+		direntlen = le16_to_cpu(dirent->direntlen);
+		if (direntlen < sizeof(*dirent) || pos + direntlen > blksz) {
+			printf("Failed to iterate over directory inode %d\n",
+			       dir->ino);
+			return -EINVAL;
+		}
+
+		if (dirent->inode && dirent->namelen == len &&
+		    !memcmp(name, dirent + 1, len)) {
+			*ino = le32_to_cpu(dirent->inode);
+			*filetype = dirent->filetype;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Find the index entry covering 'hash' in an index block */
+static const struct dx_entry *dx_search(const struct dx_entry *entries,
+					int count, u32 hash)
+{
+	const struct dx_entry *p = entries + 1, *q = entries + count - 1;
+	const struct dx_entry *m;
+
+	while (p <= q) {
+		m = p + (q - p) / 2;
+		if (le32_to_cpu(m->hash) > hash)
+			q = m - 1;
+		else
+			p = m + 1;
+	}
+
+	return p - 1;
+}
+
+static u32 dx_get_block(const struct dx_entry *entry)
+{
+	return le32_to_cpu(entry->block) & 0x0fffffff;
+}
+
+/*
+ * One level of the path from the index root down to a leaf
+ *
+ * @buf:	Index block, or NULL if not read yet
+ * @entries:	Index entries within @buf
+ * @at:		Entry followed to the next level
+ * @count:	Number of entries
+ */
+struct dx_frame {
+	char *buf;
+	const struct dx_entry *entries;
+	const struct dx_entry *at;
+	int count;
+};
+
+/* Check the entries of an index block and set them up in 'frame' */
+static int dx_set_entries(struct dx_frame *frame, int blksz,
+			  const struct dx_entry *entries)
+{
+	const struct dx_countlimit *cl = (const struct dx_countlimit *)entries;
+	int count = le16_to_cpu(cl->count);
+
+	if (!count || count > le16_to_cpu(cl->limit) ||
+	    (char *)(entries + count) > frame->buf + blksz)
+		return -EAGAIN;
+	frame->entries = entries;
+	frame->count = count;
+
+	return 0;
+}
+
+/*
+ * Move on to the next leaf, for names with the same hash which have spilled
+ * over from the current one. The next leaf is marked by bit 0 of its hash.
+ * Like the Linux ext4_htree_next_block(), this walks up the path as far as
+ * needed to find the next entry, which may be in another index block, and
+ * then back down to the leaf.
+ * Returns 1 if there is such a leaf, 0 if not, -ve on error.
+ */
+static int dx_next_leaf(struct ext2fs_node *dir, struct dx_frame *frames,
+			struct dx_frame *frame, u32 hash)
+{
+	int blksz = EXT2_BLOCK_SIZE(dir->data);
+	struct dx_frame *p = frame;
+	int ret;
+
+	while (1) {
+		p->at++;
+		if (p->at < p->entries + p->count)
+			break;
+		if (p == frames)
+			return 0;
+		p--;
+	}
+	if ((le32_to_cpu(p->at->hash) & ~1) != hash)
+		return 0;
+
+	/* Index nodes start with an empty entry covering the block */
+	while (p < frame) {
+		ret = ext4fs_dir_read_block(dir, dx_get_block(p->at),
+					    p[1].buf);
+		if (ret)
+			return ret;
+		p++;
+		ret = dx_set_entries(p, blksz,
+				     (const struct dx_entry *)(p->buf + 8));
+		if (ret)
+			return ret;
+		p->at = p->entries;
+	}
+
+	return 1;
+}
+
+/*
+ * Look up a name using the directory's hash index.
+ * Returns 1 if found, 0 if not, -EAGAIN if the index cannot be used.
+ */
+static int ext4fs_dx_find(struct ext2fs_node *dir, char *buf,
+			  const char *name, int len, int *ino, int *filetype)
+{
+	struct ext2_sblock *sblock = &dir->data->sblock;
+	int blksz = EXT2_BLOCK_SIZE(dir->data);
+	struct dx_frame frames[DX_MAX_LEVELS], *frame;
+	const struct dx_root_info *info;
+	const struct dx_entry *entries;
+	int level, levels, version, ret;
+	u32 hash;
+
+	memset(frames, '\0', sizeof(frames));
+	frame = frames;
+	frame->buf = malloc(blksz);
+	if (!frame->buf)
+		return -ENOMEM;
+	ret = ext4fs_dir_read_block(dir, 0, frame->buf);
+	if (ret)
+		goto out;
+
+	/* The index follows the '.' and '..' entries, 12 bytes each */
+	ret = -EAGAIN;
+	info = (const struct dx_root_info *)(frame->buf + 24);
+	if (info->reserved_zero || info->info_length < 8 ||
+	    info->unused_flags & 1)
+		goto out;
+	levels = info->indirect_levels;
+	if (levels >= DX_MAX_LEVELS)
+		goto out;
+
+	version = info->hash_version;
+	if (version <= DX_HASH_TEA &&
+	    (le32_to_cpu(sblock->flags) & EXT2_FLAGS_UNSIGNED_HASH))
+		version += 3;
+	if (ext4fs_dirhash(name, len, version, sblock->hash_seed, &hash))
+		goto out;
+
+	entries = (const struct dx_entry *)((char *)info + info->info_length);
+	for (level = 0; ; level++, frame++) {
+		ret = dx_set_entries(frame, blksz, entries);
+		if (ret)
+			goto out;
+		frame->at = dx_search(frame->entries, frame->count, hash);
+		if (level == levels)
+			break;
+
+		/* Index nodes start with an empty entry covering the block */
+		frame[1].buf = malloc(blksz);
+		if (!frame[1].buf) {
+			ret = -ENOMEM;
+			goto out;
+		}
+		ret = ext4fs_dir_read_block(dir, dx_get_block(frame->at),
+					    frame[1].buf);
+		if (ret)
+			goto out;
+		entries = (const struct dx_entry *)(frame[1].buf + 8);
+	}
+
+	/* Search the leaf, then any leaves that names with its hash spill into */
+	do {
+		ret = ext4fs_dir_read_block(dir, dx_get_block(frame->at), buf);
+		if (ret)
+			break;
+		ret = ext4fs_dir_search_block(dir, buf, name, len, ino,
+					      filetype);
+		if (ret)
+			break;
+		ret = dx_next_leaf(dir, frames, frame, hash);
+	} while (ret > 0);
+out:
+	for (level = 0; level < DX_MAX_LEVELS; level++)
+		free(frames[level].buf);
+
+	return ret;
+}
+
+int ext4fs_dir_find(struct ext2fs_node *dir, const char *name, int *ino,
+		    int *filetype)
+{
+	struct ext2_sblock *sblock = &dir->data->sblock;
+	int blksz = EXT2_BLOCK_SIZE(dir->data);
+	int len = strlen(name);
+	u32 blk, blocks;
+	char *buf;
+	int ret;
+
+	buf = zalloc(blksz);
+	if (!buf)
+		return -ENOMEM;
+
+	if ((le32_to_cpu(dir->inode.flags) & EXT4_INDEX_FL) &&
+	    (le32_to_cpu(sblock->feature_compatibility) &
+	     EXT4_FEATURE_COMPAT_DIR_INDEX)) {
+		ret = ext4fs_dx_find(dir, buf, name, len, ino, filetype);
+		if (ret != -EAGAIN)
+			goto out;
+		debug("%s: falling back to a linear search\n", __func__);
+	}
+
+	/* Search every block of the directory */
+	ret = 0;
+	blocks = DIV_ROUND_UP(le32_to_cpu(dir->inode.size), blksz);
+	for (blk = 0; blk < blocks && !ret; blk++) {
+		ret = ext4fs_dir_read_block(dir, blk, buf);
+		if (!ret)
+			ret = ext4fs_dir_search_block(dir, buf, name, len,
+						      ino, filetype);
+	}
+out:
+	free(buf);
+
+	return ret;
+}
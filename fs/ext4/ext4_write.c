@@ -588,6 +588,8 @@ int ext4fs_init(void)
 	unsigned int real_free_blocks = 0;
 	struct ext_filesystem *fs = get_fs();
 
+	ext4fs_cache_flush();
+
 	/* populate fs */
 	fs->blksz = EXT2_BLOCK_SIZE(ext4fs_root);
 	fs->inodesz = INODE_SIZE_FILESYSTEM(ext4fs_root);
@@ -706,6 +708,7 @@ void ext4fs_deinit(void)
 		 (struct ext2_sblock *)fs->sb, (uint32_t)SUPERBLOCK_SIZE);
 	free(fs->sb);
 	fs->sb = NULL;
+	ext4fs_cache_flush();
 
 	if (fs->blk_bmaps) {
 		for (i = 0; i < fs->no_blkgrp; i++) {
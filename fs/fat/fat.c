@@ -41,6 +41,77 @@ static void downcase(char *str)
 static struct blk_desc *cur_dev;
 static disk_partition_t cur_part_info;
 
+/* The file opened by fat_open(), read with fat_read_open() */
+static fsdata open_data;
+static dir_entry open_dent;
+static bool open_valid;
+
+#if CONFIG_IS_ENABLED(FAT_EXTENT_CACHE)
+/* A run of contiguous clusters within a file */
+struct fat_extent {
+	__u32 clust;		/* First cluster of the run */
+	__u32 count;		/* Number of clusters in the run */
+};
+
+/* The cluster chain of a file, held as a list of extents */
+struct fat_chain {
+	__u32 start;		/* First cluster of the file, 0 if unused */
+	__u32 size;		/* File size in bytes */
+	bool complete;		/* Chain covers the whole file */
+	int count;		/* Number of extents */
+	int max;		/* Number of extents allocated */
+	struct fat_extent *ext;
+	ulong last_used;	/* For LRU replacement */
+};
+
+#define FAT_CHAIN_CACHE_FILES	8
+
+/*
+ * The volume these caches belong to. They are kept across commands and
+ * dropped when a different device, partition or boot sector is seen, or the
+ * filesystem is written to. Unlike the ext4 superblock, the boot sector does
+ * not change when files are written, so changes made to the media by other
+ * means (ums, dfu, 'mmc write', ...) without a FAT write are not seen.
+ */
+static struct blk_desc *cache_dev;
+static lbaint_t cache_part_start;
+static __u8 *cache_boot_block;
+static struct fat_chain fat_chain_cache[FAT_CHAIN_CACHE_FILES];
+static ulong fat_chain_seq;
+
+static void fat_cache_flush(void)
+{
+	int i;
+
+	for (i = 0; i < FAT_CHAIN_CACHE_FILES; i++) {
+		free(fat_chain_cache[i].ext);
+		memset(&fat_chain_cache[i], '\0', sizeof(fat_chain_cache[i]));
+	}
+	free(cache_boot_block);
+	cache_boot_block = NULL;
+	cache_dev = NULL;
+}
+
+/* Drop the caches unless @boot_block shows the volume is unchanged */
+static void fat_cache_check(const __u8 *boot_block)
+{
+	if (cache_dev == cur_dev && cache_part_start == cur_part_info.start &&
+	    !memcmp(cache_boot_block, boot_block, cur_dev->blksz))
+		return;
+
+	fat_cache_flush();
+	cache_boot_block = malloc(cur_dev->blksz);
+	if (!cache_boot_block)
+		return;
+	memcpy(cache_boot_block, boot_block, cur_dev->blksz);
+	cache_dev = cur_dev;
+	cache_part_start = cur_part_info.start;
+}
+#else
+static inline void fat_cache_flush(void) {}
+static inline void fat_cache_check(const __u8 *boot_block) {}
+#endif
+
 #define DOS_BOOT_MAGIC_OFFSET	0x1fe
 #define DOS_FS_TYPE_OFFSET	0x36
 #define DOS_FS32_TYPE_OFFSET	0x52
@@ -64,6 +135,7 @@ int fat_set_blk_dev(struct blk_desc *dev_desc, disk_partition_t *info)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, buffer, dev_desc->blksz);
 
+	fat_close();
 	cur_dev = dev_desc;
 	cur_part_info = *info;
 
@@ -80,10 +152,11 @@ int fat_set_blk_dev(struct blk_desc *dev_desc, disk_partition_t *info)
 	}
 
 	/* Check for FAT12/FAT16/FAT32 filesystem */
-	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3))
-		return 0;
-	if (!memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5))
+	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3) ||
+	    !memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5)) {
+		fat_cache_check(buffer);
 		return 0;
+	}
 
 	cur_dev = NULL;
 	return -1;
@@ -330,6 +403,158 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 __u8 get_contents_vfatname_block[MAX_CLUSTSIZE]
 	__aligned(ARCH_DMA_MINALIGN);
 
+#if CONFIG_IS_ENABLED(FAT_EXTENT_CACHE)
+/*
+ * Follow the cluster chain of a file, recording it as a list of extents.
+ * Return 0 on success, -1 if out of memory or the chain ends early at an
+ * invalid FAT entry. The caller then reads the file without the cache, as
+ * it did before the cache was added.
+ */
+static int build_chain(fsdata *mydata, struct fat_chain *chain)
+{
+	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
+	__u32 nclust = DIV_ROUND_UP(chain->size, bytesperclust);
+	__u32 clust = chain->start;
+	__u32 n;
+
+	for (n = 0; n < nclust; n++) {
+		struct fat_extent *ext;
+
+		if (n) {
+			clust = get_fatent(mydata, clust);
+			if (CHECK_CLUST(clust, mydata->fatsize)) {
+				debug("curclust: 0x%x\n", clust);
+				debug("Invalid FAT entry\n");
+				return -1;
+			}
+		}
+
+		if (chain->count) {
+			ext = &chain->ext[chain->count - 1];
+			if (ext->clust + ext->count == clust) {
+				ext->count++;
+				continue;
+			}
+		}
+		if (chain->count == chain->max) {
+			int max = chain->max ? chain->max * 2 : 16;
+
+			ext = realloc(chain->ext, max * sizeof(*ext));
+			if (!ext)
+				return -1;
+			chain->ext = ext;
+			chain->max = max;
+		}
+		ext = &chain->ext[chain->count++];
+		ext->clust = clust;
+		ext->count = 1;
+	}
+	chain->complete = true;
+	debug("FAT: file at cluster %u has %d extent(s)\n", chain->start,
+	      chain->count);
+
+	return 0;
+}
+
+/*
+ * Find the cluster chain of a file in the cache, building it if needed.
+ * Return NULL if the chain cannot be used.
+ */
+static struct fat_chain *get_chain(fsdata *mydata, __u32 start, __u32 size)
+{
+	struct fat_chain *chain, *victim = NULL;
+	int i;
+
+	/* Leave broken start clusters to get_contents() */
+	if (!cache_dev || CHECK_CLUST(start, mydata->fatsize))
+		return NULL;
+
+	for (i = 0; i < FAT_CHAIN_CACHE_FILES; i++) {
+		chain = &fat_chain_cache[i];
+		if (chain->start == start && chain->size == size &&
+		    chain->complete) {
+			chain->last_used = ++fat_chain_seq;
+			return chain;
+		}
+		if (!victim || chain->last_used < victim->last_used)
+			victim = chain;
+	}
+
+	chain = victim;
+	chain->start = start;
+	chain->size = size;
+	chain->complete = false;
+	chain->count = 0;
+	chain->last_used = ++fat_chain_seq;
+	if (build_chain(mydata, chain)) {
+		chain->start = 0;
+		return NULL;
+	}
+
+	return chain;
+}
+
+/*
+ * Read at most 'maxsize' bytes from 'pos' in a file, with one disk read for
+ * each run of contiguous clusters.
+ */
+static int get_contents_chain(fsdata *mydata, struct fat_chain *chain,
+			      loff_t pos, __u8 *buffer, loff_t maxsize,
+			      loff_t *gotsize)
+{
+	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
+	loff_t filesize = chain->size;
+	loff_t ext_pos = 0, ext_end;
+	loff_t clust_pos, actsize;
+	__u32 clust;
+	int i;
+
+	if (maxsize > 0 && filesize > pos + maxsize)
+		filesize = pos + maxsize;
+
+	for (i = 0; i < chain->count && pos < filesize; i++, ext_pos = ext_end) {
+		ext_end = ext_pos + (loff_t)chain->ext[i].count * bytesperclust;
+		if (pos >= ext_end)
+			continue;
+
+		/* Find the cluster containing pos */
+		clust = chain->ext[i].clust + (pos - ext_pos) / bytesperclust;
+		clust_pos = pos - (pos - ext_pos) % bytesperclust;
+
+		/* Read up to the start of the next cluster if not aligned */
+		if (pos > clust_pos) {
+			actsize = min(filesize - clust_pos, (loff_t)bytesperclust);
+			if (get_cluster(mydata, clust, get_contents_vfatname_block,
+					actsize) != 0) {
+				printf("Error reading cluster\n");
+				return -1;
+			}
+			actsize -= pos - clust_pos;
+			memcpy(buffer, get_contents_vfatname_block +
+			       (pos - clust_pos), actsize);
+			*gotsize += actsize;
+			buffer += actsize;
+			pos += actsize;
+			clust++;
+			if (pos >= filesize || pos >= ext_end)
+				continue;
+		}
+
+		/* Then the rest of the extent in one go */
+		actsize = min(filesize, ext_end) - pos;
+		if (get_cluster(mydata, clust, buffer, actsize) != 0) {
+			printf("Error reading cluster\n");
+			return -1;
+		}
+		*gotsize += actsize;
+		buffer += actsize;
+		pos += actsize;
+	}
+
+	return 0;
+}
+#endif /* FAT_EXTENT_CACHE */
+
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
 {
@@ -338,6 +563,9 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 	__u32 curclust = START(dentptr);
 	__u32 endclust, newclust;
 	loff_t actsize;
+#if CONFIG_IS_ENABLED(FAT_EXTENT_CACHE)
+	struct fat_chain *chain;
+#endif
 
 	*gotsize = 0;
 	debug("Filesize: %llu bytes\n", filesize);
@@ -347,6 +575,13 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 		return 0;
 	}
 
+#if CONFIG_IS_ENABLED(FAT_EXTENT_CACHE)
+	chain = get_chain(mydata, curclust, filesize);
+	if (chain)
+		return get_contents_chain(mydata, chain, pos, buffer, maxsize,
+					  gotsize);
+#endif
+
 	if (maxsize > 0 && filesize > pos + maxsize)
 		filesize = pos + maxsize;
 
@@ -740,6 +975,20 @@ static dir_entry *get_dentfromdir(fsdata *mydata, int startsect,
 	return NULL;
 }
 
+/*
+ * Read the boot sector, using the cached copy if there is one
+ */
+static int read_boot_block(__u8 *block)
+{
+#if CONFIG_IS_ENABLED(FAT_EXTENT_CACHE)
+	if (cache_dev && cache_dev == cur_dev) {
+		memcpy(block, cache_boot_block, cur_dev->blksz);
+		return 1;
+	}
+#endif
+	return disk_read(0, 1, block);
+}
+
 /*
  * Read boot sector and volume info from a FAT filesystem
  */
@@ -761,7 +1010,7 @@ read_bootsectandvi(boot_sector *bs, volume_info *volinfo, int *fatsize)
 		return -1;
 	}
 
-	if (disk_read(0, 1, block) < 0) {
+	if (read_boot_block(block) < 0) {
 		debug("Error: reading block\n");
 		goto fail;
 	}
@@ -1224,6 +1473,13 @@ rootdir_done:
 	if (dogetsize) {
 		*size = FAT2CPU32(dentptr->size);
 		ret = 0;
+		if (dogetsize == FAT_GETSIZE_OPEN) {
+			/* Keep the FAT buffer for fat_read_open() */
+			open_data = *mydata;
+			open_dent = *dentptr;
+			open_valid = true;
+			mydata->fatbuf = NULL;
+		}
 	} else {
 		ret = get_contents(mydata, dentptr, pos, buffer, maxsize, size);
 	}
@@ -1355,6 +1611,26 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	return ret;
 }
 
+int fat_open(const char *filename, loff_t *size)
+{
+	fat_close();
+
+	return do_fat_read_at(filename, 0, NULL, 0, LS_NO, FAT_GETSIZE_OPEN,
+			      size);
+}
+
+int fat_read_open(void *buf, loff_t offset, loff_t len, loff_t *actread)
+{
+	if (!open_valid)
+		return -1;
+
+	return get_contents(&open_data, &open_dent, offset, buf, len, actread);
+}
+
 void fat_close(void)
 {
+	if (open_valid) {
+		free(open_data.fatbuf);
+		open_valid = false;
+	}
 }
@@ -972,6 +972,9 @@ static int do_fat_write(const char *filename, void *buffer, loff_t size,
 	int ret = -1, name_len;
 	char l_filename[VFAT_MAXLEN_BYTES];
 
+	/* Cached cluster chains will no longer be valid */
+	fat_cache_flush();
+
 	*actwrite = size;
 	dir_curclust = 0;
 
@@ -7,6 +7,7 @@
 #include <config.h>
 #include <errno.h>
 #include <common.h>
+#include <bootm.h>
 #include <mapmem.h>
 #include <part.h>
 #include <ext4fs.h>
@@ -90,6 +91,13 @@ struct fstype_info {
 		    loff_t len, loff_t *actread);
 	int (*write)(const char *filename, void *buf, loff_t offset,
 		     loff_t len, loff_t *actwrite);
+	/*
+	 * Optional: open a file once and then read parts of it without
+	 * looking it up again. The file stays open until close() is called.
+	 */
+	int (*open)(const char *filename, loff_t *size);
+	int (*read_open)(void *buf, loff_t offset, loff_t len,
+			 loff_t *actread);
 	void (*close)(void);
 	int (*uuid)(char *uuid_str);
 };
@@ -111,6 +119,8 @@ static struct fstype_info fstypes[] = {
 #else
 		.write = fs_write_unsupported,
 #endif
+		.open = fat_open,
+		.read_open = fat_read_open,
 		.uuid = fs_uuid_unsupported,
 	},
 #endif
@@ -130,6 +140,8 @@ static struct fstype_info fstypes[] = {
 #else
 		.write = fs_write_unsupported,
 #endif
+		.open = ext4fs_size,
+		.read_open = ext4fs_read,
 		.uuid = ext4fs_uuid,
 	},
 #endif
@@ -353,6 +365,98 @@ int do_size(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	return 0;
 }
 
+#ifdef CONFIG_CMD_BOOTM
+/**
+ * struct fs_stream - State for reading a file in chunks for decompression
+ *
+ * The filesystem stays open while the file is streamed, so that it is not
+ * probed again for every chunk. Where the filesystem supports it, the file is
+ * opened once too, so that its path is not looked up for every chunk.
+ *
+ * @info:	Filesystem to read from
+ * @filename:	File to read, or NULL if it has been opened
+ * @pos:	Next file position to read from
+ * @size:	Size of the file
+ */
+struct fs_stream {
+	struct fstype_info *info;
+	const char *filename;
+	loff_t pos;
+	loff_t size;
+};
+
+static int fs_stream_read(void *priv, void *buf, ulong size)
+{
+	struct fs_stream *stream = priv;
+	loff_t actread;
+	int ret;
+
+	if (stream->pos >= stream->size)
+		return 0;
+	if (size > stream->size - stream->pos)
+		size = stream->size - stream->pos;
+
+	if (stream->filename)
+		ret = stream->info->read(stream->filename, buf, stream->pos,
+					 size, &actread);
+	else
+		ret = stream->info->read_open(buf, stream->pos, size,
+					      &actread);
+	if (ret < 0)
+		return -EIO;
+	stream->pos += actread;
+
+	return actread;
+}
+
+/**
+ * fs_load_decomp() - Load a compressed file, decompressing as it is read
+ *
+ * The filesystem must have been set up with fs_set_blk_dev(). It is closed
+ * once the file has been read.
+ *
+ * @filename:	File to read
+ * @pos:	Position in the file to start reading from
+ * @comp:	Compression type (IH_COMP_...)
+ * @addr:	Address to decompress to
+ * @max_len:	Maximum number of decompressed bytes
+ * @lenp:	Returns number of decompressed bytes
+ * @return 0 if OK, -ve on error
+ */
+static int fs_load_decomp(const char *filename, loff_t pos, int comp,
+			  ulong addr, ulong max_len, loff_t *lenp)
+{
+	struct fs_stream stream = {
+		.info = fs_get_info(fs_type),
+		.filename = filename,
+		.pos = pos,
+	};
+	ulong load_end;
+	void *buf;
+	int ret;
+
+	if (stream.info->open) {
+		ret = stream.info->open(filename, &stream.size);
+		stream.filename = NULL;
+	} else {
+		ret = stream.info->size(filename, &stream.size);
+	}
+	if (ret)
+		goto out;
+
+	buf = map_sysmem(addr, max_len);
+	ret = bootm_decomp_stream(comp, addr, IH_TYPE_KERNEL, buf, max_len,
+				  fs_stream_read, &stream, &load_end);
+	unmap_sysmem(buf);
+	if (!ret)
+		*lenp = load_end - addr;
+out:
+	fs_close();
+
+	return ret;
+}
+#endif
+
 int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype)
 {
@@ -364,8 +468,18 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	loff_t len_read;
 	int ret;
 	unsigned long time;
+	int comp = -1;
 	char *ep;
 
+#ifdef CONFIG_CMD_BOOTM
+	if (argc >= 3 && !strcmp(argv[1], "-z")) {
+		comp = genimg_get_comp_id(argv[2]);
+		if (comp < 0)
+			return CMD_RET_USAGE;
+		argc -= 2;
+		argv += 2;
+	}
+#endif
 	if (argc < 2)
 		return CMD_RET_USAGE;
 	if (argc > 7)
@@ -404,7 +518,15 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		pos = 0;
 
 	time = get_timer(0);
-	ret = fs_read(filename, addr, pos, bytes, &len_read);
+#ifdef CONFIG_CMD_BOOTM
+	if (comp >= 0) {
+		/* With -z, 'bytes' limits the decompressed size */
+		ret = fs_load_decomp(filename, pos, comp, addr,
+				     bytes ? bytes : CONFIG_SYS_BOOTM_LEN,
+				     &len_read);
+	} else
+#endif
+		ret = fs_read(filename, addr, pos, bytes, &len_read);
 	time = get_timer(time);
 	if (ret < 0)
 		return 1;
@@ -0,0 +1,94 @@
+/*
+ * Arena allocator for short-lived allocations
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+struct arena_block;
+
+/**
+ * struct arena - a pool of memory which is freed all at once
+ *
+ * Allocations are carved off the end of the current block, so they are
+ * cheap and carry no header, but they cannot be freed one at a time.
+ * arena_reset() makes all of the memory available again while keeping the
+ * blocks, and arena_destroy() hands the blocks back to malloc().
+ *
+ * Blocks come from malloc(), so an arena can be used before relocation as
+ * well as after. Since free() does nothing before relocation, resetting an
+ * arena is the only way to reuse memory there.
+ *
+ * @first:	First block, or NULL if none
+ * @cur:	Block that allocations come from
+ * @used:	Number of bytes used in @cur
+ * @block_size:	Size of each new block, unless an allocation needs more
+ */
+struct arena {
+	struct arena_block *first;
+	struct arena_block *cur;
+	size_t used;
+	size_t block_size;
+};
+
+/**
+ * Create a new arena
+ *
+ * No memory is allocated for blocks until the first arena_alloc().
+ *
+ * @param block_size	Size of each block to allocate with malloc()
+ * @return new arena, or NULL if out of memory
+ */
+struct arena *arena_create(size_t block_size);
+
+/**
+ * Allocate memory from an arena
+ *
+ * The memory is aligned as for malloc() and is not cleared.
+ *
+ * @param arena		Arena to allocate from
+ * @param size		Number of bytes required
+ * @return pointer to the memory, or NULL if out of memory
+ */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/**
+ * Allocate zeroed memory from an arena
+ *
+ * @param arena		Arena to allocate from
+ * @param size		Number of bytes required
+ * @return pointer to the memory, or NULL if out of memory
+ */
+void *arena_zalloc(struct arena *arena, size_t size);
+
+/**
+ * Check whether memory was allocated from an arena
+ *
+ * This lets code which holds a mixture of arena and malloc() pointers
+ * decide which ones to free().
+ *
+ * @param arena		Arena to check, or NULL for none
+ * @param ptr		Pointer to check
+ * @return true if @ptr is within one of the arena's blocks
+ */
+bool arena_contains(struct arena *arena, const void *ptr);
+
+/**
+ * Free everything allocated from an arena
+ *
+ * The blocks are kept so that later allocations do not need malloc().
+ *
+ * @param arena		Arena to reset
+ */
+void arena_reset(struct arena *arena);
+
+/**
+ * Free an arena and all of its blocks
+ *
+ * @param arena		Arena to destroy, or NULL to do nothing
+ */
+void arena_destroy(struct arena *arena);
+
+#endif
@@ -54,6 +54,7 @@ typedef struct global_data {
 	unsigned long ram_top;	/* Top address of RAM used by U-Boot */
 
 	unsigned long relocaddr;	/* Start address of U-Boot in RAM */
+	unsigned long malloc_start;	/* Start of the full malloc() area */
 	phys_size_t ram_size;	/* RAM size */
 #ifdef CONFIG_SYS_MEM_RESERVE_SECURE
 #define MEM_RESERVE_SECURE_SECURED	0x1
@@ -79,6 +80,9 @@ typedef struct global_data {
 	struct udevice	*dm_root;	/* Root instance for Driver Model */
 	struct udevice	*dm_root_f;	/* Pre-relocation root instance */
 	struct list_head uclass_root;	/* Head of core tree */
+#ifdef CONFIG_DM_LIST_INDEX
+	struct dm_list_index *dm_list_index;	/* Driver lookup index */
+#endif
 #endif
 #ifdef CONFIG_TIMER
 	struct udevice	*timer;	/* Timer instance for Driver Model */
@@ -92,6 +96,9 @@ typedef struct global_data {
 #ifdef CONFIG_TRACE
 	void		*trace_buff;	/* The trace buffer */
 #endif
+#ifdef CONFIG_PROFILER
+	void		*profile_buff;	/* The profiler sample buffer */
+#endif
 #if defined(CONFIG_SYS_I2C)
 	int		cur_i2c_bus;	/* current used i2c bus */
 #endif
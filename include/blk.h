@@ -142,6 +142,123 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt);
 
+/**
+ * struct block_cache_stats - Block cache settings and counters
+ *
+ * @hits:		Number of reads served from the cache
+ * @misses:		Number of cacheable reads passed to the device
+ * @readahead:		Number of blocks read ahead of a request
+ * @entries:		Number of entries in the cache
+ * @max_blocks_per_entry: Largest read (in blocks) which is cached
+ * @max_entries:	Maximum number of entries in the cache
+ * @readahead_blocks:	Size (in blocks) of a sequential read once it is
+ *			extended by readahead
+ */
+struct block_cache_stats {
+	unsigned hits;
+	unsigned misses;
+	unsigned readahead;
+	unsigned entries;
+	unsigned max_blocks_per_entry;
+	unsigned max_entries;
+	unsigned readahead_blocks;
+};
+
+#ifdef CONFIG_BLOCK_CACHE
+/**
+ * blkcache_read() - Read blocks from the block cache
+ *
+ * @desc:	Block device to read from
+ * @start:	Start block number
+ * @blkcnt:	Number of blocks to read
+ * @buffer:	Destination buffer
+ * @return 1 if the blocks were found in the cache and copied, else 0
+ */
+int blkcache_read(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
+		  void *buffer);
+
+/**
+ * blkcache_readahead() - Decide how many blocks to read for a cache miss
+ *
+ * A small read which follows on from the previous read of the same device
+ * is extended so that the following reads can be served from the cache.
+ *
+ * @desc:	Block device to read from
+ * @start:	Start block number
+ * @blkcnt:	Number of blocks requested
+ * @return number of blocks to read from @start, at least @blkcnt
+ */
+lbaint_t blkcache_readahead(struct blk_desc *desc, lbaint_t start,
+			    lbaint_t blkcnt);
+
+/**
+ * blkcache_readahead_done() - Count blocks which have been read ahead
+ *
+ * This is called once a read extended by blkcache_readahead() succeeds.
+ *
+ * @blkcnt:	Number of blocks read beyond those requested
+ */
+void blkcache_readahead_done(lbaint_t blkcnt);
+
+/**
+ * blkcache_fill() - Add blocks read from a device to the cache
+ *
+ * @desc:	Block device the blocks were read from
+ * @start:	Start block number
+ * @blkcnt:	Number of blocks read
+ * @buffer:	Data read
+ */
+void blkcache_fill(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
+		   const void *buffer);
+
+/**
+ * blkcache_invalidate() - Drop cached blocks for a device
+ *
+ * This must be called whenever a device is written or goes away.
+ *
+ * @desc:	Block device to drop, or NULL to empty the whole cache
+ */
+void blkcache_invalidate(struct blk_desc *desc);
+
+/**
+ * blkcache_configure() - Set the cache size and reset the counters
+ *
+ * This empties the cache.
+ *
+ * @blocks:	Largest read (in blocks) which is cached
+ * @entries:	Maximum number of entries, 0 to disable the cache
+ * @readahead:	Size (in blocks) of a sequential read with readahead
+ */
+void blkcache_configure(unsigned blocks, unsigned entries,
+			unsigned readahead);
+
+/**
+ * blkcache_stats() - Get the current settings and counters
+ *
+ * @stats:	Returns the settings and counters
+ */
+void blkcache_stats(struct block_cache_stats *stats);
+#else
+static inline int blkcache_read(struct blk_desc *desc, lbaint_t start,
+				lbaint_t blkcnt, void *buffer)
+{
+	return 0;
+}
+
+static inline lbaint_t blkcache_readahead(struct blk_desc *desc,
+					  lbaint_t start, lbaint_t blkcnt)
+{
+	return blkcnt;
+}
+
+static inline void blkcache_readahead_done(lbaint_t blkcnt) {}
+
+static inline void blkcache_fill(struct blk_desc *desc, lbaint_t start,
+				 lbaint_t blkcnt, const void *buffer) {}
+
+static inline void blkcache_invalidate(struct blk_desc *desc) {}
+#endif
+
 /**
  * blk_get_device() - Find and probe a block device ready for use
  *
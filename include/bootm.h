@@ -48,6 +48,11 @@ int boot_selected_os(int argc, char * const argv[], int state,
 
 ulong bootm_disable_interrupts(void);
 
+#ifndef CONFIG_SYS_BOOTM_LEN
+/* use 8MByte as default max gunzip size */
+#define CONFIG_SYS_BOOTM_LEN	0x800000
+#endif
+
 /* This is a special function used by booti/bootz */
 int bootm_find_images(int flag, int argc, char * const argv[]);
 
@@ -73,4 +78,28 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 		       void *load_buf, void *image_buf, ulong image_len,
 		       uint unc_len, ulong *load_end);
 
+#ifndef USE_HOSTCC
+/**
+ * bootm_decomp_stream() - decompress an image while it is being read
+ *
+ * This is like bootm_decomp_image() except that the compressed data is
+ * pulled in chunks from @read, typically straight from a filesystem or
+ * block device, so that reading and decompression are interleaved and the
+ * compressed image never needs to be held in memory as a whole.
+ *
+ * @comp:	Compression algorithm that is used (IH_COMP_...)
+ * @load:	Destination load address in U-Boot memory
+ * @type:	OS type (IH_OS_...)
+ * @load_buf:	Place to decompress to
+ * @unc_len:	Available space for decompression
+ * @read:	Function to call to read the compressed data
+ * @priv:	Private data to pass to @read
+ * @load_end:	Returns the end address of the decompressed data
+ * @return 0 if OK, -ve on error (BOOTM_ERR_...)
+ */
+int bootm_decomp_stream(int comp, ulong load, int type, void *load_buf,
+			uint unc_len, decomp_read_func read, void *priv,
+			ulong *load_end);
+#endif
+
 #endif
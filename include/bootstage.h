@@ -20,6 +20,7 @@
 enum bootstage_flags {
 	BOOTSTAGEF_ERROR	= 1 << 0,	/* Error record */
 	BOOTSTAGEF_ALLOC	= 1 << 1,	/* Allocate an id */
+	BOOTSTAGEF_INITCALL	= 1 << 2,	/* Time taken by an initcall */
 };
 
 /* bootstate sub-IDs used for kernel and ramdisk ranges */
@@ -198,6 +199,8 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_SCSI,
 	BOOTSTAGE_ID_ACCUM_SPI,
 	BOOTSTAGE_ID_ACCUM_DECOMP,
+	BOOTSTAGE_ID_ACCUM_LZ4,
+	BOOTSTAGE_ID_ACCUM_LZ4_CPU,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -298,9 +301,73 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name);
  */
 uint32_t bootstage_accum(enum bootstage_id id);
 
+/**
+ * Add a measured duration to a bootstage accumulator
+ *
+ * This is useful for time which was not spent on the boot CPU, such as
+ * work done by secondary CPUs, so cannot be measured with bootstage_start()
+ * and bootstage_accum().
+ *
+ * @param id	Bootstage id to add the time to
+ * @param name	Textual name to display for this id in the report (maybe NULL)
+ * @param time_us	Time to add, in microseconds
+ * @return total time now recorded in this accumulator
+ */
+uint32_t bootstage_accum_time(enum bootstage_id id, const char *name,
+			      uint32_t time_us);
+
+/**
+ * Check whether initcalls can be timed yet
+ *
+ * The timer may not work until the board_init_f bootstage mark has been
+ * recorded, so initcalls before that are not timed.
+ *
+ * @return true if bootstage_initcall() may be used
+ */
+bool bootstage_initcall_ready(void);
+
+/**
+ * Record the time taken by an initcall
+ *
+ * @param func		Link-time address of the initcall function
+ * @param start_us	Time when it was called, from timer_get_boot_us()
+ * @return time taken in microseconds
+ */
+ulong bootstage_initcall(ulong func, ulong start_us);
+
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * Print the time taken by each initcall, most expensive first
+ *
+ * @param csv	true to print comma-separated values for use by other
+ *		programs, false for a table
+ */
+void bootstage_report_initcalls(bool csv);
+
+/**
+ * Print boot marks and initcalls in Chrome trace-event JSON format
+ *
+ * The output can be loaded into chrome://tracing or Perfetto. Marks are
+ * shown as instant events and initcalls as intervals.
+ */
+void bootstage_report_json(void);
+
+/**
+ * Write boot marks and initcalls into a trace output buffer
+ *
+ * This writes a TRACE_CHUNK_BOOTSTAGE chunk, with the times converted to
+ * the timebase used by the function trace, so that proftool can show both
+ * on one timeline. It works like trace_list_calls().
+ *
+ * @param buff		Buffer in which to place data, or NULL to count size
+ * @param buff_size	Size of buffer
+ * @param needed	Returns number of bytes used / needed
+ * @return 0 if ok, -1 on error (buffer exhausted)
+ */
+int bootstage_list_marks(void *buff, int buff_size, unsigned *needed);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -380,6 +447,22 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline uint32_t bootstage_accum_time(enum bootstage_id id,
+					    const char *name, uint32_t time_us)
+{
+	return 0;
+}
+
+static inline bool bootstage_initcall_ready(void)
+{
+	return false;
+}
+
+static inline ulong bootstage_initcall(ulong func, ulong start_us)
+{
+	return 0;
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
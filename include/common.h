@@ -602,6 +602,23 @@ void ft_pci_setup(void *blob, bd_t *bd);
 void smp_set_core_boot_addr(unsigned long addr, int corenr);
 void smp_kick_all_cpus(void);
 
+/**
+ * cpu_run_parallel() - Run a set of independent jobs on all available CPUs
+ *
+ * This calls @func once for each index from 0 to @count - 1, spreading the
+ * calls across the secondary CPUs as well as the calling one. The jobs must
+ * not use anything which is unsafe to call concurrently, such as malloc() or
+ * the console.
+ *
+ * @func:	Function to call for each job
+ * @priv:	Private data to pass to @func
+ * @count:	Number of jobs
+ * @return number of CPUs used (>= 1), or -ENOSYS if not supported, in which
+ *	case @func has not been called
+ */
+int cpu_run_parallel(void (*func)(void *priv, int index), void *priv,
+		     int count);
+
 /* $(CPU)/serial.c */
 int	serial_init   (void);
 void	serial_setbrg (void);
@@ -768,8 +785,35 @@ ulong	usec2ticks    (unsigned long usec);
 ulong	ticks2usec    (unsigned long ticks);
 int	init_timebase (void);
 
+/**
+ * decomp_read_func - Read the next part of a compressed stream
+ *
+ * This is used by the streaming decompressors (gunzip_stream() and friends)
+ * to pull compressed data from storage as it is needed, so that the whole
+ * compressed image never has to be held in memory.
+ *
+ * @priv:	Private data passed to the decompressor by its caller
+ * @buf:	Buffer to fill
+ * @size:	Maximum number of bytes to read
+ * @return number of bytes read, 0 at the end of the stream, -ve on error
+ */
+typedef int (*decomp_read_func)(void *priv, void *buf, ulong size);
+
 /* lib/gunzip.c */
 int gunzip(void *, int, unsigned char *, unsigned long *);
+
+/**
+ * gunzip_stream() - Decompress gzip data read in chunks
+ *
+ * @dst:	Destination buffer
+ * @dstlen:	Size of destination buffer
+ * @read:	Function to call to read the compressed data
+ * @priv:	Private data to pass to @read
+ * @lenp:	Returns number of bytes decompressed
+ * @return 0 if OK, -ENOBUFS if @dst is too small, other -ve on error
+ */
+int gunzip_stream(void *dst, ulong dstlen, decomp_read_func read, void *priv,
+		  ulong *lenp);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
 
@@ -815,6 +859,20 @@ int gzwrite(unsigned char *src, int len,
 /* lib/lz4_wrapper.c */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
+/**
+ * ulz4fn_stream() - Decompress an LZ4 frame read in chunks
+ *
+ * Each block is read into a bounce buffer of the frame's maximum block size
+ * before it is decompressed to @dst.
+ *
+ * @read:	Function to call to read the compressed data
+ * @priv:	Private data to pass to @read
+ * @dst:	Destination buffer
+ * @dstn:	On entry the size of @dst, on exit the decompressed size
+ * @return 0 if OK, -ENOBUFS if @dst is too small, other -ve on error
+ */
+int ulz4fn_stream(decomp_read_func read, void *priv, void *dst, size_t *dstn);
+
 /* lib/qsort.c */
 void qsort(void *base, size_t nmemb, size_t size,
 	   int(*compar)(const void *, const void *));
@@ -65,6 +65,32 @@ int device_bind_by_name(struct udevice *parent, bool pre_reloc_only,
  */
 int device_probe(struct udevice *dev);
 
+/**
+ * device_probe_start() - Start probing a device without waiting for it
+ *
+ * This is like device_probe() except that if the driver's probe() method
+ * returns -EINPROGRESS, the device is left pending and the driver's
+ * probe_poll() method finishes the job later. This happens in
+ * device_probe_poll(), or when something calls device_probe() on the
+ * device, e.g. through uclass_get_device(). Before relocation this always
+ * waits for the probe to finish.
+ *
+ * @dev: Pointer to device to probe
+ * @return 0 if the device is now active, -EINPROGRESS if its probe is
+ * pending, other -ve on error
+ */
+int device_probe_start(struct udevice *dev);
+
+/**
+ * device_probe_poll() - Let pending device probes make progress
+ *
+ * This calls probe_poll() for each device whose probe is pending, and
+ * completes those which have finished.
+ *
+ * @return number of probes still pending
+ */
+int device_probe_poll(void);
+
 /**
  * device_remove() - Remove a device, de-activating it
  *
@@ -41,6 +41,12 @@ struct driver_info;
 /* Device is bound */
 #define DM_FLAG_BOUND			(1 << 6)
 
+/* Start probing this device at boot and let it finish in the background */
+#define DM_FLAG_PROBE_ASYNC		(1 << 7)
+
+/* Probe has started but the driver's probe_poll() has not yet finished */
+#define DM_FLAG_PROBE_PENDING		(1 << 8)
+
 /**
  * struct udevice - An instance of a driver
  *
@@ -150,7 +156,14 @@ struct udevice_id {
  * @of_match: List of compatible strings to match, and any identifying data
  * for each.
  * @bind: Called to bind a device to its driver
- * @probe: Called to probe a device, i.e. activate it
+ * @probe: Called to probe a device, i.e. activate it. If the driver has a
+ * probe_poll() method, this may start the hardware and return -EINPROGRESS
+ * to have the rest of the work done by probe_poll().
+ * @probe_poll: Called to check whether a probe which returned -EINPROGRESS
+ * has finished. Returns -EINPROGRESS if not, 0 when the device is ready, or
+ * another error if the probe failed. This lets slow hardware (card power-up,
+ * PHY autonegotiation) progress while other devices are set up, see
+ * device_probe_start().
  * @remove: Called to remove a device, i.e. de-activate it
  * @unbind: Called to unbind a device from its driver
  * @ofdata_to_platdata: Called before probe to decode device tree data
@@ -184,6 +197,7 @@ struct driver {
 	const struct udevice_id *of_match;
 	int (*bind)(struct udevice *dev);
 	int (*probe)(struct udevice *dev);
+	int (*probe_poll)(struct udevice *dev);
 	int (*remove)(struct udevice *dev);
 	int (*unbind)(struct udevice *dev);
 	int (*ofdata_to_platdata)(struct udevice *dev);
@@ -60,6 +60,23 @@ int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
 int lists_bind_fdt(struct udevice *parent, const void *blob, int offset,
 		   struct udevice **devp);
 
+/**
+ * lists_driver_lookup_compatible() - find the driver for a device tree node
+ *
+ * This finds the first driver in the driver list which has any of the
+ * node's compatible strings in its of_match table.
+ *
+ * @blob: device tree blob
+ * @offset: offset of this device tree node
+ * @drvp: returns the driver found, or NULL if none
+ * @of_idp: returns the matching entry in the driver's of_match table
+ * @return 0 if a driver was found, -ENOENT if none matches, -ENODEV if the
+ * node has no compatible string, -EINVAL if the device tree is invalid
+ */
+int lists_driver_lookup_compatible(const void *blob, int offset,
+				   struct driver **drvp,
+				   const struct udevice_id **of_idp);
+
 /**
  * device_bind_driver() - bind a device to a driver
  *
@@ -87,6 +87,18 @@ int dm_scan_other(bool pre_reloc_only);
  */
 int dm_init_and_scan(bool pre_reloc_only);
 
+/**
+ * dm_probe_async() - Start probing devices which can finish in the background
+ *
+ * This calls device_probe_start() on each bound device whose driver has the
+ * DM_FLAG_PROBE_ASYNC flag, so that slow hardware can get going while the
+ * rest of the board is set up. A device which is still pending is waited
+ * for when it is first used.
+ *
+ * @return number of probes left pending
+ */
+int dm_probe_async(void);
+
 /**
  * dm_init() - Initialise Driver Model structures
  *
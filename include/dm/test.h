@@ -62,6 +62,9 @@ enum {
 /* The number added to the ping total on each probe */
 #define DM_TEST_START_TOTAL	5
 
+/* How long test_async_drv takes to finish probing */
+#define DM_TEST_ASYNC_US	20000
+
 /**
  * struct dm_test_priv - private data for the test devices
  */
@@ -70,6 +73,7 @@ struct dm_test_priv {
 	int op_count[DM_TEST_OP_COUNT];
 	int uclass_flag;
 	int uclass_total;
+	ulong probe_start;
 };
 
 /**
@@ -0,0 +1,15 @@
+/*
+ * Structures generated from the device tree for SPL platform data
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __DT_STRUCTS_H
+#define __DT_STRUCTS_H
+
+/* The file is generated by dtoc and only exists when building SPL */
+#if defined(CONFIG_SPL_BUILD) && defined(CONFIG_SPL_OF_PLATDATA)
+#include <generated/dt-structs.h>
+#endif
+
+#endif
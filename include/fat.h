@@ -65,6 +65,9 @@
 #define LS_DIR		1
 #define LS_ROOT		2
 
+/* Value of do_fat_read_at()'s dogetsize which also keeps the file open */
+#define FAT_GETSIZE_OPEN	2
+
 #define ISDIRDELIM(c)	((c) == '/' || (c) == '\\')
 
 #define FSTYPE_NONE	(-1)
@@ -210,5 +213,7 @@ int file_fat_write(const char *filename, void *buf, loff_t offset, loff_t len,
 		   loff_t *actwrite);
 int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 		  loff_t *actread);
+int fat_open(const char *filename, loff_t *size);
+int fat_read_open(void *buf, loff_t offset, loff_t len, loff_t *actread);
 void fat_close(void);
 #endif /* _FAT_H_ */
@@ -15,6 +15,7 @@
  */
 
 #include <libfdt.h>
+#include <of_live.h>
 #include <pci.h>
 
 /*
@@ -451,6 +452,48 @@ int fdtdec_get_pci_vendev(const void *blob, int node,
 int fdtdec_get_pci_bar32(struct udevice *dev, struct fdt_pci_addr *addr,
 			 u32 *bar);
 
+/**
+ * fdtdec_getprop() - Look up a property in a node
+ *
+ * This is the same as fdt_getprop() but uses the live tree when it was
+ * built from @blob (see CONFIG_OF_LIVE), which avoids walking the node.
+ *
+ * @blob:	FDT blob
+ * @node:	Node to examine
+ * @prop_name:	Name of property to find
+ * @lenp:	If non-NULL, returns the property length, or a negative
+ *		FDT_ERR_... value if not found
+ * @return pointer to the property value, or NULL if not found
+ */
+static inline const void *fdtdec_getprop(const void *blob, int node,
+					 const char *prop_name, int *lenp)
+{
+#if CONFIG_IS_ENABLED(OF_LIVE)
+	if (of_live_active(blob))
+		return of_live_getprop(node, prop_name, lenp);
+#endif
+	return fdt_getprop(blob, node, prop_name, lenp);
+}
+
+/**
+ * fdtdec_parent_offset() - Find the parent of a node
+ *
+ * This is the same as fdt_parent_offset(), which has to scan the tree from
+ * the start, but uses the live tree when it was built from @blob.
+ *
+ * @blob:	FDT blob
+ * @node:	Node to examine
+ * @return offset of the parent node, or a negative FDT_ERR_... value
+ */
+static inline int fdtdec_parent_offset(const void *blob, int node)
+{
+#if CONFIG_IS_ENABLED(OF_LIVE)
+	if (of_live_active(blob))
+		return of_live_parent_offset(node);
+#endif
+	return fdt_parent_offset(blob, node);
+}
+
 /**
  * Look up a 32-bit integer property in a node and return it. The property
  * must have at least 4 bytes of data. The value of the first cell is
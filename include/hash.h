@@ -114,6 +114,18 @@ int hash_command(const char *algo_name, int flags, cmd_tbl_t *cmdtp, int flag,
 int hash_block(const char *algo_name, const void *data, unsigned int len,
 	       uint8_t *output, int *output_size);
 
+/**
+ * hash_bench() - Measure the throughput of each hash algorithm
+ *
+ * Each algorithm hashes the same buffer of @size bytes in one go and the
+ * time taken and resulting throughput are printed.
+ *
+ * @size:	Number of bytes to hash with each algorithm
+ * @return 0 if ok, -EINVAL if @size does not fit in an unsigned int, -ENOMEM
+ * if the buffer could not be allocated
+ */
+int hash_bench(ulong size);
+
 #endif /* !USE_HOSTCC */
 
 /**
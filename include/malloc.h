@@ -957,6 +957,41 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+/**
+ * struct malloc_info - summary of malloc() heap usage
+ *
+ * @total:		Size of the region available to malloc()
+ * @heap:		Bytes currently claimed from the region by the heap
+ * @peak_heap:		Largest value @heap has reached
+ * @in_use:		Bytes in allocated chunks, including their overhead
+ * @allocs:		Number of allocated chunks
+ * @free:		Bytes available for allocation, including the unused
+ *			end of the region
+ * @free_chunks:	Number of free chunks
+ * @largest_free:	Size of the largest free chunk
+ * @malloc_count:	Number of malloc() calls since the heap was set up
+ */
+struct malloc_info {
+	ulong total;
+	ulong heap;
+	ulong peak_heap;
+	ulong in_use;
+	ulong allocs;
+	ulong free;
+	ulong free_chunks;
+	ulong largest_free;
+	ulong malloc_count;
+};
+
+/**
+ * malloc_get_info() - Get statistics about the malloc() heap
+ *
+ * Before relocation this reports on the simple pre-relocation allocator.
+ *
+ * @info:	Returns the statistics
+ */
+void malloc_get_info(struct malloc_info *info);
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
@@ -49,6 +49,7 @@
 #define MMC_VERSION_4_41	MAKE_MMC_VERSION(4, 4, 1)
 #define MMC_VERSION_4_5		MAKE_MMC_VERSION(4, 5, 0)
 #define MMC_VERSION_5_0		MAKE_MMC_VERSION(5, 0, 0)
+#define MMC_VERSION_5_1		MAKE_MMC_VERSION(5, 1, 0)
 
 #define MMC_MODE_HS		(1 << 0)
 #define MMC_MODE_HS_52MHz	(1 << 1)
@@ -56,8 +57,22 @@
 #define MMC_MODE_8BIT		(1 << 3)
 #define MMC_MODE_SPI		(1 << 4)
 #define MMC_MODE_DDR_52MHz	(1 << 5)
+#define MMC_MODE_HS200		(1 << 6)	/* 1.8V I/O, needs tuning */
+#define MMC_MODE_HS400		(1 << 7)	/* 1.8V I/O, 8-bit only */
+#define MMC_MODE_CMD23		(1 << 8)	/* SET_BLOCK_COUNT transfers */
+
+/* Bus timing, for the host driver to set up in set_ios() */
+#define MMC_TIMING_LEGACY	0
+#define MMC_TIMING_MMC_HS	1
+#define MMC_TIMING_SD_HS	2
+#define MMC_TIMING_MMC_DDR52	3
+#define MMC_TIMING_MMC_HS200	4
+#define MMC_TIMING_MMC_HS400	5
+
+#define MMC_HS200_MAX_DTR	200000000
 
 #define SD_DATA_4BIT	0x00040000
+#define SD_SCR_CMD23_SUPPORT	0x00000002
 
 #define IS_SD(x)	((x)->version & SD_VERSION_SD)
 #define IS_MMC(x)	((x)->version & MMC_VERSION_MMC)
@@ -71,6 +86,11 @@
 #define TIMEOUT			-19
 #define SWITCH_ERR		-20 /* Card reports failure to switch mode */
 
+/* Values for op_cond_pending: which command the card is being polled with */
+#define MMC_OP_COND_MMC		1	/* CMD1 */
+#define MMC_OP_COND_SD		2	/* ACMD41 */
+#define MMC_OP_COND_TIMEOUT	1000	/* ms for the card to power up */
+
 #define MMC_CMD_GO_IDLE_STATE		0
 #define MMC_CMD_SEND_OP_COND		1
 #define MMC_CMD_ALL_SEND_CID		2
@@ -86,6 +106,7 @@
 #define MMC_CMD_SET_BLOCKLEN		16
 #define MMC_CMD_READ_SINGLE_BLOCK	17
 #define MMC_CMD_READ_MULTIPLE_BLOCK	18
+#define MMC_CMD_SEND_TUNING_BLOCK_HS200	21
 #define MMC_CMD_SET_BLOCK_COUNT         23
 #define MMC_CMD_WRITE_SINGLE_BLOCK	24
 #define MMC_CMD_WRITE_MULTIPLE_BLOCK	25
@@ -206,6 +227,14 @@
 #define EXT_CSD_CARD_TYPE_DDR_1_2V	(1 << 3)
 #define EXT_CSD_CARD_TYPE_DDR_52	(EXT_CSD_CARD_TYPE_DDR_1_8V \
 					| EXT_CSD_CARD_TYPE_DDR_1_2V)
+#define EXT_CSD_CARD_TYPE_HS200_1_8V	(1 << 4)
+#define EXT_CSD_CARD_TYPE_HS200_1_2V	(1 << 5)
+#define EXT_CSD_CARD_TYPE_HS200		(EXT_CSD_CARD_TYPE_HS200_1_8V \
+					| EXT_CSD_CARD_TYPE_HS200_1_2V)
+#define EXT_CSD_CARD_TYPE_HS400_1_8V	(1 << 6)
+#define EXT_CSD_CARD_TYPE_HS400_1_2V	(1 << 7)
+#define EXT_CSD_CARD_TYPE_HS400		(EXT_CSD_CARD_TYPE_HS400_1_8V \
+					| EXT_CSD_CARD_TYPE_HS400_1_2V)
 
 #define EXT_CSD_BUS_WIDTH_1	0	/* Card is in 1 bit mode */
 #define EXT_CSD_BUS_WIDTH_4	1	/* Card is in 4 bit mode */
@@ -213,6 +242,11 @@
 #define EXT_CSD_DDR_BUS_WIDTH_4	5	/* Card is in 4 bit DDR mode */
 #define EXT_CSD_DDR_BUS_WIDTH_8	6	/* Card is in 8 bit DDR mode */
 
+#define EXT_CSD_TIMING_LEGACY	0	/* Backwards compatible timing */
+#define EXT_CSD_TIMING_HS	1	/* High speed */
+#define EXT_CSD_TIMING_HS200	2	/* HS200 */
+#define EXT_CSD_TIMING_HS400	3	/* HS400 */
+
 #define EXT_CSD_BOOT_ACK_ENABLE			(1 << 6)
 #define EXT_CSD_BOOT_PARTITION_ENABLE		(1 << 3)
 #define EXT_CSD_PARTITION_ACCESS_ENABLE		(1 << 0)
@@ -329,6 +363,11 @@ struct mmc_ops {
 	int (*init)(struct mmc *mmc);
 	int (*getcd)(struct mmc *mmc);
 	int (*getwp)(struct mmc *mmc);
+	/*
+	 * Find the sampling point for HS200 by reading tuning blocks with
+	 * @opcode. If this is NULL, no tuning is done.
+	 */
+	int (*execute_tuning)(struct mmc *mmc, uint opcode);
 };
 
 struct mmc_config {
@@ -342,6 +381,23 @@ struct mmc_config {
 	unsigned char part_type;
 };
 
+/**
+ * struct mmc_stats - transfer counters for an MMC device
+ *
+ * @cmds:		Number of commands sent to the card
+ * @read_blocks:	Number of blocks read
+ * @read_us:		Time spent reading blocks, in microseconds
+ * @write_blocks:	Number of blocks written
+ * @write_us:		Time spent writing blocks, in microseconds
+ */
+struct mmc_stats {
+	ulong cmds;
+	ulong read_blocks;
+	ulong read_us;
+	ulong write_blocks;
+	ulong write_us;
+};
+
 /* TODO struct mmc should be in mmc_private but it's hard to fix right now */
 struct mmc {
 	struct list_head link;
@@ -377,10 +433,14 @@ struct mmc {
 	u64 enh_user_start;
 	u64 enh_user_size;
 	struct blk_desc block_dev;
-	char op_cond_pending;	/* 1 if we are waiting on an op_cond command */
+	char op_cond_pending;	/* MMC_OP_COND_... while the card powers up */
+	ulong op_cond_start;	/* Time when the first op_cond was sent */
 	char init_in_progress;	/* 1 if we have done mmc_start_init() */
 	char preinit;		/* start init as early as possible */
 	int ddr_mode;
+	uint timing;		/* MMC_TIMING_... */
+	uint blocklen;		/* Last block length set, 0 if unknown */
+	struct mmc_stats stats;
 };
 
 struct mmc_hwpart_conf {
@@ -450,6 +510,19 @@ int mmc_rpmb_write(struct mmc *mmc, void *addr, unsigned short blk,
  */
 int mmc_start_init(struct mmc *mmc);
 
+/**
+ * mmc_init_poll() - Move along any device inits started by mmc_start_init()
+ *
+ * This sends at most one command to each card which is still powering up,
+ * and finishes the init of those which are ready, without waiting. It can be
+ * called while U-Boot is otherwise idle so that cards are ready by the time
+ * they are needed. Devices which are still in progress when something needs
+ * them are finished off by mmc_init() as usual.
+ *
+ * @return number of devices whose init is still in progress
+ */
+int mmc_init_poll(void);
+
 /**
  * Set preinit flag of mmc device.
  *
@@ -128,6 +128,12 @@ enum eth_recv_flags {
  *		    ROM on the board. This is how the driver should expose it
  *		    to the network stack. This function should fill in the
  *		    eth_pdata::enetaddr field - optional
+ * rx_dest: Place the bytes of received packets from "offset" onwards at
+ *	    "dest" instead of in the packet buffer, for packets where that
+ *	    is at most "len" bytes. A NULL "dest" stops this. The driver calls
+ *	    eth_rx_placed() from recv() for each packet placed like this, and
+ *	    its packet buffer must still have room for the whole packet.
+ *	    Return -ENOSYS if not possible - optional
  */
 struct eth_ops {
 	int (*start)(struct udevice *dev);
@@ -140,6 +146,7 @@ struct eth_ops {
 #endif
 	int (*write_hwaddr)(struct udevice *dev);
 	int (*read_rom_hwaddr)(struct udevice *dev);
+	int (*rx_dest)(struct udevice *dev, void *dest, int offset, int len);
 };
 
 #define eth_get_ops(dev) ((struct eth_ops *)(dev)->driver->ops)
@@ -156,6 +163,9 @@ unsigned char *eth_get_ethaddr(void); /* get the current device MAC */
 int eth_is_active(struct udevice *dev); /* Test device for active state */
 int eth_init_state_only(void); /* Set active state */
 void eth_halt_state_only(void); /* Set passive state */
+
+/* Called by a driver's recv() when it placed the packet at the rx_dest */
+void eth_rx_placed(struct udevice *dev);
 #endif
 
 #ifndef CONFIG_DM_ETH
@@ -257,6 +267,8 @@ int eth_receive(void *packet, int length); /* Receive a packet*/
 extern void (*push_packet)(void *packet, int length);
 #endif
 int eth_rx(void);			/* Check for received packets */
+/* Ask the driver to place received data directly, see eth_ops::rx_dest */
+int eth_set_rx_dest(void *dest, int offset, int len);
 void eth_halt(void);			/* stop SCC */
 const char *eth_get_name(void);		/* get name of current device */
 
@@ -502,6 +514,9 @@ extern uchar		*net_tx_packet;		/* THE transmit packet */
 extern uchar		*net_rx_packets[PKTBUFSRX]; /* Receive packets */
 extern uchar		*net_rx_packet;		/* Current receive packet */
 extern int		net_rx_packet_len;	/* Current rx packet length */
+/* Where the driver placed the current packet from net_rx_placed_offset on */
+extern uchar		*net_rx_placed;
+extern int		net_rx_placed_offset;
 extern const u8		net_bcast_ethaddr[6];	/* Ethernet broadcast address */
 extern const u8		net_null_ethaddr[6];
 
@@ -652,6 +667,51 @@ int net_send_udp_packet(uchar *ether, struct in_addr dest, int dport,
 /* Processes a received packet */
 void net_process_received_packet(uchar *in_packet, int len);
 
+/**
+ * net_set_rx_dest() - Receive data straight into its destination
+ *
+ * Ask the Ethernet driver to place the UDP payload of packets for @port
+ * directly at @dest, skipping the copy from the packet buffer. Everything
+ * from @offset bytes into the packet goes to @dest, so any protocol header
+ * after the UDP header must be included in @offset. Any packet received
+ * may be written to @dest, so it must be safe to overwrite.
+ *
+ * @port: UDP port the data is expected on
+ * @dest: Where to place the data, or NULL to stop placing data
+ * @offset: Offset of the data in the Ethernet packet
+ * @len: Maximum length of the data
+ * @return 0 if the driver will place data, -ve if it cannot
+ */
+int net_set_rx_dest(int port, void *dest, int offset, int len);
+
+/**
+ * net_rx_data() - Find data of the received packet
+ *
+ * When the driver placed the data of the packet being processed, return
+ * the place it went to, otherwise return @ptr.
+ *
+ * @ptr: Pointer to data in the packet buffer
+ * @return pointer to the data
+ */
+uchar *net_rx_data(uchar *ptr);
+
+/* Copy placed data back into the packet buffer of the current packet */
+void net_rx_unplace(void);
+
+/**
+ * net_rx_dest_match() - Check if a packet is one to place at the rx_dest
+ *
+ * Drivers which can look at the headers of a packet before placing its data
+ * should call this, so that only the packets which net_set_rx_dest() asked
+ * for are written to the rx_dest.
+ *
+ * @pkt: Received Ethernet packet
+ * @offset: Offset of the data which would be placed
+ * @return true if the packet is a UDP packet for the port given to
+ *	net_set_rx_dest(), with its data at @offset
+ */
+bool net_rx_dest_match(const uchar *pkt, int offset);
+
 #ifdef CONFIG_NETCONSOLE
 void nc_start(void);
 int nc_input_packet(uchar *pkt, struct in_addr src_ip, unsigned dest_port,
@@ -0,0 +1,184 @@
+/*
+ * Live (unflattened) device tree
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __of_live_h
+#define __of_live_h
+
+/*
+ * Looking up a property in the flattened tree means walking the node's
+ * tags from its offset, and finding a node's parent, a phandle or the next
+ * compatible node means scanning the tree from the start. The live tree is
+ * built once from the control FDT after relocation and records each node's
+ * properties, parent and children, with a table of phandles. Nodes are still
+ * identified by their offset in the flat tree, and property values point
+ * into the flat tree, so that callers using offsets need not change.
+ *
+ * The fdtdec helpers use the live tree automatically when they are passed
+ * the blob it was built from.
+ */
+
+/**
+ * struct of_live_prop - a property in the live tree
+ *
+ * @name:	Property name (in the FDT strings block)
+ * @value:	Property value (in the FDT structure block)
+ * @len:	Length of the value in bytes
+ */
+struct of_live_prop {
+	const char *name;
+	const void *value;
+	int len;
+};
+
+/**
+ * struct of_live_node - a node in the live tree
+ *
+ * Nodes are held in an array in the order they appear in the flat tree,
+ * so they are sorted by @offset. Links to other nodes are array indexes,
+ * with -1 meaning there is none.
+ *
+ * @offset:		Offset of the node in the flat tree
+ * @parent:		Parent node
+ * @child:		First child node
+ * @sibling:		Next sibling node
+ * @phandle:		Phandle of this node, or 0 if none
+ * @name:		Node name, including any unit address
+ * @props:		Properties of the node
+ * @prop_count:		Number of properties
+ */
+struct of_live_node {
+	int offset;
+	int parent;
+	int child;
+	int sibling;
+	uint32_t phandle;
+	const char *name;
+	struct of_live_prop *props;
+	int prop_count;
+};
+
+/**
+ * struct of_live_stats - information about the live tree
+ *
+ * @nodes:	Number of nodes
+ * @props:	Number of properties
+ * @phandles:	Number of nodes with a phandle
+ * @size:	Bytes of memory used by the live tree
+ * @build_us:	Time taken to build the live tree in microseconds
+ * @lookups:	Number of lookups served from the live tree
+ */
+struct of_live_stats {
+	int nodes;
+	int props;
+	int phandles;
+	ulong size;
+	ulong build_us;
+	ulong lookups;
+};
+
+/**
+ * of_live_build() - Build the live tree from a flat tree
+ *
+ * Any existing live tree is freed first. The flat tree must stay where it
+ * is while the live tree is in use.
+ *
+ * @blob:	Flat tree to unflatten
+ * @return 0 if OK, -ENOMEM if out of memory, -EINVAL if the tree is invalid
+ */
+int of_live_build(const void *blob);
+
+/**
+ * of_live_free() - Free the live tree
+ *
+ * After this, lookups go back to using the flat tree.
+ */
+void of_live_free(void);
+
+/**
+ * of_live_active() - Check whether the live tree can be used for a blob
+ *
+ * This returns false if @blob is not the tree the live tree was built from,
+ * or if the flat tree has been resized since (e.g. a node or property was
+ * added or removed), since the live tree no longer matches it.
+ *
+ * Only the blob address and the sizes of its structure and strings blocks
+ * are checked, so some changes are not seen: a value changed in place, a
+ * property or node replaced by FDT_NOP tags, or edits which grow one part
+ * of the tree and shrink another by the same amount. Code which edits the
+ * control FDT after relocation must call of_live_free() (or rebuild the
+ * live tree) itself.
+ *
+ * @blob:	Flat tree the caller wants to look in
+ * @return true if the live tree matches @blob
+ */
+bool of_live_active(const void *blob);
+
+/**
+ * of_live_getprop() - Look up a property in the live tree
+ *
+ * This behaves like fdt_getprop().
+ *
+ * @offset:	Offset of the node in the flat tree
+ * @name:	Property name
+ * @lenp:	If non-NULL, returns the property length, or a negative
+ *		FDT_ERR_... value if there is no such property
+ * @return pointer to the property value, or NULL if not found
+ */
+const void *of_live_getprop(int offset, const char *name, int *lenp);
+
+/**
+ * of_live_parent_offset() - Find the parent of a node
+ *
+ * @offset:	Offset of the node in the flat tree
+ * @return offset of the parent node, or -FDT_ERR_NOTFOUND for the root
+ * node, or -FDT_ERR_BADOFFSET if @offset is not a node
+ */
+int of_live_parent_offset(int offset);
+
+/**
+ * of_live_node_offset_by_phandle() - Find the node with a given phandle
+ *
+ * @phandle:	Phandle to find
+ * @return offset of the node, or -FDT_ERR_NOTFOUND if none
+ */
+int of_live_node_offset_by_phandle(uint32_t phandle);
+
+/**
+ * of_live_node_offset_by_compatible() - Find the next compatible node
+ *
+ * This behaves like fdt_node_offset_by_compatible().
+ *
+ * @startoffset:	Only look at nodes after this one (-1 for all nodes)
+ * @compat:		Compatible string to match
+ * @return offset of the node, or -FDT_ERR_NOTFOUND if none
+ */
+int of_live_node_offset_by_compatible(int startoffset, const char *compat);
+
+/**
+ * of_live_path_offset() - Find a node by its full path
+ *
+ * @path:	Path, which must start with '/' (aliases are not supported)
+ * @return offset of the node, -FDT_ERR_NOTFOUND if there is no such node
+ * or -FDT_ERR_BADPATH if @path is not a full path
+ */
+int of_live_path_offset(const char *path);
+
+/**
+ * of_live_get_node() - Get a node from the live tree
+ *
+ * @offset:	Offset of the node in the flat tree
+ * @return pointer to the node, or NULL if there is no node at that offset
+ */
+const struct of_live_node *of_live_get_node(int offset);
+
+/**
+ * of_live_get_stats() - Get information about the live tree
+ *
+ * @stats:	Returns the information (all zero if there is no live tree)
+ */
+void of_live_get_stats(struct of_live_stats *stats);
+
+#endif
@@ -296,4 +296,41 @@ int os_jump_to_image(const void *dest, int size);
  */
 void os_localtime(struct rtc_time *rt);
 
+/**
+ * Run a set of independent jobs on host threads
+ *
+ * This calls @func once for each index from 0 to @count - 1, using up to
+ * one thread per online host CPU. The calling thread takes part in the work
+ * and this function returns once all jobs are complete.
+ *
+ * @param func		Function to call for each job
+ * @param priv		Private data to pass to @func
+ * @param count		Number of jobs
+ * @return number of threads used (>= 1)
+ */
+int os_run_parallel(void (*func)(void *priv, int index), void *priv,
+		    int count);
+
+/**
+ * Start sampling where the program is running
+ *
+ * This sends SIGPROF every @interval_us microseconds of wall-clock time.
+ * The signal handler passes @func the interrupted code address followed by
+ * the return addresses on the stack. Threads started by os_run_parallel()
+ * are not sampled.
+ *
+ * @param interval_us	Time between samples in microseconds
+ * @param func		Function to call with each sample
+ * @return 0 if OK, -ve on error
+ */
+int os_profile_start(unsigned int interval_us,
+		     void (*func)(void *const *addrs, int count));
+
+/**
+ * Stop sampling
+ *
+ * This stops the samples started by os_profile_start().
+ */
+void os_profile_stop(void);
+
 #endif
@@ -144,7 +144,17 @@
 
 #define SDHCI_ACMD12_ERR	0x3C
 
-/* 3E-3F reserved */
+#define SDHCI_HOST_CONTROL2	0x3E
+#define  SDHCI_CTRL_UHS_MASK	0x0007
+#define   SDHCI_CTRL_UHS_SDR12	0x0000
+#define   SDHCI_CTRL_UHS_SDR25	0x0001
+#define   SDHCI_CTRL_UHS_SDR50	0x0002
+#define   SDHCI_CTRL_UHS_SDR104	0x0003
+#define   SDHCI_CTRL_UHS_DDR50	0x0004
+#define   SDHCI_CTRL_HS400	0x0005 /* Non-standard, used by most hosts */
+#define  SDHCI_CTRL_VDD_180	0x0008
+#define  SDHCI_CTRL_EXEC_TUNING	0x0040
+#define  SDHCI_CTRL_TUNED_CLK	0x0080
 
 #define SDHCI_CAPABILITIES	0x40
 #define  SDHCI_TIMEOUT_CLK_MASK	0x0000003F
@@ -179,6 +189,7 @@
 /* 55-57 reserved */
 
 #define SDHCI_ADMA_ADDRESS	0x58
+#define SDHCI_ADMA_ADDRESS_HI	0x5C
 
 /* 60-FB reserved */
 
@@ -202,6 +213,9 @@
 #define SDHCI_MAX_DIV_SPEC_200	256
 #define SDHCI_MAX_DIV_SPEC_300	2046
 
+/* Number of tuning blocks the controller may ask for before giving up */
+#define SDHCI_TUNING_LOOP_COUNT	40
+
 /*
  * quirks
  */
@@ -214,6 +228,16 @@
 #define SDHCI_QUIRK_WAIT_SEND_CMD	(1 << 6)
 #define SDHCI_QUIRK_NO_SIMULT_VDD_AND_POWER (1 << 7)
 #define SDHCI_QUIRK_USE_WIDE8		(1 << 8)
+#define SDHCI_QUIRK_BROKEN_ADMA		(1 << 9)
+/* ADMA buffers must not cross a 128MB boundary */
+#define SDHCI_QUIRK_ADMA_128M_BOUNDARY	(1 << 10)
+#define SDHCI_QUIRK_BROKEN_CMD23	(1 << 11)
+
+/*
+ * flags, set from the controller capabilities
+ */
+#define SDHCI_USE_ADMA			(1 << 0)
+#define SDHCI_USE_64BIT_DMA		(1 << 1)
 
 /* to make gcc happy */
 struct sdhci_host;
@@ -223,6 +247,31 @@ struct sdhci_host;
  */
 #define SDHCI_DEFAULT_BOUNDARY_SIZE	(512 * 1024)
 #define SDHCI_DEFAULT_BOUNDARY_ARG	(7)
+
+/*
+ * ADMA2 descriptors. A 32-bit descriptor is 8 bytes long and a 64-bit one
+ * is 12 bytes long; addr_hi is only present in the latter.
+ */
+#define SDHCI_ADMA_VALID		(1 << 0)
+#define SDHCI_ADMA_END			(1 << 1)
+#define SDHCI_ADMA_INT			(1 << 2)
+#define SDHCI_ADMA_NOP			(0 << 4)
+#define SDHCI_ADMA_TRAN			(2 << 4)
+#define SDHCI_ADMA_LINK			(3 << 4)
+
+#define SDHCI_ADMA_DESC_LEN_32		8
+#define SDHCI_ADMA_DESC_LEN_64		12
+#define SDHCI_ADMA_ALIGN		4
+/* Largest length in a descriptor which keeps the next address aligned */
+#define SDHCI_ADMA_MAX_LEN		65532
+
+struct sdhci_adma_desc {
+	__le16 attr;
+	__le16 len;
+	__le32 addr_lo;
+	__le32 addr_hi;
+} __packed;
+
 struct sdhci_ops {
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
 	u32             (*read_l)(struct sdhci_host *host, int reg);
@@ -238,6 +287,7 @@ struct sdhci_host {
 	char *name;
 	void *ioaddr;
 	unsigned int quirks;
+	unsigned int flags;
 	unsigned int host_caps;
 	unsigned int version;
 	unsigned int clock;
@@ -253,6 +303,10 @@ struct sdhci_host {
 	void (*set_clock)(int dev_index, unsigned int div);
 	uint	voltages;
 
+	void *adma_desc_table;	/* ADMA2 descriptors, if SDHCI_USE_ADMA */
+	uint adma_desc_len;	/* Size of each descriptor in bytes */
+	uint adma_entries;	/* Number of descriptors in the table */
+
 	struct mmc_config cfg;
 };
 
@@ -339,4 +393,45 @@ static inline u8 sdhci_readb(struct sdhci_host *host, int reg)
 #endif
 
 int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk);
+
+/**
+ * sdhci_adma_setup() - Decide whether to use ADMA2 for a controller
+ *
+ * This sets SDHCI_USE_ADMA if the controller can do ADMA2 and does not have
+ * SDHCI_QUIRK_BROKEN_ADMA, and SDHCI_USE_64BIT_DMA as well if it is a
+ * version 3.00 controller with 64-bit addressing and DMA addresses are
+ * 64 bits wide. host->version must already be set.
+ *
+ * @host:	SDHCI host to set up
+ * @caps:	Value of the SDHCI_CAPABILITIES register
+ */
+void sdhci_adma_setup(struct sdhci_host *host, u32 caps);
+
+/**
+ * sdhci_adma_init() - Allocate the ADMA2 descriptor table
+ *
+ * The table is large enough for a transfer of CONFIG_SYS_MMC_MAX_BLK_COUNT
+ * blocks. Nothing is done if the table is already allocated.
+ *
+ * @host:	SDHCI host, set up by sdhci_adma_setup()
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+int sdhci_adma_init(struct sdhci_host *host);
+
+/**
+ * sdhci_adma_prepare() - Fill in the ADMA2 descriptor table for a transfer
+ *
+ * The buffer is split into descriptors of at most SDHCI_ADMA_MAX_LEN bytes,
+ * which do not cross a 128MB boundary if the controller has
+ * SDHCI_QUIRK_ADMA_128M_BOUNDARY. The last descriptor has SDHCI_ADMA_END
+ * set. The table is flushed from the cache.
+ *
+ * @host:	SDHCI host, with the table allocated by sdhci_adma_init()
+ * @addr:	DMA address of the buffer
+ * @len:	Number of bytes to transfer
+ * @return number of descriptors used, -EINVAL if the buffer is empty or not
+ * aligned to SDHCI_ADMA_ALIGN, -ERANGE if it is above 4GB and the
+ * controller only does 32-bit DMA, -E2BIG if the table is too small
+ */
+int sdhci_adma_prepare(struct sdhci_host *host, dma_addr_t addr, uint len);
 #endif /* __SDHCI_HW_H */
@@ -39,8 +39,9 @@ typedef struct entry {
 	int flags;
 } ENTRY;
 
-/* Opaque type for internal use.  */
+/* Opaque types for internal use.  */
 struct _ENTRY;
+struct arena;
 
 /*
  * Family of hash table handling functions.  The functions also
@@ -53,6 +54,25 @@ struct hsearch_data {
 	struct _ENTRY *table;
 	unsigned int size;
 	unsigned int filled;
+/*
+ * Entries sorted by key, kept up to date as entries are added and removed
+ * while "sorted_ok" is set (it is cleared during a full import and the list
+ * is sorted again on the next export).
+ */
+	struct _ENTRY **sorted;
+	int sorted_ok;
+/*
+ * Result of the last export of all entries with '\0' separators, as used
+ * to save the environment. It holds "export_count" entries, of which the
+ * first "export_valid" in sort order have not changed since, so only the
+ * text after them is regenerated.
+ */
+	char *export_buf;
+	size_t export_len;
+	unsigned int export_count;
+	unsigned int export_valid;
+/* Strings added by himport_r(), which are freed along with the table */
+	struct arena *strings;
 /*
  * Callback function which will check whether the given change for variable
  * "item" to "newval" may be applied or not, and possibly apply such change.
@@ -366,6 +366,28 @@ struct spi_cs_info {
 	struct udevice *dev;
 };
 
+/**
+ * struct spi_flash_read_message - A read from SPI flash
+ *
+ * This describes a whole read for controllers which can send the read
+ * command themselves, e.g. through a memory-mapped window or with DMA.
+ *
+ * @buf:		Buffer to put the data in
+ * @from:		Offset in the flash to read from
+ * @len:		Number of bytes to read
+ * @read_opcode:	Read command to send
+ * @addr_width:		Number of address bytes to send (3 or 4)
+ * @dummy_bytes:	Number of dummy bytes after the address
+ */
+struct spi_flash_read_message {
+	void *buf;
+	u32 from;
+	u32 len;
+	u8 read_opcode;
+	u8 addr_width;
+	u8 dummy_bytes;
+};
+
 /**
  * struct struct dm_spi_ops - Driver model SPI operations
  *
@@ -441,6 +463,36 @@ struct dm_spi_ops {
 	int (*xfer)(struct udevice *dev, unsigned int bitlen, const void *dout,
 		    void *din, unsigned long flags);
 
+	/**
+	 * Read from SPI flash (optional)
+	 *
+	 * Controllers which can read from flash more efficiently than with
+	 * xfer(), for example by using DMA or a memory-mapped window, can
+	 * provide this. It handles a whole read, including sending the
+	 * command, so that the data does not pass through xfer() a few bytes
+	 * at a time. The bus is claimed before this is called.
+	 *
+	 * @dev:	The SPI slave
+	 * @msg:	Details of the read
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*flash_read)(struct udevice *dev,
+			  struct spi_flash_read_message *msg);
+
+	/**
+	 * Get the memory-mapped window for a SPI flash (optional)
+	 *
+	 * Controllers which map the flash into the address space can report
+	 * where the window is, so that reads can simply copy from it.
+	 *
+	 * @dev:	The SPI slave
+	 * @map_basep:	Returns the physical address of the window
+	 * @map_sizep:	Returns the size of the window in bytes
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*get_mmap)(struct udevice *dev, ulong *map_basep,
+			uint *map_sizep);
+
 	/**
 	 * Set transfer speed.
 	 * This sets a new speed to be applied for next spi_xfer().
@@ -592,6 +644,38 @@ int spi_slave_ofdata_to_platdata(const void *blob, int node,
  */
 int spi_cs_info(struct udevice *bus, uint cs, struct spi_cs_info *info);
 
+/**
+ * spi_flash_read_msg() - Read from SPI flash using the controller
+ *
+ * This uses the controller's flash_read() method. The bus must be claimed.
+ *
+ * @slave:	The SPI slave
+ * @msg:	Details of the read
+ * @return 0 if OK, -ENOSYS if the controller cannot do this, other -ve
+ *	   value on error
+ */
+int spi_flash_read_msg(struct spi_slave *slave,
+		       struct spi_flash_read_message *msg);
+
+/**
+ * spi_has_flash_read() - Check whether a controller can read flash directly
+ *
+ * @slave:	The SPI slave
+ * @return true if spi_flash_read_msg() is supported
+ */
+bool spi_has_flash_read(struct spi_slave *slave);
+
+/**
+ * spi_get_mmap() - Get the memory-mapped window for a SPI flash
+ *
+ * @slave:	The SPI slave
+ * @map_basep:	Returns the physical address of the window
+ * @map_sizep:	Returns the size of the window in bytes
+ * @return 0 if OK, -ENOSYS if the controller does not map the flash, other
+ *	   -ve value on error
+ */
+int spi_get_mmap(struct spi_slave *slave, ulong *map_basep, uint *map_sizep);
+
 struct sandbox_state;
 
 /**
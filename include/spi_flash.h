@@ -28,6 +28,15 @@
 
 struct spi_slave;
 
+/* Ways of reading from SPI flash, slowest first */
+enum spi_flash_read_mode {
+	SF_READ_XFER,		/* Read commands sent through spi_xfer() */
+	SF_READ_DIRECT,		/* The SPI controller's flash_read() method */
+	SF_READ_MMAP,		/* Copy from the memory-mapped flash */
+
+	SF_READ_MODE_COUNT,
+};
+
 /**
  * struct spi_flash - SPI flash structure
  *
@@ -48,6 +57,9 @@ struct spi_slave;
  * @read_cmd:		Read cmd - Array Fast, Extn read and quad read.
  * @write_cmd:		Write cmd - page and quad program.
  * @dummy_byte:		Dummy cycles for read operation.
+ * @addr_width:		Number of address bytes sent with each command (3 or 4)
+ * @read_mode:		Read mode in use (enum spi_flash_read_mode)
+ * @read_modes:		Bit mask of the read modes available for this flash
  * @memory_map:		Address of read-only SPI flash access
  * @flash_lock:		lock a region of the SPI Flash
  * @flash_unlock:	unlock a region of the SPI Flash
@@ -83,6 +95,9 @@ struct spi_flash {
 	u8 read_cmd;
 	u8 write_cmd;
 	u8 dummy_byte;
+	u8 addr_width;
+	u8 read_mode;
+	u8 read_modes;
 
 	void *memory_map;
 
@@ -29,6 +29,8 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_BOOTSTAGE,
+	TRACE_CHUNK_SAMPLES,
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -37,6 +39,29 @@ struct trace_output_func {
 	uint32_t call_count;		/* Number of times called */
 };
 
+#define TRACE_MARK_NAME_LEN	32
+
+/*
+ * A bootstage record, as written to the profile output file. Times use the
+ * same timebase as the timestamps in struct trace_call.
+ */
+struct trace_output_mark {
+	uint32_t start_us;		/* Time of mark, or start of interval */
+	uint32_t duration_us;		/* Length of interval, 0 for a mark */
+	char name[TRACE_MARK_NAME_LEN];	/* Nul-terminated record name */
+};
+
+#define TRACE_SAMPLE_NONE	0xffffffff
+
+/*
+ * A profiler sample, as written to the profile output file. Offsets are
+ * relative to the start of the U-Boot code, as for struct trace_call.
+ */
+struct trace_sample {
+	uint32_t pc;		/* Code offset where U-Boot was running */
+	uint32_t caller;	/* Offset in the caller, or TRACE_SAMPLE_NONE */
+};
+
 /* A header at the start of the trace output buffer */
 struct trace_output_hdr {
 	enum trace_chunk_type type;	/* Record type */
@@ -102,4 +127,68 @@ int trace_early_init(void);
  */
 int trace_init(void *buff, size_t buff_size);
 
+/**
+ * Set up the sampling profiler
+ *
+ * @param buff		Buffer to hold samples
+ * @param buff_size	Size of buffer
+ * @return 0 if ok, -ENOSPC if the buffer is too small
+ */
+int profile_init(void *buff, size_t buff_size);
+
+/**
+ * Start taking samples
+ *
+ * @param interval_us	Time between samples in microseconds
+ * @return 0 if ok, -ve on error
+ */
+int profile_start(unsigned int interval_us);
+
+/* Stop taking samples */
+void profile_stop(void);
+
+/**
+ * Record a sample
+ *
+ * This is called from the timer interrupt or signal which drives the
+ * profiler. The first address inside U-Boot is taken as the sample and the
+ * next as its caller, so time spent in code outside U-Boot (such as the
+ * host C library on sandbox) is charged to the U-Boot function that called
+ * it.
+ *
+ * @param addrs		Code addresses, the interrupted one first, then
+ *			return addresses from the stack, innermost first
+ * @param count		Number of addresses
+ */
+void profile_sample(void *const *addrs, int count);
+
+/* Print statistics about the samples taken */
+void profile_print_stats(void);
+
+/**
+ * Write the samples into a trace output buffer
+ *
+ * This works like trace_list_calls(), writing a TRACE_CHUNK_SAMPLES chunk.
+ *
+ * @param buff		Buffer in which to place data, or NULL to count size
+ * @param buff_size	Size of buffer
+ * @param needed	Returns number of bytes used / needed
+ * @return 0 if ok, -1 on error (buffer exhausted)
+ */
+int profile_list_samples(void *buff, int buff_size, unsigned *needed);
+
+/**
+ * Start the timer which drives the profiler
+ *
+ * This is implemented by the architecture. It should call profile_sample()
+ * every @interval_us microseconds until arch_profile_stop() is called.
+ *
+ * @param interval_us	Time between samples in microseconds
+ * @return 0 if ok, -ve on error
+ */
+int arch_profile_start(unsigned int interval_us);
+
+/* Stop the timer which drives the profiler */
+void arch_profile_stop(void);
+
 #endif
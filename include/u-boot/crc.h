@@ -25,4 +25,26 @@ uint32_t crc32_no_comp (uint32_t, const unsigned char *, uint);
 void crc32_wd_buf(const unsigned char *input, uint ilen,
 		    unsigned char *output, uint chunk_sz);
 
+/**
+ * struct crc32_engine - A CRC32 implementation built into lib/crc32.c
+ *
+ * @name:	Short name of the engine, e.g. "slice-by-8"
+ * @calc:	Calculate a CRC without ones complement, as crc32_no_comp()
+ */
+struct crc32_engine {
+	const char *name;
+	uint32_t (*calc)(uint32_t crc, const unsigned char *buf, uint len);
+};
+
+/**
+ * crc32_get_engines() - Get the list of CRC32 engines, for testing
+ *
+ * The last engine in the list is the one used by crc32_no_comp(). This is
+ * only available when CONFIG_UNIT_TEST is enabled.
+ *
+ * @enginesp:	Returns a pointer to the engine list
+ * @return number of engines in the list
+ */
+int crc32_get_engines(const struct crc32_engine **enginesp);
+
 #endif /* _UBOOT_CRC_H */
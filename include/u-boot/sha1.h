@@ -99,6 +99,16 @@ void sha1_hmac(const unsigned char *key, int keylen,
  */
 int sha1_self_test( void );
 
+/**
+ * \brief	   Process 64-byte blocks with the ARMv8 Crypto Extensions
+ *
+ * \param state    SHA-1 intermediate digest state
+ * \param data     buffer holding the blocks
+ * \param blocks   number of 64-byte blocks to process
+ */
+void sha1_armv8_ce_process(uint32_t state[5], const unsigned char *data,
+			   unsigned int blocks);
+
 #ifdef __cplusplus
 }
 #endif
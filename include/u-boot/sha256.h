@@ -19,4 +19,8 @@ void sha256_finish(sha256_context * ctx, uint8_t digest[SHA256_SUM_LEN]);
 void sha256_csum_wd(const unsigned char *input, unsigned int ilen,
 		unsigned char *output, unsigned int chunk_sz);
 
+/* Process 64-byte blocks with the ARMv8 Crypto Extensions */
+void sha256_armv8_ce_process(uint32_t state[8], const uint8_t *data,
+			     unsigned int blocks);
+
 #endif /* _SHA256_H */
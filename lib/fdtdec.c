@@ -73,6 +73,38 @@ static const char * const compat_names[COMPAT_COUNT] = {
 	COMPAT(COMPAT_INTEL_IVYBRIDGE_FSP, "intel,ivybridge-fsp"),
 };
 
+/*
+ * These use the live tree when it was built from the blob, to avoid
+ * scanning the flat tree from the start
+ */
+static int fdtdec_path_offset(const void *blob, const char *path)
+{
+#if CONFIG_IS_ENABLED(OF_LIVE)
+	if (*path == '/' && of_live_active(blob))
+		return of_live_path_offset(path);
+#endif
+	return fdt_path_offset(blob, path);
+}
+
+static int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle)
+{
+#if CONFIG_IS_ENABLED(OF_LIVE)
+	if (of_live_active(blob))
+		return of_live_node_offset_by_phandle(phandle);
+#endif
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+
+static int fdtdec_node_offset_by_compatible(const void *blob, int node,
+					    const char *compat)
+{
+#if CONFIG_IS_ENABLED(OF_LIVE)
+	if (of_live_active(blob))
+		return of_live_node_offset_by_compatible(node, compat);
+#endif
+	return fdt_node_offset_by_compatible(blob, node, compat);
+}
+
 const char *fdtdec_get_compatible(enum fdt_compat_id id)
 {
 	/* We allow reading of the 'unknown' ID for testing purposes */
@@ -101,7 +133,7 @@ fdt_addr_t fdtdec_get_addr_size_fixed(const void *blob, int node,
 		return FDT_ADDR_T_NONE;
 	}
 
-	prop = fdt_getprop(blob, node, prop_name, &len);
+	prop = fdtdec_getprop(blob, node, prop_name, &len);
 	if (!prop) {
 		debug("(not found)\n");
 		return FDT_ADDR_T_NONE;
@@ -162,7 +194,7 @@ fdt_addr_t fdtdec_get_addr_size_auto_noparent(const void *blob, int node,
 
 	debug("%s: ", __func__);
 
-	parent = fdt_parent_offset(blob, node);
+	parent = fdtdec_parent_offset(blob, node);
 	if (parent < 0) {
 		debug("(no parent found)\n");
 		return FDT_ADDR_T_NONE;
@@ -204,7 +236,7 @@ int fdtdec_get_pci_addr(const void *blob, int node, enum fdt_pci_space type,
 	 * #size-cells. They need to be 3 and 2 accordingly. However,
 	 * for simplicity we skip the check here.
 	 */
-	cell = fdt_getprop(blob, node, prop_name, &len);
+	cell = fdtdec_getprop(blob, node, prop_name, &len);
 	if (!cell)
 		goto fail;
 
@@ -248,7 +280,7 @@ int fdtdec_get_pci_vendev(const void *blob, int node, u16 *vendor, u16 *device)
 	const char *list, *end;
 	int len;
 
-	list = fdt_getprop(blob, node, "compatible", &len);
+	list = fdtdec_getprop(blob, node, "compatible", &len);
 	if (!list)
 		return -ENOENT;
 
@@ -304,7 +336,7 @@ uint64_t fdtdec_get_uint64(const void *blob, int node, const char *prop_name,
 	const uint64_t *cell64;
 	int length;
 
-	cell64 = fdt_getprop(blob, node, prop_name, &length);
+	cell64 = fdtdec_getprop(blob, node, prop_name, &length);
 	if (!cell64 || length < sizeof(*cell64))
 		return default_val;
 
@@ -322,7 +354,7 @@ int fdtdec_get_is_enabled(const void *blob, int node)
 	 *
 	 * http://www.mail-archive.com/u-boot@lists.denx.de/msg71598.html
 	 */
-	cell = fdt_getprop(blob, node, "status", NULL);
+	cell = fdtdec_getprop(blob, node, "status", NULL);
 	if (cell)
 		return 0 == strcmp(cell, "okay");
 	return 1;
@@ -343,7 +375,7 @@ enum fdt_compat_id fdtdec_lookup(const void *blob, int node)
 int fdtdec_next_compatible(const void *blob, int node,
 		enum fdt_compat_id id)
 {
-	return fdt_node_offset_by_compatible(blob, node, compat_names[id]);
+	return fdtdec_node_offset_by_compatible(blob, node, compat_names[id]);
 }
 
 int fdtdec_next_compatible_subnode(const void *blob, int node,
@@ -371,7 +403,7 @@ int fdtdec_next_alias(const void *blob, const char *name,
 	/* snprintf() is not available */
 	assert(strlen(name) < MAX_STR_LEN);
 	sprintf(str, "%.*s%d", MAX_STR_LEN, name, *upto);
-	node = fdt_path_offset(blob, str);
+	node = fdtdec_path_offset(blob, str);
 	if (node < 0)
 		return node;
 	err = fdt_node_check_compatible(blob, node, compat_names[id]);
@@ -404,7 +436,7 @@ int fdtdec_add_aliases_for_id(const void *blob, const char *name,
 	int i, j;
 
 	/* find the alias node if present */
-	alias_node = fdt_path_offset(blob, "/aliases");
+	alias_node = fdtdec_path_offset(blob, "/aliases");
 
 	/*
 	 * start with nothing, and we can assume that the root node can't
@@ -435,7 +467,7 @@ int fdtdec_add_aliases_for_id(const void *blob, const char *name,
 		prop = fdt_get_property_by_offset(blob, offset, NULL);
 		path = fdt_string(blob, fdt32_to_cpu(prop->nameoff));
 		if (prop->len && 0 == strncmp(path, name, name_len))
-			node = fdt_path_offset(blob, prop->data);
+			node = fdtdec_path_offset(blob, prop->data);
 		if (node <= 0)
 			continue;
 
@@ -506,42 +538,69 @@ int fdtdec_add_aliases_for_id(const void *blob, const char *name,
 	return num_found;
 }
 
+/*
+ * Check whether an alias refers to a node, returning the alias sequence
+ * number if so, else -1
+ */
+static int check_alias(const char *name, const char *prop, int len,
+		       const char *base, const char *find_name,
+		       int find_namelen)
+{
+	const char *slash;
+
+	debug("   - %s, %s\n", name, prop);
+	if (len < find_namelen || *prop != '/' || prop[len - 1] ||
+	    strncmp(name, base, strlen(base)))
+		return -1;
+
+	slash = strrchr(prop, '/');
+	if (strcmp(slash + 1, find_name))
+		return -1;
+
+	return trailing_strtol(name);
+}
+
 int fdtdec_get_alias_seq(const void *blob, const char *base, int offset,
 			 int *seqp)
 {
-	int base_len = strlen(base);
 	const char *find_name;
 	int find_namelen;
 	int prop_offset;
 	int aliases;
+	int val = -1;
 
 	find_name = fdt_get_name(blob, offset, &find_namelen);
 	debug("Looking for '%s' at %d, name %s\n", base, offset, find_name);
 
-	aliases = fdt_path_offset(blob, "/aliases");
+	aliases = fdtdec_path_offset(blob, "/aliases");
+#if CONFIG_IS_ENABLED(OF_LIVE)
+	if (of_live_active(blob)) {
+		const struct of_live_node *node = of_live_get_node(aliases);
+		int i;
+
+		for (i = 0; node && i < node->prop_count && val == -1; i++) {
+			const struct of_live_prop *prop = &node->props[i];
+
+			val = check_alias(prop->name, prop->value, prop->len,
+					  base, find_name, find_namelen);
+		}
+	} else
+#endif
 	for (prop_offset = fdt_first_property_offset(blob, aliases);
-	     prop_offset > 0;
+	     prop_offset > 0 && val == -1;
 	     prop_offset = fdt_next_property_offset(blob, prop_offset)) {
 		const char *prop;
 		const char *name;
-		const char *slash;
-		int len, val;
+		int len;
 
 		prop = fdt_getprop_by_offset(blob, prop_offset, &name, &len);
-		debug("   - %s, %s\n", name, prop);
-		if (len < find_namelen || *prop != '/' || prop[len - 1] ||
-		    strncmp(name, base, base_len))
-			continue;
-
-		slash = strrchr(prop, '/');
-		if (strcmp(slash + 1, find_name))
-			continue;
-		val = trailing_strtol(name);
-		if (val != -1) {
-			*seqp = val;
-			debug("Found seq %d\n", *seqp);
-			return 0;
-		}
+		val = check_alias(name, prop, len, base, find_name,
+				  find_namelen);
+	}
+	if (val != -1) {
+		*seqp = val;
+		debug("Found seq %d\n", *seqp);
+		return 0;
 	}
 
 	debug("Not found\n");
@@ -554,8 +613,8 @@ const char *fdtdec_get_chosen_prop(const void *blob, const char *name)
 
 	if (!blob)
 		return NULL;
-	chosen_node = fdt_path_offset(blob, "/chosen");
-	return fdt_getprop(blob, chosen_node, name, NULL);
+	chosen_node = fdtdec_path_offset(blob, "/chosen");
+	return fdtdec_getprop(blob, chosen_node, name, NULL);
 }
 
 int fdtdec_get_chosen_node(const void *blob, const char *name)
@@ -565,7 +624,7 @@ int fdtdec_get_chosen_node(const void *blob, const char *name)
 	prop = fdtdec_get_chosen_prop(blob, name);
 	if (!prop)
 		return -FDT_ERR_NOTFOUND;
-	return fdt_path_offset(blob, prop);
+	return fdtdec_path_offset(blob, prop);
 }
 
 int fdtdec_check_fdt(void)
@@ -612,11 +671,11 @@ int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name)
 	int lookup;
 
 	debug("%s: %s\n", __func__, prop_name);
-	phandle = fdt_getprop(blob, node, prop_name, NULL);
+	phandle = fdtdec_getprop(blob, node, prop_name, NULL);
 	if (!phandle)
 		return -FDT_ERR_NOTFOUND;
 
-	lookup = fdt_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
+	lookup = fdtdec_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
 	return lookup;
 }
 
@@ -638,7 +697,7 @@ static const void *get_prop_check_min_len(const void *blob, int node,
 	int len;
 
 	debug("%s: %s\n", __func__, prop_name);
-	cell = fdt_getprop(blob, node, prop_name, &len);
+	cell = fdtdec_getprop(blob, node, prop_name, &len);
 	if (!cell)
 		*err = -FDT_ERR_NOTFOUND;
 	else if (len < min_len)
@@ -672,7 +731,7 @@ int fdtdec_get_int_array_count(const void *blob, int node,
 	int i;
 
 	debug("%s: %s\n", __func__, prop_name);
-	cell = fdt_getprop(blob, node, prop_name, &len);
+	cell = fdtdec_getprop(blob, node, prop_name, &len);
 	if (!cell)
 		return -FDT_ERR_NOTFOUND;
 	elems = len / sizeof(u32);
@@ -701,7 +760,7 @@ int fdtdec_get_bool(const void *blob, int node, const char *prop_name)
 	int len;
 
 	debug("%s: %s\n", __func__, prop_name);
-	cell = fdt_getprop(blob, node, prop_name, &len);
+	cell = fdtdec_getprop(blob, node, prop_name, &len);
 	return cell != NULL;
 }
 
@@ -718,7 +777,7 @@ int fdtdec_parse_phandle_with_args(const void *blob, int src_node,
 	int phandle;
 
 	/* Retrieve the phandle list property */
-	list = fdt_getprop(blob, src_node, list_name, &size);
+	list = fdtdec_getprop(blob, src_node, list_name, &size);
 	if (!list)
 		return -ENOENT;
 	list_end = list + size / sizeof(*list);
@@ -744,7 +803,7 @@ int fdtdec_parse_phandle_with_args(const void *blob, int src_node,
 			 * below.
 			 */
 			if (cells_name || cur_index == index) {
-				node = fdt_node_offset_by_phandle(blob,
+				node = fdtdec_node_offset_by_phandle(blob,
 								  phandle);
 				if (!node) {
 					debug("%s: could not find phandle\n",
@@ -870,7 +929,7 @@ int fdtdec_get_config_int(const void *blob, const char *prop_name,
 	int config_node;
 
 	debug("%s: %s\n", __func__, prop_name);
-	config_node = fdt_path_offset(blob, "/config");
+	config_node = fdtdec_path_offset(blob, "/config");
 	if (config_node < 0)
 		return default_val;
 	return fdtdec_get_int(blob, config_node, prop_name, default_val);
@@ -882,10 +941,10 @@ int fdtdec_get_config_bool(const void *blob, const char *prop_name)
 	const void *prop;
 
 	debug("%s: %s\n", __func__, prop_name);
-	config_node = fdt_path_offset(blob, "/config");
+	config_node = fdtdec_path_offset(blob, "/config");
 	if (config_node < 0)
 		return 0;
-	prop = fdt_get_property(blob, config_node, prop_name, NULL);
+	prop = fdtdec_getprop(blob, config_node, prop_name, NULL);
 
 	return prop != NULL;
 }
@@ -897,11 +956,11 @@ char *fdtdec_get_config_string(const void *blob, const char *prop_name)
 	int len;
 
 	debug("%s: %s\n", __func__, prop_name);
-	nodeoffset = fdt_path_offset(blob, "/config");
+	nodeoffset = fdtdec_path_offset(blob, "/config");
 	if (nodeoffset < 0)
 		return NULL;
 
-	nodep = fdt_getprop(blob, nodeoffset, prop_name, &len);
+	nodep = fdtdec_getprop(blob, nodeoffset, prop_name, &len);
 	if (!nodep)
 		return NULL;
 
@@ -916,7 +975,7 @@ int fdtdec_decode_region(const void *blob, int node, const char *prop_name,
 
 	debug("%s: %s: %s\n", __func__, fdt_get_name(blob, node, NULL),
 	      prop_name);
-	cell = fdt_getprop(blob, node, prop_name, &len);
+	cell = fdtdec_getprop(blob, node, prop_name, &len);
 	if (!cell || (len < sizeof(fdt_addr_t) * 2)) {
 		debug("cell=%p, len=%d\n", cell, len);
 		return -1;
@@ -952,10 +1011,10 @@ int fdtdec_read_fmap_entry(const void *blob, int node, const char *name,
 	entry->offset = reg[0];
 	entry->length = reg[1];
 	entry->used = fdtdec_get_int(blob, node, "used", entry->length);
-	prop = fdt_getprop(blob, node, "compress", NULL);
+	prop = fdtdec_getprop(blob, node, "compress", NULL);
 	entry->compress_algo = prop && !strcmp(prop, "lzo") ?
 		FMAP_COMPRESS_LZO : FMAP_COMPRESS_NONE;
-	prop = fdt_getprop(blob, node, "hash", &entry->hash_size);
+	prop = fdtdec_getprop(blob, node, "hash", &entry->hash_size);
 	entry->hash_algo = prop ? FMAP_HASH_SHA256 : FMAP_HASH_NONE;
 	entry->hash = (uint8_t *)prop;
 
@@ -979,14 +1038,14 @@ int fdt_get_resource(const void *fdt, int node, const char *property,
 	int na, ns, len, parent;
 	unsigned int i = 0;
 
-	parent = fdt_parent_offset(fdt, node);
+	parent = fdtdec_parent_offset(fdt, node);
 	if (parent < 0)
 		return parent;
 
 	na = fdt_address_cells(fdt, parent);
 	ns = fdt_size_cells(fdt, parent);
 
-	ptr = fdt_getprop(fdt, node, property, &len);
+	ptr = fdtdec_getprop(fdt, node, property, &len);
 	if (!ptr)
 		return len;
 
@@ -1030,7 +1089,7 @@ int fdtdec_decode_memory_region(const void *blob, int config_node,
 	int node;
 
 	if (config_node == -1) {
-		config_node = fdt_path_offset(blob, "/config");
+		config_node = fdtdec_path_offset(blob, "/config");
 		if (config_node < 0) {
 			debug("%s: Cannot find /config node\n", __func__);
 			return -ENOENT;
@@ -1041,14 +1100,14 @@ int fdtdec_decode_memory_region(const void *blob, int config_node,
 
 	snprintf(prop_name, sizeof(prop_name), "%s-memory%s", mem_type,
 		 suffix);
-	mem = fdt_getprop(blob, config_node, prop_name, NULL);
+	mem = fdtdec_getprop(blob, config_node, prop_name, NULL);
 	if (!mem) {
 		debug("%s: No memory type for '%s', using /memory\n", __func__,
 		      prop_name);
 		mem = "/memory";
 	}
 
-	node = fdt_path_offset(blob, mem);
+	node = fdtdec_path_offset(blob, mem);
 	if (node < 0) {
 		debug("%s: Failed to find node '%s': %s\n", __func__, mem,
 		      fdt_strerror(node));
@@ -1086,7 +1145,7 @@ static int decode_timing_property(const void *blob, int node, const char *name,
 	int length, ret = 0;
 	const u32 *prop;
 
-	prop = fdt_getprop(blob, node, name, &length);
+	prop = fdtdec_getprop(blob, node, name, &length);
 	if (!prop) {
 		debug("%s: could not find property %s\n",
 		      fdt_get_name(blob, node, NULL), name);
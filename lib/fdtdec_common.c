@@ -17,6 +17,7 @@
 #include "fdt_support.h"
 
 #define debug(...)
+#define fdtdec_getprop fdt_getprop
 #endif
 
 int fdtdec_get_int(const void *blob, int node, const char *prop_name,
@@ -26,7 +27,7 @@ int fdtdec_get_int(const void *blob, int node, const char *prop_name,
 	int len;
 
 	debug("%s: %s: ", __func__, prop_name);
-	cell = fdt_getprop(blob, node, prop_name, &len);
+	cell = fdtdec_getprop(blob, node, prop_name, &len);
 	if (cell && len >= sizeof(int)) {
 		int val = fdt32_to_cpu(cell[0]);
 
@@ -44,7 +45,7 @@ unsigned int fdtdec_get_uint(const void *blob, int node, const char *prop_name,
 	int len;
 
 	debug("%s: %s: ", __func__, prop_name);
-	cell = fdt_getprop(blob, node, prop_name, &len);
+	cell = fdtdec_getprop(blob, node, prop_name, &len);
 	if (cell && len >= sizeof(unsigned int)) {
 		unsigned int val = fdt32_to_cpu(cell[0]);
 
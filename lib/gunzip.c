@@ -13,6 +13,7 @@
 #include <malloc.h>
 #include <u-boot/zlib.h>
 #include <div64.h>
+#include <errno.h>
 
 #define HEADER0			'\x1f'
 #define HEADER1			'\x8b'
@@ -70,6 +71,99 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	return zunzip(dst, dstlen, src, lenp, 1, i);
 }
 
+/* Number of compressed bytes read at a time by gunzip_stream() */
+#define GUNZIP_STREAM_CHUNK	(64 << 10)
+
+int gunzip_stream(void *dst, ulong dstlen, decomp_read_func read, void *priv,
+		  ulong *lenp)
+{
+	unsigned char *src;
+	z_stream s;
+	int len, i, flags;
+	int ret = -EINVAL;
+	int r;
+
+	*lenp = 0;
+	src = malloc(GUNZIP_STREAM_CHUNK);
+	if (!src)
+		return -ENOMEM;
+
+	/* The header must be within the first chunk, so fill it */
+	for (len = 0; len < GUNZIP_STREAM_CHUNK; len += r) {
+		r = read(priv, src + len, GUNZIP_STREAM_CHUNK - len);
+		if (r <= 0)
+			break;
+	}
+	if (len < 10) {
+		puts("Error: gunzip out of data in header\n");
+		goto out_free;
+	}
+	i = 10;
+	flags = src[3];
+	if (src[2] != DEFLATED || (flags & RESERVED) != 0) {
+		puts("Error: Bad gzipped data\n");
+		goto out_free;
+	}
+	if ((flags & EXTRA_FIELD) != 0)
+		i = 12 + src[10] + (src[11] << 8);
+	if ((flags & ORIG_NAME) != 0)
+		while (i < len && src[i++] != 0)
+			;
+	if ((flags & COMMENT) != 0)
+		while (i < len && src[i++] != 0)
+			;
+	if ((flags & HEAD_CRC) != 0)
+		i += 2;
+	if (i >= len) {
+		puts("Error: gunzip out of data in header\n");
+		goto out_free;
+	}
+
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+	r = inflateInit2(&s, -MAX_WBITS);
+	if (r != Z_OK) {
+		printf("Error: inflateInit2() returned %d\n", r);
+		goto out_free;
+	}
+	s.next_in = src + i;
+	s.avail_in = len - i;
+	s.next_out = dst;
+	s.avail_out = dstlen;
+
+	do {
+		if (!s.avail_in) {
+			len = read(priv, src, GUNZIP_STREAM_CHUNK);
+			if (len <= 0) {
+				ret = len ? len : -EINVAL;
+				puts("Error: gunzip out of data\n");
+				goto out;
+			}
+			s.next_in = src;
+			s.avail_in = len;
+			WATCHDOG_RESET();
+		}
+		r = inflate(&s, Z_NO_FLUSH);
+		if (r == Z_BUF_ERROR && !s.avail_out) {
+			ret = -ENOBUFS;
+			goto out;
+		}
+		if (r != Z_OK && r != Z_STREAM_END) {
+			printf("Error: inflate() returned %d\n", r);
+			goto out;
+		}
+	} while (r != Z_STREAM_END);
+	ret = 0;
+
+out:
+	*lenp = s.next_out - (unsigned char *)dst;
+	inflateEnd(&s);
+out_free:
+	free(src);
+
+	return ret;
+}
+
 #ifdef CONFIG_CMD_UNZIP
 __weak
 void gzwrite_progress_init(u64 expectedsize)
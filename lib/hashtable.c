@@ -15,6 +15,7 @@
 
 #include <errno.h>
 #include <malloc.h>
+#include <arena.h>
 
 #ifdef USE_HOSTCC		/* HOST build */
 # include <string.h>
@@ -59,13 +60,94 @@
 
 typedef struct _ENTRY {
 	int used;
+	unsigned int export_off;	/* Offset in htab->export_buf */
 	ENTRY entry;
 } _ENTRY;
 
+/* Size of each block of strings allocated by himport_r() */
+#define HSTRINGS_BLOCK_SIZE	4096
+
 
 static void _hdelete(const char *key, struct hsearch_data *htab, ENTRY *ep,
 	int idx);
 
+/*
+ * Strings in the table come from malloc(), except those added by
+ * himport_r(), which are carved from htab->strings and freed with it.
+ */
+static void hfree_string(struct hsearch_data *htab, const char *str)
+{
+	if (!arena_contains(htab->strings, str))
+		free((void *)str);
+}
+
+static void hfree_entry(struct hsearch_data *htab, ENTRY *ep)
+{
+	hfree_string(htab, ep->key);
+	hfree_string(htab, ep->data);
+}
+
+/*
+ * Find the position of a key in the sorted list of entries, or where it
+ * would be inserted if it is not there
+ */
+static unsigned int hsorted_find(struct hsearch_data *htab, const char *key)
+{
+	unsigned int low = 0, high = htab->filled;
+
+	while (low < high) {
+		unsigned int mid = (low + high) / 2;
+
+		if (strcmp(htab->sorted[mid]->entry.key, key) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/* Note that the entry at position 'pos' in sort order has changed */
+static void hexport_changed(struct hsearch_data *htab, unsigned int pos)
+{
+	if (htab->export_valid > pos)
+		htab->export_valid = pos;
+}
+
+/* Add a new entry to the sorted list; call before incrementing filled */
+static void hsorted_add(struct hsearch_data *htab, _ENTRY *ep)
+{
+	unsigned int pos;
+
+	if (!htab->sorted_ok)
+		return;
+	pos = hsorted_find(htab, ep->entry.key);
+	memmove(&htab->sorted[pos + 1], &htab->sorted[pos],
+		(htab->filled - pos) * sizeof(*htab->sorted));
+	htab->sorted[pos] = ep;
+	hexport_changed(htab, pos);
+}
+
+/* Remove an entry from the sorted list; call before decrementing filled */
+static void hsorted_remove(struct hsearch_data *htab, _ENTRY *ep)
+{
+	unsigned int pos;
+
+	if (!htab->sorted_ok)
+		return;
+	pos = hsorted_find(htab, ep->entry.key);
+	memmove(&htab->sorted[pos], &htab->sorted[pos + 1],
+		(htab->filled - pos - 1) * sizeof(*htab->sorted));
+	hexport_changed(htab, pos);
+}
+
+/* Note that the value of an entry has changed */
+static void hsorted_update(struct hsearch_data *htab, _ENTRY *ep)
+{
+	if (htab->sorted_ok)
+		hexport_changed(htab, hsorted_find(htab, ep->entry.key));
+}
+
 /*
  * hcreate()
  */
@@ -121,6 +203,14 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
 	htab->table = (_ENTRY *) calloc(htab->size + 1, sizeof(_ENTRY));
 	if (htab->table == NULL)
 		return 0;
+	htab->sorted = calloc(htab->size, sizeof(*htab->sorted));
+	if (!htab->sorted) {
+		free(htab->table);
+		htab->table = NULL;
+		return 0;
+	}
+	htab->sorted_ok = 1;
+	htab->export_valid = 0;
 
 	/* everything went alright */
 	return 1;
@@ -148,17 +238,19 @@ void hdestroy_r(struct hsearch_data *htab)
 
 	/* free used memory */
 	for (i = 1; i <= htab->size; ++i) {
-		if (htab->table[i].used > 0) {
-			ENTRY *ep = &htab->table[i].entry;
-
-			free((void *)ep->key);
-			free(ep->data);
-		}
+		if (htab->table[i].used > 0)
+			hfree_entry(htab, &htab->table[i].entry);
 	}
 	free(htab->table);
+	free(htab->sorted);
+	free(htab->export_buf);
+	arena_destroy(htab->strings);
 
 	/* the sign for an existing table is an value != NULL in htable */
 	htab->table = NULL;
+	htab->sorted = NULL;
+	htab->export_buf = NULL;
+	htab->strings = NULL;
 }
 
 /*
@@ -224,8 +316,10 @@ int hmatch_r(const char *match, int last_idx, ENTRY ** retval,
  */
 static inline int _compare_and_overwrite_entry(ENTRY item, ACTION action,
 	ENTRY **retval, struct hsearch_data *htab, int flag,
-	unsigned int hval, unsigned int idx)
+	unsigned int hval, unsigned int idx, int copy)
 {
+	char *data;
+
 	if (htab->table[idx].used == hval
 	    && strcmp(item.key, htab->table[idx].entry.key) == 0) {
 		/* Overwrite existing value? */
@@ -252,13 +346,15 @@ static inline int _compare_and_overwrite_entry(ENTRY item, ACTION action,
 				return 0;
 			}
 
-			free(htab->table[idx].entry.data);
-			htab->table[idx].entry.data = strdup(item.data);
-			if (!htab->table[idx].entry.data) {
+			data = copy ? strdup(item.data) : item.data;
+			if (!data) {
 				__set_errno(ENOMEM);
 				*retval = NULL;
 				return 0;
 			}
+			hfree_string(htab, htab->table[idx].entry.data);
+			htab->table[idx].entry.data = data;
+			hsorted_update(htab, &htab->table[idx]);
 		}
 		/* return found entry */
 		*retval = &htab->table[idx].entry;
@@ -268,22 +364,30 @@ static inline int _compare_and_overwrite_entry(ENTRY item, ACTION action,
 	return -1;
 }
 
-int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
-	      struct hsearch_data *htab, int flag)
+/*
+ * If 'copy' is 0, the key and data of a new or changed entry are used as
+ * they are rather than being copied. The caller must have allocated them
+ * from htab->strings.
+ */
+static int _hsearch_r(ENTRY item, ACTION action, ENTRY **retval,
+		      struct hsearch_data *htab, int flag, int copy)
 {
 	unsigned int hval;
-	unsigned int count;
-	unsigned int len = strlen(item.key);
+	const char *s;
 	unsigned int idx;
 	unsigned int first_deleted = 0;
 	int ret;
 
-	/* Compute an value for the given string. Perhaps use a better method. */
-	hval = len;
-	count = len;
-	while (count-- > 0) {
-		hval <<= 4;
-		hval += item.key[count];
+	/*
+	 * Compute a value for the given string (32-bit FNV-1a). Every
+	 * character affects the result, so long keys which only differ at
+	 * the end (e.g. "board_serial_0001" and "board_serial_0002") are
+	 * spread across the table.
+	 */
+	hval = 2166136261U;
+	for (s = item.key; *s; s++) {
+		hval ^= (unsigned char)*s;
+		hval *= 16777619;
 	}
 
 	/*
@@ -309,7 +413,7 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 			first_deleted = idx;
 
 		ret = _compare_and_overwrite_entry(item, action, retval, htab,
-			flag, hval, idx);
+			flag, hval, idx, copy);
 		if (ret != -1)
 			return ret;
 
@@ -338,7 +442,7 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 
 			/* If entry is found use it. */
 			ret = _compare_and_overwrite_entry(item, action, retval,
-				htab, flag, hval, idx);
+				htab, flag, hval, idx, copy);
 			if (ret != -1)
 				return ret;
 		}
@@ -364,16 +468,24 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 		if (first_deleted)
 			idx = first_deleted;
 
-		htab->table[idx].used = hval;
-		htab->table[idx].entry.key = strdup(item.key);
-		htab->table[idx].entry.data = strdup(item.data);
-		if (!htab->table[idx].entry.key ||
-		    !htab->table[idx].entry.data) {
-			__set_errno(ENOMEM);
-			*retval = NULL;
-			return 0;
+		if (copy) {
+			htab->table[idx].entry.key = strdup(item.key);
+			htab->table[idx].entry.data = strdup(item.data);
+			if (!htab->table[idx].entry.key ||
+			    !htab->table[idx].entry.data) {
+				free((void *)htab->table[idx].entry.key);
+				free(htab->table[idx].entry.data);
+				__set_errno(ENOMEM);
+				*retval = NULL;
+				return 0;
+			}
+		} else {
+			htab->table[idx].entry.key = item.key;
+			htab->table[idx].entry.data = item.data;
 		}
+		htab->table[idx].used = hval;
 
+		hsorted_add(htab, &htab->table[idx]);
 		++htab->filled;
 
 		/* This is a new entry, so look up a possible callback */
@@ -414,6 +526,12 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
 	return 0;
 }
 
+int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
+	      struct hsearch_data *htab, int flag)
+{
+	return _hsearch_r(item, action, retval, htab, flag, 1);
+}
+
 
 /*
  * hdelete()
@@ -430,8 +548,8 @@ static void _hdelete(const char *key, struct hsearch_data *htab, ENTRY *ep,
 {
 	/* free used ENTRY */
 	debug("hdelete: DELETING key \"%s\"\n", key);
-	free((void *)ep->key);
-	free(ep->data);
+	hsorted_remove(htab, &htab->table[idx]);
+	hfree_entry(htab, ep);
 	ep->callback = NULL;
 	ep->flags = 0;
 	htab->table[idx].used = -1;
@@ -522,10 +640,99 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
 
 static int cmpkey(const void *p1, const void *p2)
 {
-	ENTRY *e1 = *(ENTRY **) p1;
-	ENTRY *e2 = *(ENTRY **) p2;
+	_ENTRY *e1 = *(_ENTRY **) p1;
+	_ENTRY *e2 = *(_ENTRY **) p2;
+
+	return (strcmp(e1->entry.key, e2->entry.key));
+}
+
+/* Sort the entries by key, unless the sorted list is already up to date */
+static void hsort(struct hsearch_data *htab)
+{
+	int i, n;
 
-	return (strcmp(e1->key, e2->key));
+	if (htab->sorted_ok)
+		return;
+	for (i = 1, n = 0; i <= htab->size; ++i) {
+		if (htab->table[i].used > 0)
+			htab->sorted[n++] = &htab->table[i];
+	}
+	qsort(htab->sorted, n, sizeof(*htab->sorted), cmpkey);
+	htab->sorted_ok = 1;
+	htab->export_valid = 0;
+}
+
+/* Length of a "name=value" entry with '\0' separators, including escapes */
+static size_t hexport_len(const ENTRY *ep)
+{
+	const char *s;
+	size_t len;
+
+	len = strlen(ep->key) + 2;
+	for (s = ep->data; *s; s++)
+		len += *s == '\\' ? 2 : 1;
+
+	return len;
+}
+
+/*
+ * Bring htab->export_buf up to date with all entries, separated by '\0'.
+ * The text for the entries before the first one which has changed is kept,
+ * so after a few calls to setenv() only the end of the buffer is rebuilt.
+ * Returns 0 if OK, or -ENOMEM if the buffer could not be allocated.
+ */
+static int hexport_update(struct hsearch_data *htab)
+{
+	unsigned int i, n = htab->filled;
+	size_t len, start = 0;
+	char *buf, *p;
+
+	hsort(htab);
+	/*
+	 * Removing the entry which sorts last leaves export_valid == n, but
+	 * the text still holds that entry
+	 */
+	if (htab->export_buf && htab->export_valid == n &&
+	    htab->export_count == n)
+		return 0;
+	if (!htab->export_buf)
+		htab->export_valid = 0;
+
+	/* The kept text ends after the last unchanged entry */
+	if (htab->export_valid) {
+		_ENTRY *ep = htab->sorted[htab->export_valid - 1];
+
+		start = ep->export_off + hexport_len(&ep->entry);
+	}
+	for (i = htab->export_valid, len = start; i < n; i++)
+		len += hexport_len(&htab->sorted[i]->entry);
+
+	buf = realloc(htab->export_buf, len + 1);
+	if (!buf)
+		return -ENOMEM;
+	htab->export_buf = buf;
+
+	for (i = htab->export_valid, p = buf + start; i < n; i++) {
+		ENTRY *ep = &htab->sorted[i]->entry;
+		const char *s;
+
+		htab->sorted[i]->export_off = p - buf;
+		for (s = ep->key; *s; )
+			*p++ = *s++;
+		*p++ = '=';
+		for (s = ep->data; *s; ) {
+			if (*s == '\\')
+				*p++ = '\\';	/* escape */
+			*p++ = *s++;
+		}
+		*p++ = '\0';
+	}
+	*p = '\0';
+	htab->export_len = len;
+	htab->export_count = n;
+	htab->export_valid = n;
+
+	return 0;
 }
 
 static int match_string(int flag, const char *str, const char *pat, void *priv)
@@ -594,6 +801,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 	ENTRY *list[htab->size];
 	char *res, *p;
 	size_t totlen;
+	int cached;
 	int i, n;
 
 	/* Test for correct arguments.  */
@@ -604,15 +812,27 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 
 	debug("EXPORT  table = %p, htab.size = %d, htab.filled = %d, "
 		"size = %zu\n", htab, htab->size, htab->filled, size);
+
 	/*
-	 * Pass 1:
-	 * search used entries,
-	 * save addresses and compute total length
+	 * Exporting everything with '\0' separators (e.g. for saveenv) can
+	 * use the cached result, which only needs updating for the entries
+	 * which have changed since the last export.
 	 */
-	for (i = 1, n = 0, totlen = 0; i <= htab->size; ++i) {
-
-		if (htab->table[i].used > 0) {
-			ENTRY *ep = &htab->table[i].entry;
+	cached = sep == '\0' && !argc && !(flag & H_HIDE_DOT) &&
+		!hexport_update(htab);
+	n = 0;
+	if (cached) {
+		/* At least the size that pass 1 would come up with */
+		totlen = htab->export_len + 2 * htab->filled;
+	} else {
+		/*
+		 * Pass 1:
+		 * search used entries in key order,
+		 * save addresses and compute total length
+		 */
+		hsort(htab);
+		for (i = 0, totlen = 0; i < htab->filled; ++i) {
+			ENTRY *ep = &htab->sorted[i]->entry;
 			int found = match_entry(ep, flag, argc, argv);
 
 			if ((argc > 0) && (found == 0))
@@ -643,17 +863,14 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 	}
 
 #ifdef DEBUG
-	/* Pass 1a: print unsorted list */
-	printf("Unsorted: n=%d\n", n);
+	/* Pass 1a: print list */
+	printf("Sorted: n=%d\n", n);
 	for (i = 0; i < n; ++i) {
 		printf("\t%3d: %p ==> %-10s => %s\n",
 		       i, list[i], list[i]->key, list[i]->data);
 	}
 #endif
 
-	/* Sort list by keys */
-	qsort(list, n, sizeof(ENTRY *), cmpkey);
-
 	/* Check if the user supplied buffer size is sufficient */
 	if (size) {
 		if (size < totlen + 1) {	/* provided buffer too small */
@@ -679,6 +896,12 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 			return (-1);
 		}
 	}
+
+	if (cached) {
+		memcpy(res, htab->export_buf, htab->export_len + 1);
+		return size;
+	}
+
 	/*
 	 * Pass 2:
 	 * export sorted list of result data
@@ -780,6 +1003,8 @@ int himport_r(struct hsearch_data *htab,
 {
 	char *data, *sp, *dp, *name, *value;
 	char *localvars[nvars];
+	size_t max_size;
+	int copy;
 	int i;
 
 	/* Test for correct arguments.  */
@@ -788,16 +1013,6 @@ int himport_r(struct hsearch_data *htab,
 		return 0;
 	}
 
-	/* we allocate new space to make sure we can write to the array */
-	if ((data = malloc(size + 1)) == NULL) {
-		debug("himport_r: can't malloc %zu bytes\n", size + 1);
-		__set_errno(ENOMEM);
-		return 0;
-	}
-	memcpy(data, env, size);
-	data[size] = '\0';
-	dp = data;
-
 	/* make a local copy of the list of variables */
 	if (nvars)
 		memcpy(localvars, vars, sizeof(vars[0]) * nvars);
@@ -810,6 +1025,40 @@ int himport_r(struct hsearch_data *htab,
 			hdestroy_r(htab);
 	}
 
+	/*
+	 * We copy the data to make sure we can write to the array. The names
+	 * and values are parsed in place. When importing into an empty table
+	 * the hash table points straight at them, so the copy is kept (in
+	 * htab->strings) rather than making a copy of each string. With
+	 * H_NOCLEAR, entries already in the table may be replaced, which
+	 * would leave their strings behind in htab->strings on every import,
+	 * so each string is copied and the buffer freed instead. Stored
+	 * environments are padded with NULs, which are left out.
+	 */
+	max_size = size;
+	while (size && !env[size - 1])
+		size--;
+	copy = htab->table && htab->filled;
+	if (copy) {
+		data = malloc(size + 1);
+	} else {
+		/* Nothing points into the strings, so their space can be reused */
+		if (htab->strings)
+			arena_reset(htab->strings);
+		else
+			htab->strings = arena_create(HSTRINGS_BLOCK_SIZE);
+		data = htab->strings ?
+			arena_alloc(htab->strings, size + 1) : NULL;
+	}
+	if (!data) {
+		debug("himport_r: can't malloc %zu bytes\n", size + 1);
+		__set_errno(ENOMEM);
+		return 0;
+	}
+	memcpy(data, env, size);
+	data[size] = '\0';
+	dp = data;
+
 	/*
 	 * Create new hash table (if needed).  The computation of the hash
 	 * table size is based on heuristics: in a sample of some 70+
@@ -829,21 +1078,27 @@ int himport_r(struct hsearch_data *htab,
 	 */
 
 	if (!htab->table) {
-		int nent = CONFIG_ENV_MIN_ENTRIES + size / 8;
+		int nent = CONFIG_ENV_MIN_ENTRIES + max_size / 8;
 
 		if (nent > CONFIG_ENV_MAX_ENTRIES)
 			nent = CONFIG_ENV_MAX_ENTRIES;
 
 		debug("Create Hash Table: N=%d\n", nent);
 
-		if (hcreate_r(nent, htab) == 0) {
-			free(data);
+		if (hcreate_r(nent, htab) == 0)
 			return 0;
-		}
 	}
 
+	/*
+	 * Sorting the entries once on the next export is quicker than
+	 * keeping them sorted while filling an empty table.
+	 */
+	if (!htab->filled)
+		htab->sorted_ok = 0;
+
 	if (!size) {
-		free(data);
+		if (copy)
+			free(data);
 		return 1;		/* everything OK */
 	}
 	if(crlf_is_lf) {
@@ -908,8 +1163,9 @@ int himport_r(struct hsearch_data *htab,
 
 		if (*name == 0) {
 			debug("INSERT: unable to use an empty key\n");
+			if (copy)
+				free(data);
 			__set_errno(EINVAL);
-			free(data);
 			return 0;
 		}
 
@@ -921,7 +1177,7 @@ int himport_r(struct hsearch_data *htab,
 		e.key = name;
 		e.data = value;
 
-		hsearch_r(e, ENTER, &rv, htab, flag);
+		_hsearch_r(e, ENTER, &rv, htab, flag, copy);
 		if (rv == NULL)
 			printf("himport_r: can't insert \"%s=%s\" into hash table\n",
 				name, value);
@@ -931,8 +1187,8 @@ int himport_r(struct hsearch_data *htab,
 			rv, name, value);
 	} while ((dp < data + size) && *dp);	/* size check needed for text */
 						/* without '\0' termination */
-	debug("INSERT: free(data = %p)\n", data);
-	free(data);
+	if (copy)
+		free(data);
 
 	/* process variables which were not considered */
 	for (i = 0; i < nvars; i++) {
@@ -16,19 +16,36 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 
 	for (init_fnc_ptr = init_sequence; *init_fnc_ptr; ++init_fnc_ptr) {
 		unsigned long reloc_ofs = 0;
+		__maybe_unused bool timed;
+		__maybe_unused ulong start_us;
 		int ret;
 
 		if (gd->flags & GD_FLG_RELOC)
 			reloc_ofs = gd->reloc_off;
 #ifdef CONFIG_EFI_APP
 		reloc_ofs = (unsigned long)image_base;
+#endif
+#ifdef CONFIG_SANDBOX
+		/* Sandbox never moves its code, whatever reloc_off says */
+		reloc_ofs = 0;
 #endif
 		debug("initcall: %p", (char *)*init_fnc_ptr - reloc_ofs);
 		if (gd->flags & GD_FLG_RELOC)
 			debug(" (relocated to %p)\n", (char *)*init_fnc_ptr);
 		else
 			debug("\n");
+#ifdef CONFIG_BOOTSTAGE_INITCALLS
+		timed = bootstage_initcall_ready();
+		if (timed)
+			start_us = timer_get_boot_us();
+#endif
 		ret = (*init_fnc_ptr)();
+#ifdef CONFIG_BOOTSTAGE_INITCALLS
+		if (timed) {
+			bootstage_initcall((ulong)*init_fnc_ptr - reloc_ofs,
+					   start_us);
+		}
+#endif
 		if (ret) {
 			printf("initcall sequence %p failed at call %p (err=%d)\n",
 			       init_sequence,
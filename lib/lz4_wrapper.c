@@ -5,7 +5,10 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <compiler.h>
+#include <errno.h>
+#include <malloc.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
 
@@ -63,6 +66,167 @@ struct lz4_block_header {
 	/* + u32 block_checksum iff has_block_checksum is set */
 } __packed;
 
+#ifdef CONFIG_LZ4_PARALLEL
+/* A single block of a frame, which is decompressed on its own */
+struct lz4_job {
+	const void *in;
+	void *out;
+	u32 size;		/* compressed size */
+	bool not_compressed;
+	int ret;		/* decompressed size, or -ve on error */
+	ulong time_us;		/* time taken to decompress */
+};
+
+struct lz4_jobs {
+	struct lz4_job *job;	/* NULL to just count the blocks */
+	void *dst;
+	const void *end;
+	size_t max_block;
+};
+
+__weak int cpu_run_parallel(void (*func)(void *priv, int index), void *priv,
+			    int count)
+{
+	return -ENOSYS;
+}
+
+static void lz4_run_job(void *priv, int index)
+{
+	struct lz4_jobs *jobs = priv;
+	struct lz4_job *job = &jobs->job[index];
+	size_t space = min((size_t)(jobs->end - job->out), jobs->max_block);
+	ulong start = timer_get_us();
+
+	if (job->not_compressed) {
+		if (job->size <= space) {
+			memcpy(job->out, job->in, job->size);
+			job->ret = job->size;
+		} else {
+			job->ret = -ENOBUFS;
+		}
+	} else {
+		/* constant folding essential, do not touch params! */
+		job->ret = LZ4_decompress_generic(job->in, job->out, job->size,
+				space, endOnInputSize,
+				full, 0, noDict, job->out, NULL, 0);
+	}
+	job->time_us = timer_get_us() - start;
+}
+
+/* Walk the blocks of a frame, returning the number of blocks or -ve error */
+static int lz4_scan_blocks(const void *src, size_t srcn, const void *in,
+			   int has_block_checksum, struct lz4_jobs *jobs)
+{
+	int count = 0;
+
+	while (1) {
+		struct lz4_block_header b;
+
+		if (in - src + sizeof(b) > srcn)
+			return -EINVAL;		/* input overrun */
+		b.raw = le32_to_cpu(*(u32 *)in);
+		in += sizeof(struct lz4_block_header);
+		if (!b.size)
+			return count;
+		if (in - src + b.size > srcn || b.size > jobs->max_block)
+			return -EINVAL;
+
+		if (jobs->job) {
+			struct lz4_job *job = &jobs->job[count];
+
+			job->in = in;
+			job->out = jobs->dst + count * jobs->max_block;
+			job->size = b.size;
+			job->not_compressed = b.not_compressed;
+		}
+		count++;
+
+		in += b.size;
+		if (has_block_checksum)
+			in += sizeof(u32);
+	}
+}
+
+/*
+ * Decompress all blocks of a frame at once, using whatever CPUs are
+ * available. This relies on every block except the last decompressing to
+ * exactly the maximum block size, which is what the reference encoder
+ * produces, so that the output position of each block is known in advance.
+ *
+ * Returns 0 on success. On failure ulz4fn() falls back to decompressing the
+ * frame serially, which also takes care of reporting any error properly.
+ */
+static int ulz4fn_parallel(const void *src, size_t srcn, void *dst,
+			   size_t *dstn)
+{
+	const struct lz4_frame_header *h = src;
+	const void *end = dst + *dstn;
+	struct lz4_jobs jobs;
+	ulong start, elapsed, cpu_us;
+	const void *in;
+	int count, cpus, i;
+	int ret;
+
+	if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8))
+		return -EINVAL;
+	if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1 ||
+	    !h->independent_blocks || h->max_block_size < 4)
+		return -EPROTONOSUPPORT;
+	/* In-place decompression relies on the blocks being done in order */
+	if (src < end && dst < src + srcn)
+		return -EINVAL;
+
+	in = src + sizeof(*h) + (h->has_content_size ? sizeof(u64) : 0) +
+		sizeof(u8);
+	jobs.job = NULL;
+	jobs.dst = dst;
+	jobs.end = end;
+	jobs.max_block = 1 << (8 + 2 * h->max_block_size);
+
+	count = lz4_scan_blocks(src, srcn, in, h->has_block_checksum, &jobs);
+	if (count < 2)
+		return -EINVAL;		/* nothing to be gained */
+	if ((count - 1) * jobs.max_block >= *dstn)
+		return -ENOBUFS;
+
+	jobs.job = malloc(count * sizeof(*jobs.job));
+	if (!jobs.job)
+		return -ENOMEM;
+	lz4_scan_blocks(src, srcn, in, h->has_block_checksum, &jobs);
+
+	start = timer_get_us();
+	cpus = cpu_run_parallel(lz4_run_job, &jobs, count);
+	elapsed = timer_get_us() - start;
+	if (cpus < 0) {
+		ret = cpus;
+		goto out;
+	}
+
+	ret = 0;
+	cpu_us = 0;
+	for (i = 0; i < count; i++) {
+		const struct lz4_job *job = &jobs.job[i];
+
+		if (job->ret < 0 ||
+		    (i < count - 1 && job->ret != jobs.max_block))
+			ret = -EPROTO;
+		cpu_us += job->time_us;
+	}
+	if (ret)
+		goto out;
+
+	*dstn = (count - 1) * jobs.max_block + jobs.job[count - 1].ret;
+	bootstage_accum_time(BOOTSTAGE_ID_ACCUM_LZ4, "lz4_parallel", elapsed);
+	bootstage_accum_time(BOOTSTAGE_ID_ACCUM_LZ4_CPU, "lz4_blocks", cpu_us);
+	debug("lz4: %d blocks on %d CPUs in %lu us (%lu us of block time)\n",
+	      count, cpus, elapsed, cpu_us);
+out:
+	free(jobs.job);
+
+	return ret;
+}
+#endif /* CONFIG_LZ4_PARALLEL */
+
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 {
 	const void *end = dst + *dstn;
@@ -70,6 +234,11 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 	void *out = dst;
 	int has_block_checksum;
 	int ret;
+
+#ifdef CONFIG_LZ4_PARALLEL
+	if (!ulz4fn_parallel(src, srcn, dst, dstn))
+		return 0;
+#endif
 	*dstn = 0;
 
 	{ /* With in-place decompression the header may become invalid later. */
@@ -137,3 +306,113 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 	*dstn = out - dst;
 	return ret;
 }
+
+/* Read exactly @size bytes from the stream, or fail */
+static int lz4_read_full(decomp_read_func read, void *priv, void *buf,
+			 size_t size)
+{
+	int ret;
+
+	while (size) {
+		ret = read(priv, buf, size);
+		if (ret < 0)
+			return ret;
+		if (!ret)
+			return -EINVAL;	/* input overrun */
+		buf += ret;
+		size -= ret;
+	}
+
+	return 0;
+}
+
+int ulz4fn_stream(decomp_read_func read, void *priv, void *dst, size_t *dstn)
+{
+	const void *end = dst + *dstn;
+	struct lz4_frame_header h;
+	void *out = dst;
+	size_t max_block;
+	void *block;
+	u8 skip[sizeof(u64) + sizeof(u8)];
+	int ret;
+
+	*dstn = 0;
+	ret = lz4_read_full(read, priv, &h, sizeof(h));
+	if (ret)
+		return ret;
+
+	if (le32_to_cpu(h.magic) != LZ4F_MAGIC || h.version != 1)
+		return -EPROTONOSUPPORT;	/* unknown format */
+	if (h.reserved0 || h.reserved1 || h.reserved2)
+		return -EINVAL;	/* reserved must be zero */
+	if (!h.independent_blocks)
+		return -EPROTONOSUPPORT; /* we can't support this yet */
+	if (h.max_block_size < 4)
+		return -EINVAL;	/* reserved block size values */
+
+	/* Skip the content size and header checksum */
+	ret = lz4_read_full(read, priv, skip,
+			    (h.has_content_size ? sizeof(u64) : 0) + sizeof(u8));
+	if (ret)
+		return ret;
+
+	/* Block sizes are 64KB, 256KB, 1MB or 4MB */
+	max_block = 1 << (8 + 2 * h.max_block_size);
+	block = malloc(max_block);
+	if (!block)
+		return -ENOMEM;
+
+	while (1) {
+		struct lz4_block_header b;
+
+		ret = lz4_read_full(read, priv, &b.raw, sizeof(b.raw));
+		if (ret)
+			break;
+		b.raw = le32_to_cpu(b.raw);
+
+		if (!b.size) {
+			ret = 0;	/* decompression successful */
+			break;
+		}
+		if (b.size > max_block) {
+			ret = -EINVAL;
+			break;
+		}
+
+		if (b.not_compressed) {
+			size_t size = min((ptrdiff_t)b.size, end - out);
+
+			ret = lz4_read_full(read, priv, out, size);
+			if (ret)
+				break;
+			out += size;
+			if (size < b.size) {
+				ret = -ENOBUFS;	/* output overrun */
+				break;
+			}
+		} else {
+			ret = lz4_read_full(read, priv, block, b.size);
+			if (ret)
+				break;
+			/* constant folding essential, do not touch params! */
+			ret = LZ4_decompress_generic(block, out, b.size,
+					end - out, endOnInputSize,
+					full, 0, noDict, out, NULL, 0);
+			if (ret < 0) {
+				ret = -EPROTO;	/* decompression error */
+				break;
+			}
+			out += ret;
+		}
+
+		if (h.has_block_checksum) {
+			ret = lz4_read_full(read, priv, skip, sizeof(u32));
+			if (ret)
+				break;
+		}
+	}
+	free(block);
+
+	*dstn = out - dst;
+	return ret;
+}
@@ -121,4 +121,96 @@ int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
     return res;
 }
 
+/* Number of compressed bytes read at a time by lzmaStreamDecompress() */
+#define LZMA_STREAM_CHUNK      (64 << 10)
+
+int lzmaStreamDecompress(unsigned char *outStream, SizeT *uncompressedSize,
+                         decomp_read_func read, void *priv)
+{
+    unsigned char header[LZMA_DATA_OFFSET];
+    unsigned char *inBuf;
+    SizeT outSize, inPos = 0, inLen = 0;
+    uint64_t fullSize = 0;
+    ELzmaFinishMode finishMode;
+    ELzmaStatus status;
+    ISzAlloc g_Alloc;
+    CLzmaDec dec;
+    int res, len, i;
+
+    /* Read the properties and uncompressed size */
+    for (i = 0; i < sizeof(header); i += len) {
+        len = read(priv, header + i, sizeof(header) - i);
+        if (len <= 0)
+            return SZ_ERROR_INPUT_EOF;
+    }
+    for (i = 0; i < 8; i++)
+        fullSize |= (uint64_t)header[LZMA_SIZE_OFFSET + i] << (i * 8);
+
+    /* Short-circuit early if we know the buffer can't hold the results. */
+    if (fullSize != (uint64_t)-1 && *uncompressedSize < fullSize)
+        return SZ_ERROR_OUTPUT_EOF;
+    if (fullSize == (uint64_t)-1) {
+        /* The stream must end with a marker once the buffer is full */
+        outSize = *uncompressedSize;
+        finishMode = LZMA_FINISH_END;
+    } else {
+        outSize = fullSize;
+        finishMode = LZMA_FINISH_ANY;
+    }
+    *uncompressedSize = 0;
+
+    inBuf = malloc(LZMA_STREAM_CHUNK);
+    if (!inBuf)
+        return SZ_ERROR_MEM;
+
+    g_Alloc.Alloc = SzAlloc;
+    g_Alloc.Free = SzFree;
+    LzmaDec_Construct(&dec);
+    res = LzmaDec_AllocateProbs(&dec, header, LZMA_PROPS_SIZE, &g_Alloc);
+    if (res != SZ_OK)
+        goto out;
+    dec.dic = outStream;
+    dec.dicBufSize = outSize;
+    LzmaDec_Init(&dec);
+
+    do {
+        SizeT inProcessed;
+
+        if (inPos == inLen) {
+            len = read(priv, inBuf, LZMA_STREAM_CHUNK);
+            if (len < 0) {
+                res = SZ_ERROR_READ;
+                break;
+            }
+            inPos = 0;
+            inLen = len;
+            WATCHDOG_RESET();
+        }
+        inProcessed = inLen - inPos;
+        res = LzmaDec_DecodeToDic(&dec, outSize, inBuf + inPos,
+                                  &inProcessed, finishMode, &status);
+        inPos += inProcessed;
+        if (res != SZ_OK)
+            break;
+        if (status == LZMA_STATUS_FINISHED_WITH_MARK ||
+            status == LZMA_STATUS_MAYBE_FINISHED_WITHOUT_MARK)
+            break;
+        if (finishMode == LZMA_FINISH_ANY && dec.dicPos == outSize)
+            break;
+        if (!inLen) {
+            /* End of input: fine unless the decoder wanted more */
+            if (status == LZMA_STATUS_NEEDS_MORE_INPUT)
+                res = SZ_ERROR_INPUT_EOF;
+            break;
+        }
+    } while (1);
+
+    *uncompressedSize = dec.dicPos;
+    LzmaDec_FreeProbs(&dec, &g_Alloc);
+out:
+    free(inBuf);
+
+    return res;
+}
+
 #endif
@@ -16,4 +16,12 @@
 
 extern int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
 			      unsigned char *inStream,  SizeT  length);
+
+/*
+ * Like lzmaBuffToBuffDecompress(), but reads the compressed stream in
+ * chunks through @read rather than from a buffer in memory.
+ */
+extern int lzmaStreamDecompress(unsigned char *outStream,
+				SizeT *uncompressedSize,
+				decomp_read_func read, void *priv);
 #endif
@@ -0,0 +1,333 @@
+/*
+ * Live (unflattened) device tree
+ *
+ * The flat tree is walked once and each node's properties, parent, first
+ * child and next sibling are recorded in arrays, along with a sorted table
+ * of phandles. Nodes keep their flat-tree offsets so that existing callers
+ * can carry on passing offsets around.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <libfdt.h>
+#include <malloc.h>
+#include <of_live.h>
+
+struct of_live_phandle {
+	uint32_t phandle;
+	int node;
+};
+
+struct of_live {
+	const void *blob;
+	uint32_t size_struct;	/* To detect changes to the flat tree */
+	uint32_t size_strings;
+	struct of_live_node *nodes;
+	struct of_live_prop *props;
+	struct of_live_phandle *phandles;
+	struct of_live_stats stats;
+};
+
+static struct of_live *live;
+
+static int find_node(int offset)
+{
+	int low = 0, high = live->stats.nodes;
+
+	while (low < high) {
+		int mid = (low + high) / 2;
+
+		if (live->nodes[mid].offset == offset)
+			return mid;
+		if (live->nodes[mid].offset < offset)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return -1;
+}
+
+static int phandle_cmp(const void *a, const void *b)
+{
+	const struct of_live_phandle *pa = a, *pb = b;
+
+	if (pa->phandle == pb->phandle)
+		return 0;
+
+	return pa->phandle < pb->phandle ? -1 : 1;
+}
+
+/* Count the nodes and properties so that everything fits in one block */
+static int count_tree(const void *blob, int *nodesp, int *propsp)
+{
+	int nodes = 0, props = 0;
+	int offset, prop, depth = 0;
+
+	for (offset = 0; offset >= 0 && depth >= 0;
+	     offset = fdt_next_node(blob, offset, &depth)) {
+		if (depth >= FDT_MAX_DEPTH)
+			return -EINVAL;
+		nodes++;
+		for (prop = fdt_first_property_offset(blob, offset); prop >= 0;
+		     prop = fdt_next_property_offset(blob, prop))
+			props++;
+	}
+	if (offset != -FDT_ERR_NOTFOUND && depth >= 0)
+		return -EINVAL;
+	*nodesp = nodes;
+	*propsp = props;
+
+	return 0;
+}
+
+int of_live_build(const void *blob)
+{
+	int last[FDT_MAX_DEPTH];	/* Last node seen at each depth */
+	struct of_live_prop *prop;
+	struct of_live *tree;
+	int nodes, props, size;
+	int offset, depth = 0;
+	ulong start;
+	int ret, i;
+
+	start = timer_get_us();
+	of_live_free();
+	ret = count_tree(blob, &nodes, &props);
+	if (ret)
+		return ret;
+
+	size = sizeof(*tree) + nodes * sizeof(struct of_live_node) +
+		props * sizeof(struct of_live_prop) +
+		nodes * sizeof(struct of_live_phandle);
+	tree = calloc(1, size);
+	if (!tree)
+		return -ENOMEM;
+	tree->nodes = (struct of_live_node *)(tree + 1);
+	tree->props = (struct of_live_prop *)(tree->nodes + nodes);
+	tree->phandles = (struct of_live_phandle *)(tree->props + props);
+
+	prop = tree->props;
+	for (offset = 0, i = 0; i < nodes;
+	     offset = fdt_next_node(blob, offset, &depth), i++) {
+		struct of_live_node *node = &tree->nodes[i];
+		int poffset;
+
+		node->offset = offset;
+		node->name = fdt_get_name(blob, offset, NULL);
+		node->parent = depth ? last[depth - 1] : -1;
+		node->child = -1;
+		node->sibling = -1;
+		if (depth) {
+			struct of_live_node *parent;
+
+			/* The previous node at this depth is our sibling */
+			parent = &tree->nodes[node->parent];
+			if (parent->child == -1)
+				parent->child = i;
+			else
+				tree->nodes[last[depth]].sibling = i;
+		}
+		last[depth] = i;
+
+		node->props = prop;
+		for (poffset = fdt_first_property_offset(blob, offset);
+		     poffset >= 0;
+		     poffset = fdt_next_property_offset(blob, poffset)) {
+			prop->value = fdt_getprop_by_offset(blob, poffset,
+							    &prop->name,
+							    &prop->len);
+			prop++;
+		}
+		node->prop_count = prop - node->props;
+		node->phandle = fdt_get_phandle(blob, offset);
+		if (node->phandle) {
+			struct of_live_phandle *ph;
+
+			ph = &tree->phandles[tree->stats.phandles++];
+			ph->phandle = node->phandle;
+			ph->node = i;
+		}
+	}
+	qsort(tree->phandles, tree->stats.phandles, sizeof(*tree->phandles),
+	      phandle_cmp);
+
+	tree->blob = blob;
+	tree->size_struct = fdt_size_dt_struct(blob);
+	tree->size_strings = fdt_size_dt_strings(blob);
+	tree->stats.nodes = nodes;
+	tree->stats.props = props;
+	tree->stats.size = size;
+	tree->stats.build_us = timer_get_us() - start;
+	live = tree;
+	debug("%s: %d nodes, %d properties, %d phandles in %lu us\n", __func__,
+	      nodes, props, tree->stats.phandles, tree->stats.build_us);
+
+	return 0;
+}
+
+void of_live_free(void)
+{
+	free(live);
+	live = NULL;
+}
+
+bool of_live_active(const void *blob)
+{
+	return live && blob == live->blob &&
+		fdt_size_dt_struct(blob) == live->size_struct &&
+		fdt_size_dt_strings(blob) == live->size_strings;
+}
+
+const struct of_live_node *of_live_get_node(int offset)
+{
+	int i;
+
+	if (!live)
+		return NULL;
+	i = find_node(offset);
+
+	return i < 0 ? NULL : &live->nodes[i];
+}
+
+const void *of_live_getprop(int offset, const char *name, int *lenp)
+{
+	const struct of_live_prop *prop, *end;
+	int i;
+
+	live->stats.lookups++;
+	i = find_node(offset);
+	if (i < 0) {
+		if (lenp)
+			*lenp = -FDT_ERR_BADOFFSET;
+		return NULL;
+	}
+	prop = live->nodes[i].props;
+	for (end = prop + live->nodes[i].prop_count; prop < end; prop++) {
+		if (*prop->name == *name && !strcmp(prop->name, name)) {
+			if (lenp)
+				*lenp = prop->len;
+			return prop->value;
+		}
+	}
+	if (lenp)
+		*lenp = -FDT_ERR_NOTFOUND;
+
+	return NULL;
+}
+
+int of_live_parent_offset(int offset)
+{
+	int i;
+
+	live->stats.lookups++;
+	i = find_node(offset);
+	if (i < 0)
+		return -FDT_ERR_BADOFFSET;
+	i = live->nodes[i].parent;
+
+	return i < 0 ? -FDT_ERR_NOTFOUND : live->nodes[i].offset;
+}
+
+int of_live_node_offset_by_phandle(uint32_t phandle)
+{
+	int low = 0, high;
+
+	live->stats.lookups++;
+	if (!phandle || phandle == -1)
+		return -FDT_ERR_BADPHANDLE;
+	high = live->stats.phandles;
+	while (low < high) {
+		int mid = (low + high) / 2;
+		struct of_live_phandle *ph = &live->phandles[mid];
+
+		if (ph->phandle == phandle)
+			return live->nodes[ph->node].offset;
+		if (ph->phandle < phandle)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+int of_live_node_offset_by_compatible(int startoffset, const char *compat)
+{
+	int i;
+
+	live->stats.lookups++;
+	if (startoffset < 0) {
+		i = 0;
+	} else {
+		i = find_node(startoffset);
+		if (i < 0)
+			return -FDT_ERR_BADOFFSET;
+		i++;
+	}
+	for (; i < live->stats.nodes; i++) {
+		const struct of_live_node *node = &live->nodes[i];
+		const struct of_live_prop *prop, *end;
+
+		prop = node->props;
+		for (end = prop + node->prop_count; prop < end; prop++) {
+			if (!strcmp(prop->name, "compatible"))
+				break;
+		}
+		if (prop != end &&
+		    fdt_stringlist_contains(prop->value, prop->len, compat))
+			return node->offset;
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+/* Match a path component against a node name, which may have a unit address */
+static bool name_eq(const char *name, const char *comp, int len)
+{
+	if (strncmp(name, comp, len))
+		return false;
+
+	return !name[len] || (!memchr(comp, '@', len) && name[len] == '@');
+}
+
+int of_live_path_offset(const char *path)
+{
+	const char *p = path;
+	int i = 0;
+
+	live->stats.lookups++;
+	if (*path != '/')
+		return -FDT_ERR_BADPATH;
+	while (*p) {
+		const char *q;
+
+		while (*p == '/')
+			p++;
+		if (!*p)
+			break;
+		q = strchr(p, '/');
+		if (!q)
+			q = p + strlen(p);
+		for (i = live->nodes[i].child; i != -1;
+		     i = live->nodes[i].sibling) {
+			if (name_eq(live->nodes[i].name, p, q - p))
+				break;
+		}
+		if (i == -1)
+			return -FDT_ERR_NOTFOUND;
+		p = q;
+	}
+
+	return live->nodes[i].offset;
+}
+
+void of_live_get_stats(struct of_live_stats *stats)
+{
+	if (live)
+		*stats = live->stats;
+	else
+		memset(stats, '\0', sizeof(*stats));
+}
@@ -0,0 +1,168 @@
+/*
+ * Sampling profiler
+ *
+ * Function tracing instruments every call, which slows U-Boot down a lot
+ * and fills its buffer quickly. Instead, record where U-Boot is running at
+ * regular intervals, driven by a timer interrupt (or a signal on sandbox).
+ * Each sample is only a code offset and the caller's offset, so a small
+ * buffer covers the whole boot. proftool turns these into flat and caller
+ * profiles.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <trace.h>
+#include <asm/sections.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static struct trace_sample *samples;
+static ulong sample_size;	/* Number of samples the buffer can hold */
+static ulong sample_count;	/* Number of samples recorded */
+static ulong sample_dropped;	/* Samples lost since the buffer was full */
+static ulong sample_outside;	/* Samples with no address inside U-Boot */
+static unsigned int sample_interval_us;
+static bool profile_running;
+
+/* Convert a code address to an offset, or -1UL if outside U-Boot */
+static inline ulong notrace profile_code_offset(void *addr)
+{
+	ulong offset = (ulong)addr;
+
+#ifdef CONFIG_SANDBOX
+	offset -= (ulong)&_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		offset -= gd->relocaddr;
+	else
+		offset -= CONFIG_SYS_TEXT_BASE;
+#endif
+	return offset < gd->mon_len ? offset : -1UL;
+}
+
+void notrace profile_sample(void *const *addrs, int count)
+{
+	ulong pc = -1UL, caller = TRACE_SAMPLE_NONE;
+	struct trace_sample *rec;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		ulong offset = profile_code_offset(addrs[i]);
+
+		if (offset == -1UL)
+			continue;
+		if (pc != -1UL) {
+			caller = offset;
+			break;
+		}
+		pc = offset;
+	}
+	if (pc == -1UL) {
+		sample_outside++;
+		return;
+	}
+	if (sample_count >= sample_size) {
+		sample_dropped++;
+		return;
+	}
+	rec = &samples[sample_count++];
+	rec->pc = pc;
+	rec->caller = caller;
+}
+
+int profile_init(void *buff, size_t buff_size)
+{
+	if (profile_running)
+		profile_stop();
+	if (buff_size < sizeof(*samples))
+		return -ENOSPC;
+	samples = buff;
+	sample_size = buff_size / sizeof(*samples);
+	sample_count = 0;
+	sample_dropped = 0;
+	sample_outside = 0;
+
+	return 0;
+}
+
+int profile_start(unsigned int interval_us)
+{
+	int ret;
+
+	if (!samples)
+		return -ENOSPC;
+	if (!interval_us)
+		return -EINVAL;
+	if (profile_running)
+		return -EALREADY;
+	ret = arch_profile_start(interval_us);
+	if (ret)
+		return ret;
+	sample_interval_us = interval_us;
+	profile_running = true;
+
+	return 0;
+}
+
+void profile_stop(void)
+{
+	if (!profile_running)
+		return;
+	arch_profile_stop();
+	profile_running = false;
+}
+
+void profile_print_stats(void)
+{
+	if (!samples) {
+		printf("Profiler is not set up\n");
+		return;
+	}
+	printf("Profiler is %s, sampling every %u us\n",
+	       profile_running ? "running" : "stopped", sample_interval_us);
+	print_grouped_ull(sample_count, 10);
+	printf(" samples recorded (space for %lu)\n", sample_size);
+	print_grouped_ull(sample_dropped, 10);
+	puts(" samples dropped as the buffer was full\n");
+	print_grouped_ull(sample_outside, 10);
+	puts(" samples outside U-Boot\n");
+}
+
+int profile_list_samples(void *buff, int buff_size, unsigned *needed)
+{
+	struct trace_output_hdr *output_hdr = NULL;
+	void *end, *ptr = buff;
+	ulong rec, count;
+
+	end = buff ? buff + buff_size : NULL;
+
+	/* Place some header information */
+	if (ptr + sizeof(struct trace_output_hdr) < end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	/* Samples may still be arriving, so take a snapshot of the count */
+	count = sample_count;
+	for (rec = 0; rec < count; rec++) {
+		if (ptr + sizeof(struct trace_sample) < end)
+			memcpy(ptr, &samples[rec], sizeof(struct trace_sample));
+		else
+			break;
+		ptr += sizeof(struct trace_sample);
+	}
+
+	/* Update the header */
+	if (output_hdr) {
+		output_hdr->rec_count = rec;
+		output_hdr->type = TRACE_CHUNK_SAMPLES;
+	}
+
+	/* Work out how much of the buffer we used */
+	*needed = ptr - buff + (count - rec) * sizeof(struct trace_sample);
+	if (rec < count)
+		return -1;
+
+	return 0;
+}
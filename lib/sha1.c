@@ -61,6 +61,7 @@ void sha1_starts (sha1_context * ctx)
 	ctx->state[4] = 0xC3D2E1F0;
 }
 
+#ifndef CONFIG_SHA1_ARMV8_CE
 static void sha1_process(sha1_context *ctx, const unsigned char data[64])
 {
 	unsigned long temp, W[16], A, B, C, D, E;
@@ -214,6 +215,31 @@ static void sha1_process(sha1_context *ctx, const unsigned char data[64])
 	ctx->state[3] += D;
 	ctx->state[4] += E;
 }
+#endif
+
+/*
+ * Process whole 64-byte blocks, using the CPU's SHA-1 support if enabled
+ */
+static void sha1_process_blocks(sha1_context *ctx, const unsigned char *data,
+				unsigned int blocks)
+{
+#ifdef CONFIG_SHA1_ARMV8_CE
+	uint32_t state[5];
+	int i;
+
+	/* The context holds the state as unsigned long */
+	for (i = 0; i < 5; i++)
+		state[i] = ctx->state[i];
+	sha1_armv8_ce_process(state, data, blocks);
+	for (i = 0; i < 5; i++)
+		ctx->state[i] = state[i];
+#else
+	while (blocks--) {
+		sha1_process(ctx, data);
+		data += 64;
+	}
+#endif
+}
 
 /*
  * SHA-1 process buffer
@@ -238,16 +264,16 @@ void sha1_update(sha1_context *ctx, const unsigned char *input,
 
 	if (left && ilen >= fill) {
 		memcpy ((void *) (ctx->buffer + left), (void *) input, fill);
-		sha1_process (ctx, ctx->buffer);
+		sha1_process_blocks(ctx, ctx->buffer, 1);
 		input += fill;
 		ilen -= fill;
 		left = 0;
 	}
 
-	while (ilen >= 64) {
-		sha1_process (ctx, input);
-		input += 64;
-		ilen -= 64;
+	if (ilen >= 64) {
+		sha1_process_blocks(ctx, input, ilen / 64);
+		input += ilen & ~0x3f;
+		ilen &= 0x3f;
 	}
 
 	if (ilen > 0) {
@@ -50,6 +50,7 @@ void sha256_starts(sha256_context * ctx)
 	ctx->state[7] = 0x5BE0CD19;
 }
 
+#ifndef CONFIG_SHA256_ARMV8_CE
 static void sha256_process(sha256_context *ctx, const uint8_t data[64])
 {
 	uint32_t temp1, temp2;
@@ -180,6 +181,21 @@ static void sha256_process(sha256_context *ctx, const uint8_t data[64])
 	ctx->state[6] += G;
 	ctx->state[7] += H;
 }
+#endif
+
+/* Process whole 64-byte blocks, using the CPU's SHA-256 support if enabled */
+static void sha256_process_blocks(sha256_context *ctx, const uint8_t *data,
+				  uint32_t blocks)
+{
+#ifdef CONFIG_SHA256_ARMV8_CE
+	sha256_armv8_ce_process(ctx->state, data, blocks);
+#else
+	while (blocks--) {
+		sha256_process(ctx, data);
+		data += 64;
+	}
+#endif
+}
 
 void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
 {
@@ -199,16 +215,16 @@ void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
 
 	if (left && length >= fill) {
 		memcpy((void *) (ctx->buffer + left), (void *) input, fill);
-		sha256_process(ctx, ctx->buffer);
+		sha256_process_blocks(ctx, ctx->buffer, 1);
 		length -= fill;
 		input += fill;
 		left = 0;
 	}
 
-	while (length >= 64) {
-		sha256_process(ctx, input);
-		length -= 64;
-		input += 64;
+	if (length >= 64) {
+		sha256_process_blocks(ctx, input, length / 64);
+		input += length & ~0x3f;
+		length &= 0x3f;
 	}
 
 	if (length)
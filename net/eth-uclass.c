@@ -20,9 +20,15 @@ DECLARE_GLOBAL_DATA_PTR;
  * struct eth_device_priv - private structure for each Ethernet device
  *
  * @state: The state of the Ethernet MAC driver (defined by enum eth_state_t)
+ * @rx_dest: Where the driver places received data, NULL if nowhere
+ * @rx_offset: Offset in the packet of the data placed at @rx_dest
+ * @rx_placed: true if the driver placed the packet it just received
  */
 struct eth_device_priv {
 	enum eth_state_t state;
+	void *rx_dest;
+	int rx_offset;
+	bool rx_placed;
 };
 
 /**
@@ -312,6 +318,7 @@ void eth_halt(void)
 	eth_get_ops(current)->stop(current);
 	priv = current->uclass_priv;
 	priv->state = ETH_STATE_PASSIVE;
+	priv->rx_dest = NULL;
 }
 
 int eth_is_active(struct udevice *dev)
@@ -345,8 +352,40 @@ int eth_send(void *packet, int length)
 	return ret;
 }
 
+int eth_set_rx_dest(void *dest, int offset, int len)
+{
+	struct udevice *current;
+	struct eth_device_priv *priv;
+	int ret;
+
+	current = eth_get_dev();
+	if (!current)
+		return -ENODEV;
+
+	if (!device_active(current))
+		return -EINVAL;
+
+	if (!eth_get_ops(current)->rx_dest)
+		return -ENOSYS;
+
+	ret = eth_get_ops(current)->rx_dest(current, dest, offset, len);
+	priv = current->uclass_priv;
+	priv->rx_dest = ret ? NULL : dest;
+	priv->rx_offset = offset;
+
+	return ret;
+}
+
+void eth_rx_placed(struct udevice *dev)
+{
+	struct eth_device_priv *priv = dev_get_uclass_priv(dev);
+
+	priv->rx_placed = true;
+}
+
 int eth_rx(void)
 {
+	struct eth_device_priv *priv;
 	struct udevice *current;
 	uchar *packet;
 	int flags;
@@ -361,12 +400,19 @@ int eth_rx(void)
 		return -EINVAL;
 
 	/* Process up to 32 packets at one time */
+	priv = current->uclass_priv;
 	flags = ETH_RECV_CHECK_DEVICE;
 	for (i = 0; i < 32; i++) {
+		priv->rx_placed = false;
 		ret = eth_get_ops(current)->recv(current, flags, &packet);
 		flags = 0;
+		if (ret > 0 && priv->rx_placed && priv->rx_dest) {
+			net_rx_placed = priv->rx_dest;
+			net_rx_placed_offset = priv->rx_offset;
+		}
 		if (ret > 0)
 			net_process_received_packet(packet, ret);
+		net_rx_placed = NULL;
 		if (ret >= 0 && eth_get_ops(current)->free_pkt)
 			eth_get_ops(current)->free_pkt(current, packet, ret);
 		if (ret <= 0)
@@ -482,6 +528,8 @@ static int eth_post_probe(struct udevice *dev)
 			ops->write_hwaddr += gd->reloc_off;
 		if (ops->read_rom_hwaddr)
 			ops->read_rom_hwaddr += gd->reloc_off;
+		if (ops->rx_dest)
+			ops->rx_dest += gd->reloc_off;
 
 		reloc_done++;
 	}
@@ -394,6 +394,12 @@ int eth_rx(void)
 	return eth_current->recv(eth_current);
 }
 
+int eth_set_rx_dest(void *dest, int offset, int len)
+{
+	/* Drivers always receive into their own packet buffers */
+	return -ENOSYS;
+}
+
 #ifdef CONFIG_API
 static void eth_save_packet(void *packet, int length)
 {
@@ -141,6 +141,12 @@ struct in_addr	net_server_ip;
 uchar *net_rx_packet;
 /* Current rx packet length */
 int		net_rx_packet_len;
+/* Data of the current rx packet placed straight at its destination */
+uchar *net_rx_placed;
+int		net_rx_placed_offset;
+/* UDP port and packet offset of the data the driver places */
+static int	net_rx_dest_port;
+static int	net_rx_dest_offset;
 /* IP packet ID */
 static unsigned	net_ip_id;
 /* Ethernet bcast address */
@@ -353,6 +359,7 @@ static void net_clear_handlers(void)
 	net_set_udp_handler(NULL);
 	net_set_arp_handler(NULL);
 	net_set_timeout_handler(0, NULL);
+	net_set_rx_dest(0, NULL, 0, 0);
 }
 
 static void net_cleanup_loop(void)
@@ -1032,6 +1039,77 @@ static void receive_icmp(struct ip_udp_hdr *ip, int len,
 	}
 }
 
+int net_set_rx_dest(int port, void *dest, int offset, int len)
+{
+	int ret;
+
+	if (!dest && !net_rx_dest_port)
+		return 0;
+	ret = eth_set_rx_dest(dest, offset, len);
+	if (ret || !dest) {
+		net_rx_dest_port = 0;
+		return ret;
+	}
+	net_rx_dest_port = port;
+	net_rx_dest_offset = offset;
+
+	return 0;
+}
+
+uchar *net_rx_data(uchar *ptr)
+{
+	int offset = ptr - net_rx_packet;
+
+	if (!net_rx_placed || offset < net_rx_placed_offset)
+		return ptr;
+
+	return net_rx_placed + offset - net_rx_placed_offset;
+}
+
+void net_rx_unplace(void)
+{
+	if (!net_rx_placed)
+		return;
+	memcpy(net_rx_packet + net_rx_placed_offset, net_rx_placed,
+	       net_rx_packet_len - net_rx_placed_offset);
+	net_rx_placed = NULL;
+}
+
+bool net_rx_dest_match(const uchar *pkt, int offset)
+{
+	const struct ethernet_hdr *et = (const struct ethernet_hdr *)pkt;
+	const struct ip_udp_hdr *ip;
+	int eth_proto = ntohs(et->et_protlen);
+	int hdr_size = ETHER_HDR_SIZE;
+
+	if (!net_rx_dest_port)
+		return false;
+	if (eth_proto == PROT_VLAN) {
+		const struct vlan_ethernet_hdr *vet =
+			(const struct vlan_ethernet_hdr *)et;
+
+		eth_proto = ntohs(vet->vet_type);
+		hdr_size = VLAN_ETHER_HDR_SIZE;
+	}
+	ip = (const struct ip_udp_hdr *)(pkt + hdr_size);
+
+	return eth_proto == PROT_IP &&
+		offset >= hdr_size + IP_UDP_HDR_SIZE &&
+		ip->ip_hl_v == 0x45 && ip->ip_p == IPPROTO_UDP &&
+		!(ntohs(ip->ip_off) & (IP_OFFS | IP_FLAGS_MFRAG)) &&
+		ntohs(ip->udp_dst) == net_rx_dest_port;
+}
+
+/*
+ * Only UDP packets for the port which asked for data to be placed can use
+ * it. Put everything else back together in the packet buffer.
+ */
+static void net_check_placed(void)
+{
+	if (!net_rx_dest_match(net_rx_packet, net_rx_placed_offset))
+		net_rx_unplace();
+}
+
 void net_process_received_packet(uchar *in_packet, int len)
 {
 	struct ethernet_hdr *et;
@@ -1054,6 +1132,9 @@ void net_process_received_packet(uchar *in_packet, int len)
 	if (len < ETHER_HDR_SIZE)
 		return;
 
+	if (net_rx_placed)
+		net_check_placed();
+
 #ifdef CONFIG_API
 	if (push_packet) {
 		(*push_packet)(in_packet, len);
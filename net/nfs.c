@@ -43,12 +43,30 @@
 
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
 static ulong nfs_timeout = NFS_TIMEOUT;
 
-static char dirfh[NFS_FHSIZE];	/* file handle of directory */
-static char filefh[NFS_FHSIZE]; /* file handle of kernel image */
+/* NFS version in use: 3, unless the server only speaks version 2 */
+static int nfs_version;
+static int nfs_read_size;
+
+static char dirfh[NFS3_FHSIZE];	/* file handle of directory */
+static int dirfh_len;
+static char filefh[NFS3_FHSIZE]; /* file handle of kernel image */
+static int filefh_len;
+
+/*
+ * READ requests in flight. The replies can arrive in any order, since each
+ * one is stored at its own offset from the load address.
+ */
+struct nfs_read {
+	unsigned long id;	/* RPC transaction ID, 0 if not in flight */
+	ulong offset;
+	int len;
+};
+
+static struct nfs_read nfs_reads[NFS_READ_WINDOW];
+static ulong nfs_read_next;	/* offset of the next block to request */
+static ulong nfs_read_end;	/* end of the file, once it is known */
 
 static enum net_loop_state nfs_download_state;
 static struct in_addr nfs_server_ip;
@@ -132,7 +150,7 @@ static char *dirname(char *path)
 /**************************************************************************
 RPC_ADD_CREDENTIALS - Add RPC authentication/verifier entries
 **************************************************************************/
-static long *rpc_add_credentials(long *p)
+static uint32_t *rpc_add_credentials(uint32_t *p)
 {
 	int hl;
 	int hostnamelen;
@@ -188,7 +206,10 @@ static void rpc_req(int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
 	pkt.u.call.type = htonl(MSG_CALL);
 	pkt.u.call.rpcvers = htonl(2);	/* use RPC version 2 */
 	pkt.u.call.prog = htonl(rpc_prog);
-	pkt.u.call.vers = htonl(2);	/* portmapper is version 2 */
+	if (rpc_prog == PROG_PORTMAP || nfs_version == 2)
+		pkt.u.call.vers = htonl(2);	/* portmapper is version 2 */
+	else
+		pkt.u.call.vers = htonl(3);
 	pkt.u.call.proc = htonl(rpc_proc);
 	p = (uint32_t *)&(pkt.u.call.data);
 
@@ -228,6 +249,20 @@ static void rpc_lookup_req(int prog, int ver)
 	rpc_req(PROG_PORTMAP, PORTMAP_GETPORT, data, 8);
 }
 
+/**************************************************************************
+RPC_ADD_FILEHANDLE - Add a file handle, which has a length field in NFSv3
+**************************************************************************/
+static uint32_t *rpc_add_filehandle(uint32_t *p, char *fh, int fh_len)
+{
+	if (nfs_version == 3)
+		*p++ = htonl(fh_len);
+	if (fh_len & 3)
+		*(p + fh_len / 4) = 0; /* add zero padding */
+	memcpy(p, fh, fh_len);
+
+	return p + (fh_len + 3) / 4;
+}
+
 /**************************************************************************
 NFS_MOUNT - Mount an NFS Filesystem
 **************************************************************************/
@@ -241,7 +276,7 @@ static void nfs_mount_req(char *path)
 	pathlen = strlen(path);
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	*p++ = htonl(pathlen);
 	if (pathlen & 3)
@@ -268,7 +303,7 @@ static void nfs_umountall_req(void)
 		return;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
@@ -289,14 +324,14 @@ static void nfs_readlink_req(void)
 	int len;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = rpc_add_filehandle(p, filefh, filefh_len);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_READLINK, data, len);
+	rpc_req(PROG_NFS, nfs_version == 3 ? NFS3PROC_READLINK : NFS_READLINK,
+		data, len);
 }
 
 /**************************************************************************
@@ -312,10 +347,9 @@ static void nfs_lookup_req(char *fname)
 	fnamelen = strlen(fname);
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
-	memcpy(p, dirfh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = rpc_add_filehandle(p, dirfh, dirfh_len);
 	*p++ = htonl(fnamelen);
 	if (fnamelen & 3)
 		*(p + fnamelen / 4) = 0;
@@ -324,30 +358,81 @@ static void nfs_lookup_req(char *fname)
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_LOOKUP, data, len);
+	rpc_req(PROG_NFS, nfs_version == 3 ? NFS3PROC_LOOKUP : NFS_LOOKUP,
+		data, len);
 }
 
 /**************************************************************************
 NFS_READ - Read File on NFS Server
 **************************************************************************/
-static void nfs_read_req(int offset, int readlen)
+static void nfs_read_req(struct nfs_read *rd)
 {
 	uint32_t data[1024];
 	uint32_t *p;
 	int len;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
-	*p++ = htonl(offset);
-	*p++ = htonl(readlen);
-	*p++ = 0;
+	p = rpc_add_filehandle(p, filefh, filefh_len);
+	if (nfs_version == 3) {
+		*p++ = htonl((u64)rd->offset >> 32);
+		*p++ = htonl(rd->offset);
+		*p++ = htonl(rd->len);
+	} else {
+		*p++ = htonl(rd->offset);
+		*p++ = htonl(rd->len);
+		*p++ = 0;		/* totalcount, unused */
+	}
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_READ, data, len);
+	rpc_req(PROG_NFS, nfs_version == 3 ? NFS3PROC_READ : NFS_READ,
+		data, len);
+	rd->id = rpc_id;
+}
+
+/*
+ * Request the following blocks of the file until NFS_READ_WINDOW reads are
+ * in flight, or the end of the file is reached. Returns the number of
+ * reads in flight, 0 when the whole file has been read.
+ */
+static int nfs_read_fill(void)
+{
+	struct nfs_read *rd;
+	int busy = 0;
+
+	for (rd = nfs_reads; rd < nfs_reads + NFS_READ_WINDOW; rd++) {
+		if (!rd->id && nfs_read_next < nfs_read_end) {
+			rd->offset = nfs_read_next;
+			rd->len = nfs_read_size;
+			nfs_read_next += nfs_read_size;
+			nfs_read_req(rd);
+		}
+		if (rd->id)
+			busy++;
+	}
+
+	return busy;
+}
+
+static void nfs_read_start(void)
+{
+	memset(nfs_reads, '\0', sizeof(nfs_reads));
+	nfs_read_next = 0;
+	nfs_read_end = ~0UL;
+	nfs_read_fill();
+}
+
+/* Send again all reads which are in flight */
+static void nfs_read_resend(void)
+{
+	struct nfs_read *rd;
+
+	for (rd = nfs_reads; rd < nfs_reads + NFS_READ_WINDOW; rd++) {
+		if (rd->id)
+			nfs_read_req(rd);
+	}
 }
 
 /**************************************************************************
@@ -359,10 +444,10 @@ static void nfs_send(void)
 
 	switch (nfs_state) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
-		rpc_lookup_req(PROG_MOUNT, 1);
+		rpc_lookup_req(PROG_MOUNT, nfs_version == 3 ? 3 : 1);
 		break;
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
-		rpc_lookup_req(PROG_NFS, 2);
+		rpc_lookup_req(PROG_NFS, nfs_version);
 		break;
 	case STATE_MOUNT_REQ:
 		nfs_mount_req(nfs_path);
@@ -374,7 +459,7 @@ static void nfs_send(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_resend();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -436,7 +521,15 @@ static int nfs_mount_reply(uchar *pkt, unsigned len)
 		return -1;
 
 	fs_mounted = 1;
-	memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	if (nfs_version == 3) {
+		dirfh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (dirfh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 2, dirfh_len);
+	} else {
+		dirfh_len = NFS_FHSIZE;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	}
 
 	return 0;
 }
@@ -484,7 +577,15 @@ static int nfs_lookup_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	if (nfs_version == 3) {
+		filefh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (filefh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(filefh, rpc_pkt.u.reply.data + 2, filefh_len);
+	} else {
+		filefh_len = NFS_FHSIZE;
+		memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	}
 
 	return 0;
 }
@@ -492,6 +593,7 @@ static int nfs_lookup_reply(uchar *pkt, unsigned len)
 static int nfs_readlink_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	uint32_t *data;
 	int rlen;
 
 	debug("%s\n", __func__);
@@ -509,17 +611,20 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	rlen = ntohl(rpc_pkt.u.reply.data[1]); /* new path length */
+	data = rpc_pkt.u.reply.data + 1;
+	/* Skip the symlink attributes, if present */
+	if (nfs_version == 3 && ntohl(*data++))
+		data += NFS3_FATTR_WORDS;
+	rlen = ntohl(*data++); /* new path length */
 
-	if (*((char *)&(rpc_pkt.u.reply.data[2])) != '/') {
+	if (*((char *)data) != '/') {
 		int pathlen;
 		strcat(nfs_path, "/");
 		pathlen = strlen(nfs_path);
-		memcpy(nfs_path + pathlen, (uchar *)&(rpc_pkt.u.reply.data[2]),
-		       rlen);
+		memcpy(nfs_path + pathlen, (uchar *)data, rlen);
 		nfs_path[pathlen + rlen] = 0;
 	} else {
-		memcpy(nfs_path, (uchar *)&(rpc_pkt.u.reply.data[2]), rlen);
+		memcpy(nfs_path, (uchar *)data, rlen);
 		nfs_path[rlen] = 0;
 	}
 	return 0;
@@ -528,15 +633,24 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 static int nfs_read_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	struct nfs_read *rd;
+	uint32_t *data;
+	unsigned hdrlen;
 	int rlen;
+	int eof = 0;
 
 	debug("%s\n", __func__);
 
-	memcpy((uchar *)&rpc_pkt, pkt, sizeof(rpc_pkt.u.reply));
+	/* Only the headers are needed, the largest is for NFSv3 */
+	memcpy((uchar *)&rpc_pkt, pkt, min_t(unsigned, len,
+	       sizeof(rpc_pkt.u.reply) + 7 * sizeof(uint32_t)));
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	for (rd = nfs_reads; rd < nfs_reads + NFS_READ_WINDOW; rd++) {
+		if (rd->id && rd->id == ntohl(rpc_pkt.u.reply.id))
+			break;
+	}
+	/* Not in flight, perhaps a reply to a request sent again */
+	if (rd == nfs_reads + NFS_READ_WINDOW)
 		return -NFS_RPC_DROP;
 
 	if (rpc_pkt.u.reply.rstatus  ||
@@ -550,17 +664,43 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
+	data = rpc_pkt.u.reply.data + 1;
+	if (nfs_version == 3) {
+		/* Skip the file attributes, if present, and the count */
+		if (ntohl(*data++))
+			data += NFS3_FATTR_WORDS;
+		data++;
+		eof = ntohl(*data++);
+	} else {
+		data += NFS_FATTR_WORDS;
+	}
+	rlen = ntohl(*data++);
+	hdrlen = (uchar *)data - (uchar *)&rpc_pkt;
+	if (rlen < 0 || rlen > rd->len || hdrlen + rlen > len)
+		return -9999;
+
+	if ((rd->offset != 0) && !((rd->offset) %
+			(nfs_read_size / 2 * 10 * HASHES_PER_LINE)))
 		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
+	if (!(rd->offset % ((nfs_read_size / 2) * 10)))
 		putc('#');
 
-	rlen = ntohl(rpc_pkt.u.reply.data[18]);
-	if (store_block((uchar *)pkt + sizeof(rpc_pkt.u.reply),
-			nfs_offset, rlen))
+	if (rlen && store_block(pkt + hdrlen, rd->offset, rlen))
 		return -9999;
 
+	if (nfs_version == 3 && rlen && rlen < rd->len && !eof) {
+		/* The server sent less than asked for: ask for the rest */
+		rd->offset += rlen;
+		rd->len -= rlen;
+		nfs_read_req(rd);
+		return rlen;
+	}
+
+	/* NFSv2 only sends less than asked for at the end of the file */
+	if (rlen < rd->len || eof)
+		nfs_read_end = min(nfs_read_end, rd->offset + rlen);
+	rd->id = 0;
+
 	return rlen;
 }
 
@@ -603,6 +743,16 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
 		if (rpc_lookup_reply(PROG_NFS, pkt, len) == -NFS_RPC_DROP)
 			break;
+		if (nfs_version == 3 &&
+		    (!nfs_server_port || !nfs_server_mount_port)) {
+			/* No NFSv3 on this server, so start again with v2 */
+			debug("NFSv3 not available, using NFSv2\n");
+			nfs_version = 2;
+			nfs_read_size = NFS_READ_SIZE;
+			nfs_state = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+			nfs_send();
+			break;
+		}
 		nfs_state = STATE_MOUNT_REQ;
 		nfs_send();
 		break;
@@ -645,9 +795,7 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			nfs_send();
 		} else {
 			nfs_state = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
-			nfs_send();
+			nfs_read_start();
 		}
 		break;
 
@@ -671,17 +819,21 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 	case STATE_READ_REQ:
 		rlen = nfs_read_reply(pkt, len);
+		if (rlen == -NFS_RPC_DROP)
+			break;
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
-		if (rlen > 0) {
-			nfs_offset += rlen;
+		if (rlen >= 0) {
+			/* Keep reading until nothing is left in flight */
+			if (nfs_read_fill())
+				break;
+			nfs_download_state = NETLOOP_SUCCESS;
+			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
 			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		}
@@ -762,6 +914,8 @@ void nfs_start(void)
 
 	nfs_timeout_count = 0;
 	nfs_state = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+	nfs_version = 3;
+	nfs_read_size = NFS3_READ_SIZE;
 
 	/*nfs_our_port = 4096 + (get_ticks() % 3072);*/
 	/*FIX ME !!!*/
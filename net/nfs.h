@@ -16,6 +16,13 @@
 #define MSG_CALL        0
 #define MSG_REPLY       1
 
+/* RPC accept_stat values */
+#define RPC_SUCCESS		0
+#define RPC_PROG_UNAVAIL	1
+#define RPC_PROG_MISMATCH	2
+#define RPC_PROC_UNAVAIL	3
+#define RPC_GARBAGE_ARGS	4
+
 #define PORTMAP_GETPORT 3
 
 #define MOUNT_ADDENTRY  1
@@ -25,7 +32,16 @@
 #define NFS_READLINK    5
 #define NFS_READ        6
 
+#define NFS3PROC_LOOKUP		3
+#define NFS3PROC_READLINK	5
+#define NFS3PROC_READ		6
+
 #define NFS_FHSIZE      32
+#define NFS3_FHSIZE	64
+
+/* Size of struct fattr (v2) and struct fattr3 in 32-bit words */
+#define NFS_FATTR_WORDS		17
+#define NFS3_FATTR_WORDS	21
 
 #define NFSERR_PERM     1
 #define NFSERR_NOENT    2
@@ -44,6 +60,24 @@
 #define NFS_READ_SIZE 1024 /* biggest power of two that fits Ether frame */
 #endif
 
+/*
+ * NFSv3 has no limit on the read size. When fragments can be reassembled
+ * (leaving room for the RPC headers), read larger blocks.
+ */
+#if !defined(CONFIG_NFS_READ_SIZE) && defined(CONFIG_IP_DEFRAG) && \
+	(!defined(CONFIG_NET_MAXDEFRAG) || CONFIG_NET_MAXDEFRAG >= 8192 + 512)
+#define NFS3_READ_SIZE 8192
+#else
+#define NFS3_READ_SIZE NFS_READ_SIZE
+#endif
+
+/* Number of READ requests to keep in flight */
+#ifdef CONFIG_NFS_READ_WINDOW
+#define NFS_READ_WINDOW CONFIG_NFS_READ_WINDOW
+#else
+#define NFS_READ_WINDOW 4
+#endif
+
 #define NFS_MAXLINKDEPTH 16
 
 struct rpc_t {
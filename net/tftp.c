@@ -133,6 +133,27 @@ static char tftp_filename[MAX_LEN];
 static unsigned short tftp_block_size = TFTP_BLOCK_SIZE;
 static unsigned short tftp_block_size_option = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440 lets the server send a window of several blocks for each ACK,
+ * which avoids waiting a full round trip per block. 1 means the classic
+ * lock-step protocol, and the option is then not requested.
+ */
+#ifdef CONFIG_TFTP_WINDOWSIZE
+#define TFTP_WINDOWSIZE_OPTION CONFIG_TFTP_WINDOWSIZE
+#else
+#define TFTP_WINDOWSIZE_OPTION 1
+#endif
+
+/* largest window we ask for (the RFC allows up to 65535) */
+#define TFTP_MAX_WINDOWSIZE	256
+
+static unsigned short tftp_windowsize = 1;
+static unsigned short tftp_windowsize_option = TFTP_WINDOWSIZE_OPTION;
+/* block number which completes the current window */
+static ulong	tftp_next_ack;
+/* block we last acknowledged because of a gap in the window */
+static ulong	tftp_last_nack;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -163,6 +184,33 @@ static void mcast_cleanup(void)
 
 #endif	/* CONFIG_MCAST_TFTP */
 
+/*
+ * Ask the Ethernet driver to receive the next block straight into its
+ * place at 'offset' from the load address, which saves store_block() from
+ * copying it there. This is not possible when writing to flash.
+ */
+static void tftp_set_rx_dest(ulong offset)
+{
+#ifndef CONFIG_SYS_DIRECT_FLASH_TFTP
+	void *ptr;
+
+#ifdef CONFIG_CMD_TFTPPUT
+	if (tftp_put_active)
+		return;
+#endif
+#ifdef CONFIG_MCAST_TFTP
+	if (tftp_mcast_active)
+		return;
+#endif
+	ptr = map_sysmem(load_addr + offset, tftp_block_size);
+	/* The data follows the 2-byte opcode and 2-byte block number */
+	net_set_rx_dest(tftp_our_port, ptr,
+			net_eth_hdr_size() + IP_UDP_HDR_SIZE + 4,
+			tftp_block_size);
+	unmap_sysmem(ptr);
+#endif
+}
+
 static inline void store_block(int block, uchar *src, unsigned len)
 {
 	ulong offset = block * tftp_block_size + tftp_block_wrap_offset;
@@ -192,7 +240,9 @@ static inline void store_block(int block, uchar *src, unsigned len)
 	{
 		void *ptr = map_sysmem(load_addr + offset, len);
 
-		memcpy(ptr, src, len);
+		/* The driver may have put the data here already */
+		if (ptr != src)
+			memcpy(ptr, src, len);
 		unmap_sysmem(ptr);
 	}
 #ifdef CONFIG_MCAST_TFTP
@@ -202,12 +252,23 @@ static inline void store_block(int block, uchar *src, unsigned len)
 
 	if (net_boot_file_size < newsize)
 		net_boot_file_size = newsize;
+
+	/*
+	 * A full block means that there is another one to come. After the
+	 * last block, stop the driver placing whatever arrives next.
+	 */
+	if (len == tftp_block_size)
+		tftp_set_rx_dest(newsize);
+	else
+		net_set_rx_dest(0, NULL, 0, 0);
 }
 
 /* Clear our state ready for a new transfer */
 static void new_transfer(void)
 {
 	tftp_prev_block = 0;
+	tftp_next_ack = tftp_windowsize;
+	tftp_last_nack = -1;
 	tftp_block_wrap = 0;
 	tftp_block_wrap_offset = 0;
 #ifdef CONFIG_CMD_TFTPPUT
@@ -274,6 +335,7 @@ static void show_block_marker(void)
 static void restart(const char *msg)
 {
 	printf("\n%s; starting again\n", msg);
+	net_set_rx_dest(0, NULL, 0, 0);
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -321,6 +383,7 @@ static void tftp_complete(void)
 			time_start * 1000, "/s");
 	}
 	puts("\ndone\n");
+	net_set_rx_dest(0, NULL, 0, 0);
 	net_set_state(NETLOOP_SUCCESS);
 }
 
@@ -330,6 +393,7 @@ static void tftp_send(void)
 	uchar *xp;
 	int len = 0;
 	ushort *s;
+	bool windowed;
 
 #ifdef CONFIG_MCAST_TFTP
 	/* Multicast TFTP.. non-MasterClients do not ACK data. */
@@ -371,6 +435,9 @@ static void tftp_send(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, tftp_block_size_option, 0);
+		/* and for several blocks per ACK, when reading */
+		windowed = tftp_state == STATE_SEND_RRQ &&
+			tftp_windowsize_option > 1;
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!tftp_mcast_disabled) {
@@ -380,9 +447,14 @@ static void tftp_send(void)
 				tftp_mcast_bitmap = NULL;
 				pkt += sprintf((char *)pkt, "multicast%c%c",
 					0, 0);
+				/* Only the master client ACKs, block by block */
+				windowed = false;
 			}
 		}
 #endif /* CONFIG_MCAST_TFTP */
+		if (windowed)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, tftp_windowsize_option, 0);
 		len = pkt - xp;
 		break;
 
@@ -456,6 +528,30 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/*
+ * A block arrived out of order while receiving with a window: a block was
+ * lost or reordered. Old blocks are ignored. For a block from the future,
+ * acknowledge the last block received in order, so that the server starts
+ * the window again from there. Only do this once per gap, since the rest
+ * of the window will arrive out of order too.
+ */
+static void tftp_window_gap(void)
+{
+	ulong ahead = (tftp_cur_block - tftp_prev_block) &
+		(TFTP_SEQUENCE_SIZE - 1);
+
+	debug("Block %lu out of order, expected %lu\n", tftp_cur_block,
+	      (tftp_prev_block + 1) & (TFTP_SEQUENCE_SIZE - 1));
+	tftp_cur_block = tftp_prev_block;
+	if (ahead >= TFTP_SEQUENCE_SIZE / 2 || tftp_last_nack == tftp_prev_block)
+		return;
+
+	tftp_last_nack = tftp_prev_block;
+	tftp_next_ack = (tftp_prev_block + tftp_windowsize) &
+		(TFTP_SEQUENCE_SIZE - 1);
+	tftp_send();
+}
+
 static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 unsigned src, unsigned len)
 {
@@ -481,6 +577,9 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	s = (__be16 *)pkt;
 	proto = *s++;
 	pkt = (uchar *)s;
+	/* Only data blocks can use data placed by the driver */
+	if (ntohs(proto) != TFTP_DATA)
+		net_rx_unplace();
 	switch (ntohs(proto)) {
 	case TFTP_RRQ:
 		break;
@@ -539,6 +638,15 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				debug("Blocksize ack: %s, %d\n",
 				      (char *)pkt + i + 8, tftp_block_size);
 			}
+			if (strcmp((char *)pkt + i, "windowsize") == 0) {
+				tftp_windowsize = (unsigned short)
+					simple_strtoul((char *)pkt + i + 11,
+						       NULL, 10);
+				if (!tftp_windowsize)
+					tftp_windowsize = 1;
+				debug("Windowsize ack: %s, %d\n",
+				      (char *)pkt + i + 11, tftp_windowsize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				tftp_tsize = simple_strtoul((char *)pkt + i + 6,
@@ -548,8 +656,13 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			}
 #endif
 		}
+		/* The block size is known now */
+		tftp_set_rx_dest(0);
 #ifdef CONFIG_MCAST_TFTP
 		parse_multicast_oack((char *)pkt, len - 1);
+		/* Multicast transfers are not windowed */
+		if (tftp_mcast_active)
+			tftp_windowsize = 1;
 		if ((tftp_mcast_active) && (!tftp_mcast_master_client))
 			tftp_state = STATE_DATA;	/* passive.. */
 		else
@@ -569,6 +682,13 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		len -= 2;
 		tftp_cur_block = ntohs(*(__be16 *)pkt);
 
+		if (tftp_state == STATE_DATA && tftp_windowsize > 1 &&
+		    tftp_cur_block != ((tftp_prev_block + 1) &
+				       (TFTP_SEQUENCE_SIZE - 1))) {
+			tftp_window_gap();
+			break;
+		}
+
 		update_block_number();
 
 		if (tftp_state == STATE_SEND_RRQ)
@@ -605,12 +725,18 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		timeout_count_max = tftp_timeout_count_max;
 		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 
-		store_block(tftp_cur_block - 1, pkt + 2, len);
+		store_block(tftp_cur_block - 1, net_rx_data(pkt + 2), len);
 
 		/*
 		 *	Acknowledge the block just received, which will prompt
-		 *	the remote for the next one.
+		 *	the remote for the next one. With a window, only the
+		 *	last block of each window (or of the file) is ACKed.
 		 */
+		if (tftp_windowsize > 1 && len == tftp_block_size &&
+		    tftp_cur_block != tftp_next_ack)
+			break;
+		tftp_next_ack = (tftp_cur_block + tftp_windowsize) &
+			(TFTP_SEQUENCE_SIZE - 1);
 #ifdef CONFIG_MCAST_TFTP
 		/* if I am the MasterClient, actively calculate what my next
 		 * needed block is; else I'm passive; not ACKING
@@ -656,6 +782,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	case TFTP_ERROR:
 		printf("\nTFTP error: '%s' (%d)\n",
 		       pkt + 2, ntohs(*(__be16 *)pkt));
+		net_set_rx_dest(0, NULL, 0, 0);
 
 		switch (ntohs(*(__be16 *)pkt)) {
 		case TFTP_ERR_FILE_NOT_FOUND:
@@ -689,6 +816,10 @@ static void tftp_timeout_handler(void)
 	} else {
 		puts("T ");
 		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
+		/* The ACK restarts the window after the last block we have */
+		if (tftp_state == STATE_DATA)
+			tftp_next_ack = (tftp_cur_block + tftp_windowsize) &
+				(TFTP_SEQUENCE_SIZE - 1);
 		if (tftp_state != STATE_RECV_WRQ)
 			tftp_send();
 	}
@@ -709,6 +840,19 @@ void tftp_start(enum proto_t protocol)
 	if (ep != NULL)
 		tftp_block_size_option = simple_strtol(ep, NULL, 10);
 
+	tftp_windowsize_option = TFTP_WINDOWSIZE_OPTION;
+	ep = getenv("tftpwindowsize");
+	if (ep != NULL)
+		tftp_windowsize_option = simple_strtol(ep, NULL, 10);
+
+	if (!tftp_windowsize_option) {
+		tftp_windowsize_option = 1;
+	} else if (tftp_windowsize_option > TFTP_MAX_WINDOWSIZE) {
+		printf("TFTP window size (%d) too large, set max = %d\n",
+		       tftp_windowsize_option, TFTP_MAX_WINDOWSIZE);
+		tftp_windowsize_option = TFTP_MAX_WINDOWSIZE;
+	}
+
 	ep = getenv("tftptimeout");
 	if (ep != NULL)
 		timeout_ms = simple_strtol(ep, NULL, 10);
@@ -730,8 +874,8 @@ void tftp_start(enum proto_t protocol)
 	}
 #endif
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-	      tftp_block_size_option, timeout_ms);
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+	      tftp_block_size_option, tftp_windowsize_option, timeout_ms);
 
 	tftp_remote_ip = net_server_ip;
 	if (net_boot_file_name[0] == '\0') {
@@ -831,8 +975,9 @@ void tftp_start(enum proto_t protocol)
 
 	/* zero out server ether in case the server ip has changed */
 	memset(net_server_ethaddr, 0, 6);
-	/* Revert tftp_block_size to dflt */
+	/* Revert tftp_block_size and tftp_windowsize to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -841,6 +986,7 @@ void tftp_start(enum proto_t protocol)
 	tftp_tsize_num_hash = 0;
 #endif
 
+	tftp_set_rx_dest(0);
 	tftp_send();
 }
 
@@ -860,8 +1006,9 @@ void tftp_start_server(void)
 	timeout_ms = TIMEOUT;
 	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 
-	/* Revert tftp_block_size to dflt */
+	/* Revert tftp_block_size and tftp_windowsize to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
 	tftp_cur_block = 0;
 	tftp_our_port = WELL_KNOWN_PORT;
 
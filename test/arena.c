@@ -0,0 +1,157 @@
+/*
+ * Check the arena allocator.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <arena.h>
+#include <command.h>
+#include <malloc.h>
+
+#define BLOCK_SIZE		256
+
+#define errcheck(statement) if (!(statement)) { \
+	fprintf(stderr, "\tFailed: %s\n", #statement); \
+	ret = 1; \
+	goto out; \
+}
+
+static int check_alloc(struct arena *arena)
+{
+	char *ptr[4];
+	int ret = 0;
+	int i;
+
+	printf(" testing alloc ...\n");
+	for (i = 0; i < ARRAY_SIZE(ptr); i++) {
+		ptr[i] = arena_alloc(arena, 10);
+		errcheck(ptr[i]);
+		errcheck(!((ulong)ptr[i] & (2 * sizeof(size_t) - 1)));
+		errcheck(arena_contains(arena, ptr[i]));
+		memset(ptr[i], i, 10);
+	}
+
+	/* Allocations must not overlap */
+	for (i = 0; i < ARRAY_SIZE(ptr); i++) {
+		errcheck(ptr[i][0] == i && ptr[i][9] == i);
+		if (i)
+			errcheck(ptr[i] >= ptr[i - 1] + 10);
+	}
+
+	ptr[0] = arena_zalloc(arena, 40);
+	errcheck(ptr[0]);
+	for (i = 0; i < 40; i++)
+		errcheck(!ptr[0][i]);
+
+out:
+	printf(" alloc: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+static int check_reset(struct arena *arena)
+{
+	char *first, *ptr;
+	int ret = 0;
+
+	printf(" testing reset ...\n");
+	arena_reset(arena);
+	first = arena_alloc(arena, 16);
+	errcheck(first);
+
+	/* The first block is reused rather than allocating a new one */
+	arena_reset(arena);
+	ptr = arena_alloc(arena, 16);
+	errcheck(ptr == first);
+
+out:
+	printf(" reset: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+static int check_growth(struct arena *arena)
+{
+	struct arena_block *first;
+	char *ptr, *big, *next;
+	int ret = 0;
+
+	printf(" testing block growth ...\n");
+	arena_reset(arena);
+	first = arena->first;
+	ptr = arena_alloc(arena, BLOCK_SIZE - 16);
+	errcheck(ptr);
+	errcheck(arena->cur == first);
+
+	/* This does not fit in the first block, so a second one is added */
+	next = arena_alloc(arena, 32);
+	errcheck(next);
+	errcheck(arena->cur != first);
+	errcheck(arena_contains(arena, next));
+
+	/* Larger than a block, so a block of its own size is needed */
+	big = arena_alloc(arena, BLOCK_SIZE * 4);
+	errcheck(big);
+	memset(big, 0xa5, BLOCK_SIZE * 4);
+	errcheck(arena_contains(arena, big));
+	errcheck(arena_contains(arena, big + BLOCK_SIZE * 4 - 1));
+
+	/* After a reset, the same blocks are used again in order */
+	arena_reset(arena);
+	errcheck(arena->cur == first);
+	errcheck(arena_alloc(arena, BLOCK_SIZE - 16) == ptr);
+	errcheck(arena_alloc(arena, 32) == next);
+
+out:
+	printf(" block growth: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+static int check_contains(struct arena *arena)
+{
+	char local;
+	int ret = 0;
+	char *ptr;
+
+	printf(" testing contains ...\n");
+	errcheck(!arena_contains(NULL, &local));
+	errcheck(!arena_contains(arena, &local));
+
+	ptr = malloc(16);
+	errcheck(ptr);
+	errcheck(!arena_contains(arena, ptr));
+	free(ptr);
+
+out:
+	printf(" contains: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+static int do_ut_arena(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	struct arena *arena;
+	int err = 0;
+
+	arena = arena_create(BLOCK_SIZE);
+	if (!arena)
+		return CMD_RET_FAILURE;
+
+	err += check_alloc(arena);
+	err += check_reset(arena);
+	err += check_growth(arena);
+	err += check_contains(arena);
+	arena_destroy(arena);
+
+	printf("ut_arena %s\n", err == 0 ? "ok" : "FAILED");
+
+	return err == 0 ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
+}
+
+U_BOOT_CMD(
+	ut_arena,	1,	1,	do_ut_arena,
+	"Check the arena allocator", ""
+);
@@ -8,10 +8,12 @@
 
 #include <common.h>
 #include <bootm.h>
+#include <errno.h>
 #include <command.h>
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/zlib.h>
 #include <bzlib.h>
@@ -371,6 +373,108 @@ out:
 	return ret;
 }
 
+/* Number and size of the blocks in the LZ4 multi-block test frame */
+#define LZ4_TEST_BLOCKS		8
+#define LZ4_TEST_BLOCK_SIZE	(64 << 10)
+#define LZ4_TEST_TAIL_SIZE	100
+
+/*
+ * Build an LZ4 frame made up of several 64KB blocks, alternating between
+ * stored blocks and compressed blocks which each expand to a single long
+ * run, followed by a short stored block. The expected output is written to
+ * @expect and the frame size is returned.
+ */
+static ulong lz4_make_frame(u8 *frame, u8 *expect)
+{
+	static const u8 frame_header[] = {
+		0x04, 0x22, 0x4d, 0x18,	/* magic */
+		0x60,			/* version 1, independent blocks */
+		0x40,			/* 64KB maximum block size */
+		0x82,			/* header checksum */
+	};
+	u8 *in = frame, *out = expect;
+	u32 size;
+	int i, j;
+
+	memcpy(in, frame_header, sizeof(frame_header));
+	in += sizeof(frame_header);
+	for (i = 0; i < LZ4_TEST_BLOCKS; i++) {
+		if (i & 1) {
+			size = LZ4_TEST_BLOCK_SIZE;
+			put_unaligned_le32(size | 0x80000000, in);
+			in += sizeof(u32);
+			for (j = 0; j < size; j++)
+				in[j] = out[j] = (j * 3 + i) & 0xff;
+			in += size;
+			out += size;
+			continue;
+		}
+
+		/* One literal, a match repeating it, then 5 final literals */
+		size = 1 + 1 + 2 + 256 + 1 + 1 + 5;
+		put_unaligned_le32(size, in);
+		in += sizeof(u32);
+		*in++ = 0x1f;
+		*in++ = 'a' + i;
+		*in++ = 1;		/* match offset */
+		*in++ = 0;
+		memset(in, 0xff, 256);	/* match length */
+		in += 256;
+		*in++ = LZ4_TEST_BLOCK_SIZE - 6 - 4 - 15 - 255 * 256;
+		*in++ = 0x50;
+		memcpy(in, "VWXYZ", 5);
+		in += 5;
+		memset(out, 'a' + i, LZ4_TEST_BLOCK_SIZE - 5);
+		memcpy(out + LZ4_TEST_BLOCK_SIZE - 5, "VWXYZ", 5);
+		out += LZ4_TEST_BLOCK_SIZE;
+	}
+	put_unaligned_le32(LZ4_TEST_TAIL_SIZE | 0x80000000, in);
+	in += sizeof(u32);
+	for (j = 0; j < LZ4_TEST_TAIL_SIZE; j++)
+		*in++ = *out++ = j;
+	put_unaligned_le32(0, in);	/* end mark */
+	in += sizeof(u32);
+
+	return in - frame;
+}
+
+static int run_lz4_blocks_test(void)
+{
+	const ulong unc_size = LZ4_TEST_BLOCKS * LZ4_TEST_BLOCK_SIZE +
+		LZ4_TEST_TAIL_SIZE;
+	u8 *frame, *expect, *out;
+	ulong frame_size;
+	size_t size;
+	int ret;
+
+	printf(" testing lz4 blocks ...\n");
+	frame = malloc(unc_size + LZ4_TEST_BLOCKS * 4 + 32);
+	expect = malloc(unc_size);
+	out = malloc(unc_size);
+	errcheck(frame && expect && out);
+	frame_size = lz4_make_frame(frame, expect);
+
+	size = unc_size;
+	memset(out, '\0', unc_size);
+	errcheck(ulz4fn(frame, frame_size, out, &size) == 0);
+	errcheck(size == unc_size);
+	errcheck(!memcmp(out, expect, unc_size));
+
+	/* The last block does not fit */
+	size = unc_size - 1;
+	errcheck(ulz4fn(frame, frame_size, out, &size) != 0);
+	errcheck(size <= unc_size - 1);
+
+	ret = 0;
+out:
+	printf(" lz4 blocks: %s\n", ret == 0 ? "ok" : "FAILED");
+	free(out);
+	free(expect);
+	free(frame);
+
+	return ret;
+}
+
 static int do_ut_compression(cmd_tbl_t *cmdtp, int flag, int argc,
 			     char *const argv[])
 {
@@ -381,6 +485,7 @@ static int do_ut_compression(cmd_tbl_t *cmdtp, int flag, int argc,
 	err += run_test("lzma", compress_using_lzma, uncompress_using_lzma);
 	err += run_test("lzo", compress_using_lzo, uncompress_using_lzo);
 	err += run_test("lz4", compress_using_lz4, uncompress_using_lz4);
+	err += run_lz4_blocks_test();
 
 	printf("ut_compression %s\n", err == 0 ? "ok" : "FAILED");
 
@@ -448,6 +553,75 @@ static int run_bootm_test(int comp_type, mutate_func compress)
 	return 0;
 }
 
+/* A compressed image in memory, handed out a few bytes at a time */
+struct stream_test {
+	const char *buf;
+	ulong size;
+	ulong pos;
+};
+
+static int stream_test_read(void *priv, void *buf, ulong size)
+{
+	struct stream_test *test = priv;
+
+	/* Use an odd chunk size to exercise the decompressors' refill paths */
+	size = min(size, min(test->size - test->pos, 7UL));
+	memcpy(buf, test->buf + test->pos, size);
+	test->pos += size;
+
+	return size;
+}
+
+/**
+ * run_bootm_stream_test() - Run tests on streaming bootm decompression
+ *
+ * @comp_type:	Compression type to test
+ * @compress:	Our function to compress data
+ * @return 0 if OK, non-zero on failure
+ */
+static int run_bootm_stream_test(int comp_type, mutate_func compress)
+{
+	struct stream_test test;
+	ulong compress_size = 1024;
+	char *compress_buff, *load_buff;
+	const ulong load_addr = 0x1000;
+	ulong load_end;
+	int unc_len;
+	int err;
+
+	printf("Testing stream: %s\n", genimg_get_comp_name(comp_type));
+	compress_buff = malloc(compress_size);
+	load_buff = map_sysmem(load_addr, 0);
+	unc_len = strlen(plain);
+	compress((void *)plain, unc_len, compress_buff, compress_size,
+		 &compress_size);
+
+	test.buf = compress_buff;
+	test.size = compress_size;
+	test.pos = 0;
+	memset(load_buff, '\0', unc_len + 1);
+	err = bootm_decomp_stream(comp_type, load_addr, IH_TYPE_KERNEL,
+				  load_buff, unc_len, stream_test_read, &test,
+				  &load_end);
+	if (!err && (load_end != load_addr + unc_len ||
+		     memcmp(load_buff, plain, unc_len)))
+		err = -EINVAL;
+	if (err)
+		goto out;
+
+	/* The output must not overflow */
+	test.pos = 0;
+	err = bootm_decomp_stream(comp_type, load_addr, IH_TYPE_KERNEL,
+				  load_buff, unc_len - 1, stream_test_read,
+				  &test, &load_end);
+	err = err ? 0 : -EINVAL;
+
+out:
+	free(compress_buff);
+
+	return err;
+}
+
 static int do_ut_image_decomp(cmd_tbl_t *cmdtp, int flag, int argc,
 			      char *const argv[])
 {
@@ -460,6 +634,11 @@ static int do_ut_image_decomp(cmd_tbl_t *cmdtp, int flag, int argc,
 	err |= run_bootm_test(IH_COMP_LZ4, compress_using_lz4);
 	err |= run_bootm_test(IH_COMP_NONE, compress_using_none);
 
+	err |= run_bootm_stream_test(IH_COMP_GZIP, compress_using_gzip);
+	err |= run_bootm_stream_test(IH_COMP_LZMA, compress_using_lzma);
+	err |= run_bootm_stream_test(IH_COMP_LZ4, compress_using_lz4);
+	err |= run_bootm_stream_test(IH_COMP_NONE, compress_using_none);
+
 	printf("ut_image_decomp %s\n", err == 0 ? "ok" : "FAILED");
 
 	return 0;
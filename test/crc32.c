@@ -0,0 +1,103 @@
+/*
+ * Check that all CRC32 engines agree and report their throughput.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <u-boot/crc.h>
+
+/* Size of the buffer used for the throughput measurement */
+#define BENCH_BUF_SIZE		(1 << 20)
+#define BENCH_LOOPS		64
+
+static const unsigned char check_str[] = "123456789";
+#define CHECK_CRC		0xcbf43926
+
+#define errcheck(statement) if (!(statement)) { \
+	fprintf(stderr, "\tFailed: %s\n", #statement); \
+	ret = 1; \
+	goto out; \
+}
+
+static int check_engine(const struct crc32_engine *ref,
+			const struct crc32_engine *eng, const unsigned char *buf)
+{
+	uint offset, len;
+	int ret = 0;
+
+	printf(" testing %s ...\n", eng->name);
+	errcheck((eng->calc(~0U, check_str, 9) ^ ~0U) == CHECK_CRC);
+
+	/* Cover every alignment and tail length around the 8-byte stride */
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len < 80; len++) {
+			errcheck(eng->calc(~0U, buf + offset, len) ==
+				 ref->calc(~0U, buf + offset, len));
+		}
+	}
+	errcheck(eng->calc(0x12345678, buf + 3, 4093) ==
+		 ref->calc(0x12345678, buf + 3, 4093));
+
+out:
+	printf(" %s: %s\n", eng->name, ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+static void bench_engine(const struct crc32_engine *eng,
+			 const unsigned char *buf)
+{
+	ulong start, duration;
+	uint32_t crc = 0;
+	int i;
+
+	start = timer_get_us();
+	for (i = 0; i < BENCH_LOOPS; i++)
+		crc = eng->calc(crc, buf, BENCH_BUF_SIZE);
+	duration = timer_get_us() - start;
+	if (!duration)
+		duration = 1;
+
+	printf(" %-12s %6lu MB/s (crc %08x)\n", eng->name,
+	       (ulong)((u64)BENCH_LOOPS * BENCH_BUF_SIZE / duration), crc);
+}
+
+static int do_ut_crc32(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	const struct crc32_engine *engines;
+	unsigned char *buf;
+	int count, i;
+	int err = 0;
+
+	count = crc32_get_engines(&engines);
+	buf = malloc(BENCH_BUF_SIZE);
+	if (!buf)
+		return CMD_RET_FAILURE;
+	for (i = 0; i < BENCH_BUF_SIZE; i++)
+		buf[i] = (i * 7 + (i >> 8)) & 0xff;
+
+	if (crc32(0, check_str, 9) != CHECK_CRC) {
+		printf(" crc32: FAILED\n");
+		err++;
+	}
+	for (i = 0; i < count; i++)
+		err += check_engine(&engines[0], &engines[i], buf);
+
+	printf("CRC32 throughput:\n");
+	for (i = 0; i < count; i++)
+		bench_engine(&engines[i], buf);
+	free(buf);
+
+	printf("ut_crc32 %s\n", err == 0 ? "ok" : "FAILED");
+
+	return err == 0 ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
+}
+
+U_BOOT_CMD(
+	ut_crc32,	1,	1,	do_ut_crc32,
+	"Check and benchmark the CRC32 engines", ""
+);
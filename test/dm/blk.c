@@ -6,6 +6,9 @@
 
 #include <common.h>
 #include <dm.h>
+#include <malloc.h>
+#include <os.h>
+#include <sandboxblockdev.h>
 #include <usb.h>
 #include <asm/state.h>
 #include <dm/test.h>
@@ -94,3 +97,117 @@ static int dm_test_blk_usb(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_blk_usb, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_BLOCK_CACHE
+#define BLK_CACHE_FILE		"/tmp/u-boot-blkcache.img"
+#define BLK_CACHE_BLOCKS	64
+
+/*
+ * Check that a buffer holds blocks starting at 'start', each filled with
+ * its block number
+ */
+static int check_blocks(struct unit_test_state *uts, const u8 *buf,
+			lbaint_t start, lbaint_t count)
+{
+	lbaint_t i;
+
+	for (i = 0; i < count * 512; i++)
+		ut_asserteq((u8)(start + i / 512), buf[i]);
+
+	return 0;
+}
+
+/* Test the block cache and its readahead */
+static int dm_test_blk_cache(struct unit_test_state *uts)
+{
+	struct block_cache_stats stats;
+	struct blk_desc *desc;
+	u8 buf[512 * 4], *big;
+	int fd, i;
+
+	os_unlink(BLK_CACHE_FILE);
+	fd = os_open(BLK_CACHE_FILE, OS_O_RDWR | OS_O_CREAT);
+	ut_assert(fd >= 0);
+	for (i = 0; i < BLK_CACHE_BLOCKS; i++) {
+		memset(buf, i, 512);
+		ut_asserteq(512, os_write(fd, buf, 512));
+	}
+	os_close(fd);
+	ut_assertok(host_dev_bind(0, BLK_CACHE_FILE));
+	ut_assertok(blk_get_device_by_str("host", "0", &desc));
+
+	/* Start with an empty cache: 8 blocks per entry, 4 entries */
+	blkcache_configure(8, 4, 8);
+
+	ut_asserteq(1, blk_dread(desc, 0, 1, buf));
+	ut_assertok(check_blocks(uts, buf, 0, 1));
+	ut_asserteq(1, blk_dread(desc, 0, 1, buf));
+	ut_assertok(check_blocks(uts, buf, 0, 1));
+	blkcache_stats(&stats);
+	ut_asserteq(1, stats.hits);
+	ut_asserteq(1, stats.misses);
+	ut_asserteq(0, stats.readahead);
+
+	/* A sequential read pulls in blocks 1-8, which are then hits */
+	ut_asserteq(1, blk_dread(desc, 1, 1, buf));
+	ut_assertok(check_blocks(uts, buf, 1, 1));
+	ut_asserteq(4, blk_dread(desc, 2, 4, buf));
+	ut_assertok(check_blocks(uts, buf, 2, 4));
+	ut_asserteq(3, blk_dread(desc, 6, 3, buf));
+	ut_assertok(check_blocks(uts, buf, 6, 3));
+	blkcache_stats(&stats);
+	ut_asserteq(3, stats.hits);
+	ut_asserteq(2, stats.misses);
+	ut_asserteq(7, stats.readahead);
+	ut_asserteq(2, stats.entries);
+
+	/* Readahead stops at the end of the device */
+	ut_asserteq(1, blk_dread(desc, BLK_CACHE_BLOCKS - 2, 1, buf));
+	ut_asserteq(1, blk_dread(desc, BLK_CACHE_BLOCKS - 1, 1, buf));
+	ut_assertok(check_blocks(uts, buf, BLK_CACHE_BLOCKS - 1, 1));
+	blkcache_stats(&stats);
+	ut_asserteq(7, stats.readahead);
+
+	/* Sequential reads past the end do not read ahead either */
+	blk_dread(desc, BLK_CACHE_BLOCKS, 1, buf);
+	blk_dread(desc, BLK_CACHE_BLOCKS + 1, 1, buf);
+	blkcache_stats(&stats);
+	ut_asserteq(7, stats.readahead);
+
+	/* Large reads bypass the cache */
+	big = malloc(BLK_CACHE_BLOCKS * 512);
+	ut_assertnonnull(big);
+	ut_asserteq(BLK_CACHE_BLOCKS, blk_dread(desc, 0, BLK_CACHE_BLOCKS,
+						 big));
+	ut_assertok(check_blocks(uts, big, 0, BLK_CACHE_BLOCKS));
+	free(big);
+	blkcache_stats(&stats);
+	ut_asserteq(6, stats.misses);
+
+	/* A write must drop stale data */
+	memset(buf, 0xaa, 512);
+	ut_asserteq(1, blk_dwrite(desc, 3, 1, buf));
+	blkcache_stats(&stats);
+	ut_asserteq(0, stats.entries);
+	memset(buf, '\0', 512);
+	ut_asserteq(1, blk_dread(desc, 3, 1, buf));
+	ut_asserteq(0xaa, buf[0]);
+	ut_asserteq(0xaa, buf[511]);
+
+	/* Only the least recently used entries are kept */
+	for (i = 0; i < 6; i++)
+		ut_asserteq(1, blk_dread(desc, 20 + i * 5, 1, buf));
+	blkcache_stats(&stats);
+	ut_asserteq(4, stats.entries);
+
+	/* Unbinding the device empties the cache */
+	ut_assertok(host_dev_bind(0, NULL));
+	blkcache_stats(&stats);
+	ut_asserteq(0, stats.entries);
+	blkcache_configure(8, 32, 8);
+	os_unlink(BLK_CACHE_FILE);
+
+	return 0;
+}
+DM_TEST(dm_test_blk_cache, DM_TESTF_SCAN_PDATA);
+#endif
@@ -12,6 +12,7 @@
 #include <fdtdec.h>
 #include <malloc.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/test.h>
@@ -67,6 +68,11 @@ static struct driver_info driver_info_pre_reloc = {
 	.platdata = &test_pdata_manual,
 };
 
+static struct driver_info driver_info_async = {
+	.name = "test_async_drv",
+	.platdata = &test_pdata_manual,
+};
+
 void dm_leak_check_start(struct unit_test_state *uts)
 {
 	uts->start = mallinfo();
@@ -796,3 +802,173 @@ static int dm_test_device_get_uclass_id(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_device_get_uclass_id, DM_TESTF_SCAN_PDATA);
+
+/* Find a node's driver the slow way, by checking every driver in turn */
+static int linear_lookup_compatible(const void *blob, int offset,
+				    struct driver **drvp,
+				    const struct udevice_id **of_idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *of_match;
+	struct driver *entry;
+	int ret;
+
+	*drvp = NULL;
+	*of_idp = NULL;
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_match = entry->of_match;
+		     of_match && of_match->compatible; of_match++) {
+			ret = fdt_node_check_compatible(blob, offset,
+							of_match->compatible);
+			if (ret == -FDT_ERR_NOTFOUND)
+				return -ENODEV;
+			if (!ret) {
+				*drvp = entry;
+				*of_idp = of_match;
+				return 0;
+			}
+		}
+	}
+
+	return -ENOENT;
+}
+
+/* Check driver and uclass lookups against a linear search, and time them */
+static int dm_test_lists_lookup(struct unit_test_state *uts)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_drv = ll_entry_count(struct driver, driver);
+	struct uclass_driver *uclass =
+		ll_entry_start(struct uclass_driver, uclass);
+	const int n_uc = ll_entry_count(struct uclass_driver, uclass);
+	struct dm_test_state *dms = uts->priv;
+	const void *blob = gd->fdt_blob;
+	const struct udevice_id *id, *expect_id;
+	struct uclass_driver *uc;
+	struct driver *drv, *expect;
+	ulong start, lookup_us, linear_us, bind_us;
+	int offset, depth, nodes;
+	int ret, expect_ret;
+	int i;
+
+	for (drv = driver; drv != driver + n_drv; drv++) {
+		for (expect = driver; strcmp(expect->name, drv->name); expect++)
+			;
+		ut_asserteq_ptr(expect, lists_driver_lookup_name(drv->name));
+	}
+	ut_asserteq_ptr(NULL, lists_driver_lookup_name("no-such-driver"));
+
+	for (i = 0; i < UCLASS_COUNT; i++) {
+		for (uc = uclass; uc != uclass + n_uc && uc->id != i; uc++)
+			;
+		ut_asserteq_ptr(uc != uclass + n_uc ? uc : NULL,
+				lists_uclass_lookup(i));
+	}
+
+	/* Every node must get the driver that the linear search finds */
+	nodes = 0;
+	depth = 0;
+	for (offset = 0; offset >= 0 && depth >= 0;
+	     offset = fdt_next_node(blob, offset, &depth)) {
+		ret = lists_driver_lookup_compatible(blob, offset, &drv, &id);
+		expect_ret = linear_lookup_compatible(blob, offset, &expect,
+						      &expect_id);
+		ut_asserteq(expect_ret, ret);
+		ut_asserteq_ptr(expect, drv);
+		ut_asserteq_ptr(expect_id, id);
+		nodes++;
+	}
+
+	start = timer_get_us();
+	for (i = 0; i < 100; i++) {
+		depth = 0;
+		for (offset = 0; offset >= 0 && depth >= 0;
+		     offset = fdt_next_node(blob, offset, &depth))
+			lists_driver_lookup_compatible(blob, offset, &drv, &id);
+	}
+	lookup_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < 100; i++) {
+		depth = 0;
+		for (offset = 0; offset >= 0 && depth >= 0;
+		     offset = fdt_next_node(blob, offset, &depth))
+			linear_lookup_compatible(blob, offset, &drv, &id);
+	}
+	linear_us = timer_get_us() - start;
+
+	/* Bind the whole tree a few times from a fresh root */
+	bind_us = 0;
+	for (i = 0; i < 10; i++) {
+		ut_assertok(dm_uninit());
+		gd->dm_root = NULL;
+		ut_assertok(dm_init());
+		start = timer_get_us();
+		ut_assertok(dm_scan_fdt(blob, false));
+		bind_us += timer_get_us() - start;
+	}
+	dms->root = dm_root();
+
+	printf("%d drivers, %d nodes: lookup %lu us, linear %lu us per pass, bind %lu us\n",
+	       n_drv, nodes, lookup_us / 100, linear_us / 100, bind_us / 10);
+
+	return 0;
+}
+DM_TEST(dm_test_lists_lookup, 0);
+
+/* Test that slow probes can overlap, and that users wait for them */
+static int dm_test_probe_async(struct unit_test_state *uts)
+{
+	struct dm_test_state *dms = uts->priv;
+	struct udevice *dev1, *dev2, *dev;
+	ulong start, serial_us, async_us;
+	int removed;
+
+	ut_assertok(device_bind_by_name(dms->root, false, &driver_info_async,
+					&dev1));
+	ut_assertok(device_bind_by_name(dms->root, false, &driver_info_async,
+					&dev2));
+
+	/* Probing the devices directly waits for each in turn */
+	start = timer_get_us();
+	ut_assertok(device_probe(dev1));
+	ut_assertok(device_probe(dev2));
+	serial_us = timer_get_us() - start;
+	ut_assert(serial_us >= 2 * DM_TEST_ASYNC_US);
+	ut_assertok(device_remove(dev1));
+	ut_assertok(device_remove(dev2));
+
+	/* Started together, the probes overlap */
+	start = timer_get_us();
+	ut_asserteq(2, dm_probe_async());
+	ut_assert(!device_active(dev1));
+	ut_assert(dev1->flags & DM_FLAG_PROBE_PENDING);
+	ut_asserteq(-EINPROGRESS, device_probe_start(dev1));
+	ut_asserteq(-EINVAL, device_unbind(dev1));
+
+	/* Looking the devices up waits until they are ready */
+	ut_assertok(uclass_get_device(UCLASS_TEST, 0, &dev));
+	ut_asserteq_ptr(dev1, dev);
+	ut_assert(device_active(dev1));
+	ut_assertok(uclass_get_device(UCLASS_TEST, 1, &dev));
+	ut_asserteq_ptr(dev2, dev);
+	async_us = timer_get_us() - start;
+	ut_assert(async_us < 2 * DM_TEST_ASYNC_US);
+	ut_asserteq(0, device_probe_poll());
+
+	/* Removing a device with a pending probe lets the probe finish first */
+	ut_assertok(device_remove(dev1));
+	ut_asserteq(-EINPROGRESS, device_probe_start(dev1));
+	removed = dm_testdrv_op_count[DM_TEST_OP_REMOVE];
+	ut_assertok(device_remove(dev1));
+	ut_assert(!(dev1->flags & DM_FLAG_PROBE_PENDING));
+	ut_asserteq(removed + 1, dm_testdrv_op_count[DM_TEST_OP_REMOVE]);
+	ut_asserteq(0, device_probe_poll());
+
+	printf("Two %u us probes: %lu us one after the other, %lu us together\n",
+	       DM_TEST_ASYNC_US, serial_us, async_us);
+
+	return 0;
+}
+DM_TEST(dm_test_probe_async, 0);
@@ -11,6 +11,7 @@
 #include <dm.h>
 #include <fdtdec.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <net.h>
 #include <dm/test.h>
 #include <dm/device-internal.h>
@@ -259,3 +260,214 @@ static int dm_test_net_retry(struct unit_test_state *uts)
 	return retval;
 }
 DM_TEST(dm_test_net_retry, DM_TESTF_SCAN_FDT);
+
+/* Load a file from the mock TFTP server, returning the number of ACKs */
+static int _dm_test_eth_tftp_load(struct unit_test_state *uts,
+				  const char *windowsize, const uchar *file,
+				  ulong size, ulong drop_block)
+{
+	struct sandbox_eth_tftp_stats stats;
+	ulong start, usecs;
+	uchar *buf;
+
+	sandbox_eth_tftp_set_file(file, size, 16, drop_block);
+	setenv("tftpwindowsize", windowsize);
+	buf = map_sysmem(load_addr, size);
+	memset(buf, '\0', size);
+	start = timer_get_us();
+	ut_asserteq(size, net_loop(TFTPGET));
+	usecs = max(timer_get_us() - start, 1UL);
+	ut_assertok(memcmp(buf, file, size));
+	unmap_sysmem(buf);
+
+	sandbox_eth_tftp_get_stats(&stats);
+	printf("windowsize %s: %lu blocks, %lu ACKs, %lu blocks/sec\n",
+	       windowsize, stats.data, stats.acks,
+	       (ulong)((u64)stats.data * 1000000 / usecs));
+
+	return stats.acks;
+}
+
+/* Test TFTP downloads with and without RFC 7440 windows */
+static int dm_test_eth_tftp_window(struct unit_test_state *uts)
+{
+	const ulong size = 300 * 1024;
+	ulong blocks = size / 1468 + 1;
+	uchar *file;
+	int acks;
+	int i;
+
+	file = malloc(size);
+	ut_assertnonnull(file);
+	for (i = 0; i < size; i++)
+		file[i] = i ^ (i >> 9);
+
+	net_server_ip = string_to_ip("1.1.2.2");
+	copy_filename(net_boot_file_name, "u-boot.bin",
+		      sizeof(net_boot_file_name));
+	setenv("ethact", "eth@10002000");
+	setenv("tftpblocksize", "1468");
+
+	/* Lock-step: one ACK per block, plus one for the OACK */
+	acks = _dm_test_eth_tftp_load(uts, "1", file, size, 0);
+	ut_asserteq(blocks + 1, acks);
+
+	/* A window of 16 blocks needs one ACK per window */
+	acks = _dm_test_eth_tftp_load(uts, "16", file, size, 0);
+	ut_asserteq(DIV_ROUND_UP(blocks, 16) + 1, acks);
+
+	/* Without the variable, the default of no window is used again */
+	acks = _dm_test_eth_tftp_load(uts, NULL, file, size, 0);
+	ut_asserteq(blocks + 1, acks);
+
+	/* Asking for more than the server allows is clamped in the OACK */
+	acks = _dm_test_eth_tftp_load(uts, "64", file, size, 0);
+	ut_asserteq(DIV_ROUND_UP(blocks, 16) + 1, acks);
+
+	/*
+	 * Block 20 is lost, so block 19 is ACKed as soon as block 21 arrives
+	 * and the windows restart from there
+	 */
+	acks = _dm_test_eth_tftp_load(uts, "16", file, size, 20);
+	ut_asserteq(1 + 2 + DIV_ROUND_UP(blocks - 19, 16), acks);
+
+	sandbox_eth_tftp_set_file(NULL, 0, 1, 0);
+	setenv("tftpwindowsize", NULL);
+	setenv("tftpblocksize", NULL);
+	free(file);
+
+	return 0;
+}
+DM_TEST(dm_test_eth_tftp_window, DM_TESTF_SCAN_FDT);
+
+/* Test receiving TFTP data straight into place, and the copy fallback */
+static int dm_test_eth_rx_dest(struct unit_test_state *uts)
+{
+	const ulong size = 100 * 1024;
+	ulong blocks = size / 1468 + 1;
+	uchar *file, *guard;
+	int i;
+
+	file = malloc(size);
+	ut_assertnonnull(file);
+	for (i = 0; i < size; i++)
+		file[i] = i ^ (i >> 7);
+
+	net_server_ip = string_to_ip("1.1.2.2");
+	copy_filename(net_boot_file_name, "u-boot.bin",
+		      sizeof(net_boot_file_name));
+	setenv("ethact", "eth@10002000");
+	setenv("tftpblocksize", "1468");
+
+	/* Every block is placed, and so is the OACK which is copied back */
+	sandbox_eth_get_rx_placed();
+	_dm_test_eth_tftp_load(uts, "1", file, size, 0);
+	ut_asserteq(blocks + 1, sandbox_eth_get_rx_placed());
+
+	/* With a window and a lost block, the wrong blocks are placed too */
+	_dm_test_eth_tftp_load(uts, "16", file, size, 20);
+	ut_assert(sandbox_eth_get_rx_placed() > blocks + 1);
+
+	/*
+	 * An ARP request after the last block is not placed, so it does not
+	 * land on the data or beyond the end of the file
+	 */
+	sandbox_eth_tftp_send_arp(true);
+	guard = map_sysmem(load_addr + size, 64);
+	memset(guard, 0x5a, 64);
+	_dm_test_eth_tftp_load(uts, "1", file, size, 0);
+	ut_asserteq(blocks + 1, sandbox_eth_get_rx_placed());
+	for (i = 0; i < 64; i++)
+		ut_asserteq(0x5a, guard[i]);
+	unmap_sysmem(guard);
+	sandbox_eth_tftp_send_arp(false);
+
+	/* Without driver support the data is copied */
+	sandbox_eth_disable_rx_dest(true);
+	_dm_test_eth_tftp_load(uts, "1", file, size, 0);
+	ut_asserteq(0, sandbox_eth_get_rx_placed());
+	sandbox_eth_disable_rx_dest(false);
+
+	/* Nothing is placed after the transfer */
+	net_ping_ip = string_to_ip("1.1.2.2");
+	ut_assertok(net_loop(PING));
+	ut_asserteq(0, sandbox_eth_get_rx_placed());
+
+	sandbox_eth_tftp_set_file(NULL, 0, 1, 0);
+	setenv("tftpwindowsize", NULL);
+	setenv("tftpblocksize", NULL);
+	free(file);
+
+	return 0;
+}
+DM_TEST(dm_test_eth_rx_dest, DM_TESTF_SCAN_FDT);
+
+/* Load a file from the mock NFS server */
+static int _dm_test_eth_nfs_load(struct unit_test_state *uts,
+				 const uchar *file, ulong size,
+				 int max_version, bool reorder,
+				 struct sandbox_eth_nfs_stats *stats)
+{
+	ulong start, usecs;
+	uchar *buf;
+
+	sandbox_eth_nfs_set_file(file, size, max_version, reorder);
+	buf = map_sysmem(load_addr, size);
+	memset(buf, '\0', size);
+	start = timer_get_us();
+	ut_asserteq(size, net_loop(NFS));
+	usecs = max(timer_get_us() - start, 1UL);
+	ut_assertok(memcmp(buf, file, size));
+	unmap_sysmem(buf);
+
+	sandbox_eth_nfs_get_stats(stats);
+	printf("NFSv%d: %lu reads of %lu bytes, %lu in flight, %lu KiB/sec\n",
+	       stats->version, stats->reads, stats->max_count,
+	       stats->max_in_flight,
+	       (ulong)((u64)size * 1000000 / 1024 / usecs));
+
+	return 0;
+}
+
+/* Test NFSv3 and NFSv2 downloads with several reads in flight */
+static int dm_test_eth_nfs(struct unit_test_state *uts)
+{
+	struct sandbox_eth_nfs_stats stats;
+	const ulong size = 200 * 1024 + 123;
+	uchar *file;
+	int i;
+
+	file = malloc(size);
+	ut_assertnonnull(file);
+	for (i = 0; i < size; i++)
+		file[i] = i ^ (i >> 11);
+
+	net_server_ip = string_to_ip("1.1.2.2");
+	copy_filename(net_boot_file_name, "/export/u-boot.bin",
+		      sizeof(net_boot_file_name));
+	setenv("ethact", "eth@10002000");
+
+	/* NFSv3 reads large blocks, which arrive as IP fragments */
+	ut_assertok(_dm_test_eth_nfs_load(uts, file, size, 3, false, &stats));
+	ut_asserteq(3, stats.version);
+	ut_asserteq(8192, stats.max_count);
+	ut_asserteq(4, stats.max_in_flight);
+	ut_assert(stats.reads >= DIV_ROUND_UP(size, 8192));
+
+	/* Replies which arrive out of order are stored in the right place */
+	ut_assertok(_dm_test_eth_nfs_load(uts, file, size, 3, true, &stats));
+	ut_asserteq(3, stats.version);
+
+	/* A server without NFSv3 is read with NFSv2 */
+	ut_assertok(_dm_test_eth_nfs_load(uts, file, size, 2, false, &stats));
+	ut_asserteq(2, stats.version);
+	ut_asserteq(1024, stats.max_count);
+	ut_asserteq(4, stats.max_in_flight);
+	ut_assert(stats.reads >= DIV_ROUND_UP(size, 1024));
+
+	sandbox_eth_nfs_set_file(NULL, 0, 3, false);
+	free(file);
+
+	return 0;
+}
+DM_TEST(dm_test_eth_nfs, DM_TESTF_SCAN_FDT);
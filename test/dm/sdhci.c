@@ -0,0 +1,159 @@
+/*
+ * Tests for the SDHCI ADMA2 descriptor tables
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <malloc.h>
+#include <sdhci.h>
+#include <dm/test.h>
+#include <linux/sizes.h>
+#include <test/ut.h>
+
+/* Check one descriptor in the table */
+static int check_desc(struct unit_test_state *uts, struct sdhci_host *host,
+		      int index, dma_addr_t addr, uint len, bool end)
+{
+	struct sdhci_adma_desc *desc;
+	uint attr = SDHCI_ADMA_VALID | SDHCI_ADMA_TRAN;
+
+	desc = host->adma_desc_table + index * host->adma_desc_len;
+	if (end)
+		attr |= SDHCI_ADMA_END;
+	ut_asserteq(attr, le16_to_cpu(desc->attr));
+	ut_asserteq(len, le16_to_cpu(desc->len));
+	ut_asserteq(lower_32_bits(addr), le32_to_cpu(desc->addr_lo));
+	if (host->flags & SDHCI_USE_64BIT_DMA)
+		ut_asserteq(upper_32_bits(addr), le32_to_cpu(desc->addr_hi));
+
+	return 0;
+}
+
+/* Test choosing ADMA2 from the controller capabilities */
+static int dm_test_sdhci_adma_caps(struct unit_test_state *uts)
+{
+	struct sdhci_host host;
+
+	memset(&host, '\0', sizeof(host));
+	host.version = SDHCI_SPEC_300;
+	sdhci_adma_setup(&host, SDHCI_CAN_DO_SDMA);
+	ut_asserteq(0, host.flags);
+
+	sdhci_adma_setup(&host, SDHCI_CAN_DO_ADMA2);
+	ut_asserteq(SDHCI_USE_ADMA, host.flags);
+	ut_asserteq(SDHCI_ADMA_DESC_LEN_32, host.adma_desc_len);
+
+	/* Sandbox DMA addresses are 64 bits wide */
+	sdhci_adma_setup(&host, SDHCI_CAN_DO_ADMA2 | SDHCI_CAN_64BIT);
+	ut_asserteq(SDHCI_USE_ADMA | SDHCI_USE_64BIT_DMA, host.flags);
+	ut_asserteq(SDHCI_ADMA_DESC_LEN_64, host.adma_desc_len);
+
+	/* 64-bit ADMA2 needs a version 3.00 controller */
+	host.version = SDHCI_SPEC_200;
+	sdhci_adma_setup(&host, SDHCI_CAN_DO_ADMA2 | SDHCI_CAN_64BIT);
+	ut_asserteq(SDHCI_USE_ADMA, host.flags);
+	ut_asserteq(SDHCI_ADMA_DESC_LEN_32, host.adma_desc_len);
+
+	host.quirks = SDHCI_QUIRK_BROKEN_ADMA;
+	sdhci_adma_setup(&host, SDHCI_CAN_DO_ADMA2);
+	ut_asserteq(0, host.flags);
+
+	return 0;
+}
+DM_TEST(dm_test_sdhci_adma_caps, 0);
+
+/* Test splitting a transfer into 32-bit descriptors */
+static int dm_test_sdhci_adma_desc(struct unit_test_state *uts)
+{
+	const uint max_bytes = CONFIG_SYS_MMC_MAX_BLK_COUNT * MMC_MAX_BLOCK_LEN;
+	const dma_addr_t addr = 0x10000000;
+	struct sdhci_host host;
+	uint len;
+
+	memset(&host, '\0', sizeof(host));
+	host.version = SDHCI_SPEC_300;
+	sdhci_adma_setup(&host, SDHCI_CAN_DO_ADMA2);
+	ut_assertok(sdhci_adma_init(&host));
+	ut_assertnonnull(host.adma_desc_table);
+	ut_asserteq(DIV_ROUND_UP(max_bytes, SDHCI_ADMA_MAX_LEN),
+		    host.adma_entries);
+
+	/* A single block needs one descriptor */
+	ut_asserteq(1, sdhci_adma_prepare(&host, addr, 512));
+	ut_assertok(check_desc(uts, &host, 0, addr, 512, true));
+
+	/* 400 blocks need three full descriptors and part of another */
+	len = 400 * 512;
+	ut_asserteq(4, sdhci_adma_prepare(&host, addr, len));
+	ut_assertok(check_desc(uts, &host, 0, addr, SDHCI_ADMA_MAX_LEN, false));
+	ut_assertok(check_desc(uts, &host, 1, addr + SDHCI_ADMA_MAX_LEN,
+			       SDHCI_ADMA_MAX_LEN, false));
+	ut_assertok(check_desc(uts, &host, 2, addr + 2 * SDHCI_ADMA_MAX_LEN,
+			       SDHCI_ADMA_MAX_LEN, false));
+	ut_assertok(check_desc(uts, &host, 3, addr + 3 * SDHCI_ADMA_MAX_LEN,
+			       len - 3 * SDHCI_ADMA_MAX_LEN, true));
+
+	/* The largest transfer fills the table */
+	ut_asserteq(host.adma_entries,
+		    sdhci_adma_prepare(&host, addr, max_bytes));
+	ut_assertok(check_desc(uts, &host, host.adma_entries - 1,
+			       addr + (host.adma_entries - 1) *
+			       SDHCI_ADMA_MAX_LEN,
+			       max_bytes - (host.adma_entries - 1) *
+			       SDHCI_ADMA_MAX_LEN, true));
+	ut_asserteq(-E2BIG, sdhci_adma_prepare(&host, addr,
+				host.adma_entries * SDHCI_ADMA_MAX_LEN + 4));
+
+	/* Buffers which ADMA cannot use */
+	ut_asserteq(-EINVAL, sdhci_adma_prepare(&host, addr, 0));
+	ut_asserteq(-EINVAL, sdhci_adma_prepare(&host, addr + 2, 512));
+	ut_asserteq(-ERANGE, sdhci_adma_prepare(&host, 0xfffffe00, 1024));
+	ut_asserteq(-ERANGE, sdhci_adma_prepare(&host, 0x100000000ULL, 512));
+
+	free(host.adma_desc_table);
+
+	return 0;
+}
+DM_TEST(dm_test_sdhci_adma_desc, 0);
+
+/* Test 64-bit descriptors and splitting at a 128MB boundary */
+static int dm_test_sdhci_adma_boundary(struct unit_test_state *uts)
+{
+	const uint max_bytes = CONFIG_SYS_MMC_MAX_BLK_COUNT * MMC_MAX_BLOCK_LEN;
+	const dma_addr_t addr = 0x107fff000ULL;
+	struct sdhci_host host;
+	int count;
+
+	memset(&host, '\0', sizeof(host));
+	host.version = SDHCI_SPEC_300;
+	host.quirks = SDHCI_QUIRK_ADMA_128M_BOUNDARY;
+	sdhci_adma_setup(&host, SDHCI_CAN_DO_ADMA2 | SDHCI_CAN_64BIT);
+	ut_asserteq(SDHCI_USE_ADMA | SDHCI_USE_64BIT_DMA, host.flags);
+	ut_assertok(sdhci_adma_init(&host));
+
+	/* The first descriptor stops at the boundary */
+	ut_asserteq(2, sdhci_adma_prepare(&host, addr, 0x4000));
+	ut_assertok(check_desc(uts, &host, 0, addr, 0x1000, false));
+	ut_assertok(check_desc(uts, &host, 1, 0x108000000ULL, 0x3000, true));
+
+	/* Nothing is split without the quirk */
+	host.quirks = 0;
+	ut_asserteq(1, sdhci_adma_prepare(&host, addr, 0x4000));
+	ut_assertok(check_desc(uts, &host, 0, addr, 0x4000, true));
+
+	/* The largest transfer still fits when it crosses a boundary */
+	host.quirks = SDHCI_QUIRK_ADMA_128M_BOUNDARY;
+	count = sdhci_adma_prepare(&host, addr, max_bytes);
+	ut_assert(count > 0);
+	ut_assert(count <= host.adma_entries);
+	ut_assertok(check_desc(uts, &host, 0, addr, 0x1000, false));
+	ut_assertok(check_desc(uts, &host, 1, 0x108000000ULL,
+			       SDHCI_ADMA_MAX_LEN, false));
+
+	free(host.adma_desc_table);
+
+	return 0;
+}
+DM_TEST(dm_test_sdhci_adma_boundary, 0);
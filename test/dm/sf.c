@@ -7,6 +7,7 @@
 #include <common.h>
 #include <dm.h>
 #include <fdtdec.h>
+#include <os.h>
 #include <spi.h>
 #include <spi_flash.h>
 #include <asm/state.h>
@@ -31,7 +32,8 @@ static int dm_test_spi_flash(struct unit_test_state *uts)
 	ut_asserteq(0, run_command_list(
 		"sb save hostfs - 0 spi.bin 200000;"
 		"sf probe;"
-		"sf test 0 10000", -1,  0));
+		"sf test 0 10000;"
+		"sf bench 0 10000", -1,  0));
 	/*
 	 * Since we are about to destroy all devices, we must tell sandbox
 	 * to forget the emulation device
@@ -41,3 +43,53 @@ static int dm_test_spi_flash(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_spi_flash, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_SPI_FLASH_4BYTE_ADDR
+/* Test that a flash over 16MB uses 4-byte addresses and direct reads */
+static int dm_test_spi_flash_4b(struct unit_test_state *uts)
+{
+	struct sandbox_state *state = state_get_current();
+	const int busnum = 0, cs = 1, offset = 0x1ff0000;
+	struct spi_flash *flash;
+	struct udevice *dev;
+	u8 buf[0x100], vbuf[0x100];
+	const int len = sizeof(buf);
+	int i;
+
+	/* The backing file is sparse, so the whole 64MB is cheap */
+	ut_assertok(run_command("sb save hostfs - 0 spi4b.bin 1000", 0));
+	state->spi[busnum][cs].spec = "mx25l51235f:spi4b.bin";
+	ut_assertok(spi_flash_probe_bus_cs(busnum, cs, 1000000, 0, &dev));
+	flash = dev_get_uclass_priv(dev);
+	ut_asserteq(64 << 20, flash->size);
+	ut_asserteq(4, flash->addr_width);
+	ut_asserteq(BIT(SF_READ_XFER) | BIT(SF_READ_DIRECT), flash->read_modes);
+	ut_asserteq(SF_READ_DIRECT, flash->read_mode);
+
+	/* Write above 16MB, which needs the top address byte */
+	for (i = 0; i < len; i++)
+		buf[i] = i;
+	ut_assertok(spi_flash_erase_dm(dev, offset, flash->erase_size));
+	ut_assertok(spi_flash_write_dm(dev, offset, len, buf));
+
+	memset(vbuf, '\0', len);
+	ut_assertok(spi_flash_read_dm(dev, offset, len, vbuf));
+	ut_assertok(memcmp(buf, vbuf, len));
+
+	flash->read_mode = SF_READ_XFER;
+	memset(vbuf, '\0', len);
+	ut_assertok(spi_flash_read_dm(dev, offset, len, vbuf));
+	ut_assertok(memcmp(buf, vbuf, len));
+
+	/* Nothing was written at the same offset in the lower 16MB */
+	ut_assertok(spi_flash_read_dm(dev, offset & 0xffffff, len, vbuf));
+	ut_assert(memcmp(buf, vbuf, len));
+
+	sandbox_sf_unbind_emul(state, busnum, cs);
+	state->spi[busnum][cs].spec = NULL;
+	os_unlink("spi4b.bin");
+
+	return 0;
+}
+DM_TEST(dm_test_spi_flash_4b, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
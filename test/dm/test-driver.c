@@ -157,3 +157,38 @@ U_BOOT_DRIVER(test_pre_reloc_drv) = {
 	.unbind	= test_manual_unbind,
 	.flags	= DM_FLAG_PRE_RELOC,
 };
+
+/* Pretend that the hardware takes DM_TEST_ASYNC_US to be ready */
+static int test_async_probe(struct udevice *dev)
+{
+	struct dm_test_priv *priv = dev_get_priv(dev);
+
+	dm_testdrv_op_count[DM_TEST_OP_PROBE]++;
+	priv->probe_start = timer_get_us();
+
+	return -EINPROGRESS;
+}
+
+static int test_async_probe_poll(struct udevice *dev)
+{
+	struct dm_test_priv *priv = dev_get_priv(dev);
+
+	if (timer_get_us() - priv->probe_start < DM_TEST_ASYNC_US)
+		return -EINPROGRESS;
+	priv->ping_total += DM_TEST_START_TOTAL;
+
+	return 0;
+}
+
+U_BOOT_DRIVER(test_async_drv) = {
+	.name	= "test_async_drv",
+	.id	= UCLASS_TEST,
+	.ops	= &test_ops,
+	.bind	= test_bind,
+	.probe	= test_async_probe,
+	.probe_poll = test_async_probe_poll,
+	.remove	= test_remove,
+	.unbind	= test_unbind,
+	.priv_auto_alloc_size = sizeof(struct dm_test_priv),
+	.flags	= DM_FLAG_PROBE_ASYNC,
+};
@@ -266,3 +266,71 @@ static int dm_test_fdt_offset(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_fdt_offset, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_OF_LIVE
+/* Test that the live tree gives the same answers as the flat tree */
+static int dm_test_fdt_live(struct unit_test_state *uts)
+{
+	const void *blob = gd->fdt_blob;
+	int offset, depth = 0;
+	int prop, node;
+
+	ut_assertok(of_live_build(blob));
+	ut_assert(of_live_active(blob));
+
+	for (offset = 0; offset >= 0 && depth >= 0;
+	     offset = fdt_next_node(blob, offset, &depth)) {
+		const struct of_live_node *lnode = of_live_get_node(offset);
+		uint32_t phandle;
+		int count = 0;
+
+		ut_assertnonnull(lnode);
+		ut_asserteq_str(fdt_get_name(blob, offset, NULL), lnode->name);
+		ut_asserteq(fdt_parent_offset(blob, offset),
+			    of_live_parent_offset(offset));
+		for (prop = fdt_first_property_offset(blob, offset);
+		     prop >= 0;
+		     prop = fdt_next_property_offset(blob, prop), count++) {
+			const char *name;
+			int len, live_len;
+			const void *val;
+
+			val = fdt_getprop_by_offset(blob, prop, &name, &len);
+			ut_asserteq_ptr(val, of_live_getprop(offset, name,
+							     &live_len));
+			ut_asserteq(len, live_len);
+		}
+		ut_asserteq(count, lnode->prop_count);
+		phandle = fdt_get_phandle(blob, offset);
+		if (phandle)
+			ut_asserteq(offset,
+				    of_live_node_offset_by_phandle(phandle));
+	}
+
+	ut_asserteq_ptr(NULL, of_live_getprop(0, "no-such-property", &prop));
+	ut_asserteq(-FDT_ERR_NOTFOUND, prop);
+	ut_asserteq(-FDT_ERR_BADOFFSET, of_live_parent_offset(1));
+
+	/* Paths, with and without unit addresses */
+	node = fdt_path_offset(blob, "/some-bus/c-test@5");
+	ut_assert(node > 0);
+	ut_asserteq(node, of_live_path_offset("/some-bus/c-test@5"));
+	ut_asserteq(fdt_path_offset(blob, "/some-bus/c-test"),
+		    of_live_path_offset("/some-bus/c-test"));
+	ut_asserteq(0, of_live_path_offset("/"));
+	ut_asserteq(-FDT_ERR_NOTFOUND, of_live_path_offset("/no-such-node"));
+
+	/* Walk all compatible nodes */
+	node = -1;
+	do {
+		offset = fdt_node_offset_by_compatible(blob, node,
+						       "denx,u-boot-fdt-test");
+		node = of_live_node_offset_by_compatible(node,
+							 "denx,u-boot-fdt-test");
+		ut_asserteq(offset, node);
+	} while (node >= 0);
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_live, 0);
+#endif
@@ -0,0 +1,69 @@
+#!/bin/bash
+#
+# Sanity check for the dtoc tool
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# To run this:
+#
+# make O=sandbox sandbox_config
+# make O=sandbox
+# ./test/dtoc/test-dtoc.sh
+#
+# This converts dtoc-test.dts, checks the structures against
+# dtoc-test.structs and then compiles the platform data, so that a value
+# which does not fit its member is caught by the compiler.
+
+BASEDIR=sandbox
+DTOC=${BASEDIR}/tools/dtoc
+DTC=${DTC:-dtc}
+CC=${CC:-cc}
+SRCDIR=test/dtoc
+OUT_DIR=${BASEDIR}/test/dtoc
+DTB=${OUT_DIR}/dtoc-test.dtb
+
+fail()
+{
+	echo "$@"
+	echo "Failed."
+	exit 1
+}
+
+# Write headers which stand in for the U-Boot ones used by the output
+create_stubs()
+{
+	mkdir -p ${OUT_DIR}/include/linux ${OUT_DIR}/include/generated
+	echo >${OUT_DIR}/include/common.h
+	cat >${OUT_DIR}/include/dm.h <<EOF
+struct driver_info {
+	const char *name;
+	const void *platdata;
+};
+#define U_BOOT_DEVICE(__name) struct driver_info __name
+EOF
+	cat >${OUT_DIR}/include/linux/types.h <<EOF
+#include <stdbool.h>
+typedef unsigned int u32;
+EOF
+	echo "#include <generated/dt-structs.h>" \
+		>${OUT_DIR}/include/dt-structs.h
+}
+
+mkdir -p ${OUT_DIR}
+${DTC} -I dts -O dtb -o ${DTB} ${SRCDIR}/dtoc-test.dts ||
+	fail "Cannot compile ${SRCDIR}/dtoc-test.dts"
+
+create_stubs
+${DTOC} -o ${OUT_DIR}/include/generated/dt-structs.h structs ${DTB} ||
+	fail "dtoc structs failed"
+${DTOC} -o ${OUT_DIR}/dt-platdata.c platdata ${DTB} ||
+	fail "dtoc platdata failed"
+
+diff -u ${SRCDIR}/dtoc-test.structs \
+	${OUT_DIR}/include/generated/dt-structs.h ||
+	fail "Structures do not match"
+
+${CC} -Wall -Werror -I${OUT_DIR}/include -c -o ${OUT_DIR}/dt-platdata.o \
+	${OUT_DIR}/dt-platdata.c || fail "Platform data does not compile"
+
+echo "Test passed."
@@ -0,0 +1,141 @@
+/*
+ * Tests for the hash table which holds the environment
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <search.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+/* Length of exported '\0'-separated data, up to the empty string at the end */
+static size_t export_len(const char *buf)
+{
+	const char *p = buf;
+
+	while (*p)
+		p += strlen(p) + 1;
+
+	return p - buf;
+}
+
+/*
+ * Check that exporting everything with '\0' separators, which uses the
+ * cached export, gives the same result as an export built from scratch.
+ * H_HIDE_DOT stops hexport_r() from using the cache, and no test key
+ * starts with '.'.
+ */
+static int check_export(struct unit_test_state *uts,
+			struct hsearch_data *htab)
+{
+	char *cached = NULL, *full = NULL;
+	size_t len;
+
+	ut_assert(hexport_r(htab, '\0', 0, &cached, 0, 0, NULL) > 0);
+	ut_assert(hexport_r(htab, '\0', H_HIDE_DOT, &full, 0, 0, NULL) > 0);
+	len = export_len(full);
+	ut_asserteq(len, export_len(cached));
+	ut_assertok(memcmp(cached, full, len));
+	free(cached);
+	free(full);
+
+	return 0;
+}
+
+static int htab_set(struct hsearch_data *htab, const char *key,
+		    const char *data)
+{
+	ENTRY e, *ep;
+
+	e.key = key;
+	e.data = (char *)data;
+	hsearch_r(e, ENTER, &ep, htab, 0);
+
+	return ep ? 0 : -ENOMEM;
+}
+
+static int env_test_htab_export(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+	char *buf = NULL;
+
+	memset(&htab, '\0', sizeof(htab));
+	ut_assert(hcreate_r(32, &htab));
+	ut_assertok(check_export(uts, &htab));
+
+	ut_assertok(htab_set(&htab, "bbb", "2"));
+	ut_assertok(htab_set(&htab, "ddd", "4"));
+	ut_assertok(htab_set(&htab, "fff", "6"));
+	ut_assertok(check_export(uts, &htab));
+
+	/* Insert at the start, end and in the middle */
+	ut_assertok(htab_set(&htab, "aaa", "1"));
+	ut_assertok(check_export(uts, &htab));
+	ut_assertok(htab_set(&htab, "zzz", "26"));
+	ut_assertok(check_export(uts, &htab));
+	ut_assertok(htab_set(&htab, "ccc", "3"));
+	ut_assertok(check_export(uts, &htab));
+
+	/* Overwrite with longer, shorter and escaped values */
+	ut_assertok(htab_set(&htab, "ddd", "a much longer value"));
+	ut_assertok(check_export(uts, &htab));
+	ut_assertok(htab_set(&htab, "aaa", ""));
+	ut_assertok(check_export(uts, &htab));
+	ut_assertok(htab_set(&htab, "zzz", "back\\slash"));
+	ut_assertok(check_export(uts, &htab));
+
+	/* Delete the entry which sorts last, then the first and the rest */
+	ut_assert(hdelete_r("zzz", &htab, 0));
+	ut_assertok(check_export(uts, &htab));
+	ut_assert(hexport_r(&htab, '\0', 0, &buf, 0, 0, NULL) > 0);
+	ut_asserteq_str("fff=6", buf + export_len(buf) - strlen("fff=6") - 1);
+	free(buf);
+	ut_assert(hdelete_r("aaa", &htab, 0));
+	ut_assertok(check_export(uts, &htab));
+	ut_assert(hdelete_r("ddd", &htab, 0));
+	ut_assertok(check_export(uts, &htab));
+	ut_assert(hdelete_r("bbb", &htab, 0));
+	ut_assert(hdelete_r("ccc", &htab, 0));
+	ut_assert(hdelete_r("fff", &htab, 0));
+	ut_assertok(check_export(uts, &htab));
+
+	/* Import into the emptied table and then over the top of it */
+	ut_assert(himport_r(&htab, "b=1\0a=2\0", 9, '\0', H_NOCLEAR, 0, 0,
+			    NULL));
+	ut_assertok(check_export(uts, &htab));
+	ut_assert(himport_r(&htab, "c=3\0b=4\0", 9, '\0', H_NOCLEAR, 0, 0,
+			    NULL));
+	ut_assertok(check_export(uts, &htab));
+	hdestroy_r(&htab);
+
+	return 0;
+}
+ENV_TEST(env_test_htab_export, 0);
+
+/* Importing over an existing table must not use more memory each time */
+static int env_test_htab_import_noclear(struct unit_test_state *uts)
+{
+	static const char env[] = "var1=value1\0var2=value2\0var3=value3\0";
+	struct hsearch_data htab;
+	struct mallinfo start;
+	int i;
+
+	memset(&htab, '\0', sizeof(htab));
+	ut_assert(himport_r(&htab, env, sizeof(env), '\0', 0, 0, 0, NULL));
+	ut_assert(himport_r(&htab, env, sizeof(env), '\0', H_NOCLEAR, 0, 0,
+			    NULL));
+	start = mallinfo();
+	for (i = 0; i < 1000; i++) {
+		ut_assert(himport_r(&htab, env, sizeof(env), '\0', H_NOCLEAR,
+				    0, 0, NULL));
+	}
+	ut_asserteq(start.uordblks, mallinfo().uordblks);
+	ut_asserteq(3, htab.filled);
+	hdestroy_r(&htab);
+
+	return 0;
+}
+ENV_TEST(env_test_htab_import_noclear, 0);
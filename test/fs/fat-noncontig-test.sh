@@ -21,7 +21,11 @@
 # The test will create a FAT filesystem image, record the CRC of a randomly
 # generated file in the image, build U-Boot sandbox, invoke U-Boot sandbox to
 # read the file and validate that the CRCs match. Expected output is shown
-# below. The important part of the log is the penultimate line that contains
+# below. The file is loaded twice, the second time using the cluster chain
+# cached by the first load. Then the file is rewritten with fatwrite with
+# new contents of the same size, and loaded again. This checks that no
+# cluster chain is kept from before the write, even though the boot sector
+# is the same. The important part of the log is the lines that contain
 # either "PASS" or "FAILURE".
 #
 #    mkfs.fat 3.0.26 (2014-03-07)
@@ -55,12 +59,15 @@
 
 odir=sandbox
 img=${odir}/fat-noncontig.img
+scratch=${odir}/fat-noncontig-scratch.img
+newfile=${odir}/fat-noncontig-new.bin
 mnt=${odir}/mnt
 fill=/dev/urandom
 testfn=noncontig.img
 mnttestfn=${mnt}/${testfn}
 crcaddr=0
 loadaddr=1000
+imgaddr=3000000
 
 for prereq in fallocate mkfs.fat dd crc32; do
     if [ ! -x "`which $prereq`" ]; then
@@ -114,29 +121,48 @@ if [ ! -f ${img} ]; then
     fi
 fi
 
+# Print the CRC of file $1, in the byte order of itest.l
+file_crc() {
+    crc=0x`crc32 $1`
+    printf %02x%02x%02x%02x \
+        $((${crc} & 0xff)) \
+        $(((${crc} >> 8) & 0xff)) \
+        $(((${crc} >> 16) & 0xff)) \
+        $((${crc} >> 24))
+}
+
 sudo mount -o ro,loop,uid=$(id -u) ${img} ${mnt}
 if [ $? -ne 0 ]; then
     echo Could not mount test filesystem
     exit $?
 fi
-crc=0x`crc32 ${mnttestfn}`
+crc=`file_crc ${mnttestfn}`
+size=`stat -c %s ${mnttestfn}`
 sudo umount ${mnt}
 if [ $? -ne 0 ]; then
     echo Could not unmount test filesystem
     exit $?
 fi
 
-crc=`printf %02x%02x%02x%02x \
-    $((${crc} & 0xff)) \
-    $(((${crc} >> 8) & 0xff)) \
-    $(((${crc} >> 16) & 0xff)) \
-    $((${crc} >> 24))`
+# New contents for the test file, with the same size
+head -c ${size} ${fill} > ${newfile}
+crc2=`file_crc ${newfile}`
 
+cp ${img} ${scratch}
 ./sandbox/u-boot << EOF
-host bind 0 ${img}
+host bind 0 ${scratch}
+load host 0:0 ${loadaddr} ${testfn}
+crc32 ${loadaddr} \$filesize ${crcaddr}
+if itest.l *${crcaddr} != ${crc}; then echo FAILURE; else echo PASS; fi
+mw.b ${loadaddr} 0 \$filesize
 load host 0:0 ${loadaddr} ${testfn}
 crc32 ${loadaddr} \$filesize ${crcaddr}
 if itest.l *${crcaddr} != ${crc}; then echo FAILURE; else echo PASS; fi
+load hostfs - ${imgaddr} ${newfile}
+fatwrite host 0:0 ${imgaddr} ${testfn} \$filesize
+load host 0:0 ${loadaddr} ${testfn}
+crc32 ${loadaddr} \$filesize ${crcaddr}
+if itest.l *${crcaddr} != ${crc2}; then echo FAILURE; else echo PASS; fi
 reset
 EOF
 if [ $? -ne 0 ]; then
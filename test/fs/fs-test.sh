@@ -16,10 +16,12 @@
 # fs-test.sb.fat.out: Summary: PASS: 17 FAIL: 2
 # fs-test.fat.out: Summary: PASS: 19 FAIL: 0
 # fs-test.fs.fat.out: Summary: PASS: 19 FAIL: 0
-# Total Summary: TOTAL PASS: 92 TOTAL FAIL: 22
+# EXT4 directory index (htree) tests:
+# fs-test.htree.ext4.out: Summary: PASS: 5 FAIL: 0
+# Total Summary: TOTAL PASS: 97 TOTAL FAIL: 22
 
 # pre-requisite binaries list.
-PREREQ_BINS="md5sum mkfs mount umount dd fallocate mkdir"
+PREREQ_BINS="md5sum mkfs mount umount dd fallocate mkdir mkfs.ext4 e2fsck"
 
 # All generated output files from this test will be in $OUT_DIR
 # Hence everything is sandboxed.
@@ -47,6 +49,12 @@ MD5_FILE="${OUT_DIR}/md5s.list"
 # $OUT shall be the prefix of the test output. Their suffix will be .out
 OUT="${OUT_DIR}/fs-test"
 
+# $HTREE_IMG is an ext4 image with a large indexed directory, /htree
+HTREE_IMG="${OUT_DIR}/htree.ext4.img"
+
+# Number of files in /htree, enough for a two-level index with 1KB blocks
+HTREE_FILES=8000
+
 # Full Path of the 1 MB file that shall be created in the fs image.
 MB1="${MOUNT_DIR}/${SMALL_FILE}"
 GB2p5="${MOUNT_DIR}/${BIG_FILE}"
@@ -399,8 +407,8 @@ function pass_fail() {
 check_md5() {
 	# md5sum in u-boot has output of form:
 	# md5 for 01000008 ... 01100007 ==> <md5>
-	# the 7th field is the actual md5
-	md5_src=`grep -A3 "$1" "$2" | grep "md5 for"`
+	# the 7th field is the actual md5. The console may end lines with CR LF.
+	md5_src=`grep -A3 "$1" "$2" | grep "md5 for" | tr -d '\r'`
 	md5_src=($md5_src)
 	md5_src=${md5_src[6]}
 
@@ -490,6 +498,99 @@ function check_results() {
 	echo "** End $1"
 }
 
+# 1st parameter is the name of the image file to be created
+# 2nd parameter is the file where we generate the md5s of the files we read
+# The image has a directory, /htree, with $HTREE_FILES files named file-<n>,
+# each holding the line "htree file <n>". It is built from a directory tree
+# so that no mount is needed, then e2fsck adds the hash index. The 64bit
+# feature is turned off, since U-Boot does not support it.
+function create_htree_image() {
+	if [ ! -f "$1" ]; then
+		tree="${OUT_DIR}/htree.tree"
+		rm -rf "$tree"
+		mkdir -p "$tree/htree"
+		for ((i = 1; i <= HTREE_FILES; i++)); do
+			echo "htree file $i" > "$tree/htree/file-$i"
+		done
+		mkfs.ext4 -q -F -b 1024 -N $((HTREE_FILES + 1000)) -O ^64bit \
+			-d "$tree" "$1" 24M &> /dev/null
+		if [ $? -ne 0 ]; then
+			echo Could not create htree filesystem
+			exit $?
+		fi
+		rm -rf "$tree"
+
+		# e2fsck returns 1 when it has changed the filesystem
+		e2fsck -fyD "$1" &> /dev/null
+		if [ $? -gt 1 ]; then
+			echo Could not index htree filesystem
+			exit $?
+		fi
+	fi
+
+	for n in 1 $((HTREE_FILES / 2 + 1)) $HTREE_FILES; do
+		echo "htree file $n" | md5sum >> "$2"
+	done
+}
+
+# 1st parameter is the htree image file
+# Reads files from the start, middle and end of the indexed directory,
+# looks up a name which is not there and lists the directory.
+# UBOOT is set in env
+function test_htree() {
+	addr="0x01000008"
+
+	$UBOOT << EOF
+sb bind 0 "$1"
+# Test Case 1a - load the first file of an indexed directory
+ext4load host 0:0 $addr /htree/file-1
+# Test Case 1b - check the first file of an indexed directory
+md5sum $addr \$filesize
+setenv filesize
+
+# Test Case 2a - load a file from the middle of an indexed directory
+ext4load host 0:0 $addr /htree/file-$((HTREE_FILES / 2 + 1))
+# Test Case 2b - check the middle file of an indexed directory
+md5sum $addr \$filesize
+setenv filesize
+
+# Test Case 3a - load the last file of an indexed directory
+load host 0:0 $addr /htree/file-$HTREE_FILES
+# Test Case 3b - check the last file of an indexed directory
+md5sum $addr \$filesize
+setenv filesize
+
+# Test Case 4 - look up a name which is not in the directory
+ext4load host 0:0 $addr /htree/file-0
+
+# Test Case 5 - list the indexed directory
+ext4ls host 0:0 /htree
+reset
+
+EOF
+}
+
+# 1st parameter is the name of the output file to check
+# 2nd parameter is the name of the file containing the md5 expected
+function check_htree_results() {
+	echo "** Start $1"
+
+	PASS=0
+	FAIL=0
+
+	check_md5 "Test Case 1b " "$1" "$2" 1 "HTREE1: load of first file"
+	check_md5 "Test Case 2b " "$1" "$2" 2 "HTREE2: load of middle file"
+	check_md5 "Test Case 3b " "$1" "$2" 3 "HTREE3: load of last file"
+
+	grep -A3 "Test Case 4 " "$1" | grep -q "File not found"
+	pass_fail "HTREE4: missing name is not found"
+
+	[ `grep -A$((HTREE_FILES + 4)) "Test Case 5 " "$1" | \
+		egrep -c " file-[0-9]+"` -eq $HTREE_FILES ]
+	pass_fail "HTREE5: ls shows all $HTREE_FILES files"
+	echo "** End $1"
+}
+
 # Takes in one parameter which is "fs" or "nonfs", which then dictates
 # if a fs test (size/load/save) or a nonfs test (fatread/extread) needs to
 # be performed.
@@ -562,6 +663,18 @@ for fs in ext4 fat; do
 	test_fs_nonfs fs
 done
 
+# Test lookups in an ext4 directory with a hash index (htree)
+echo "Creating htree image if not already present."
+MD5_FILE_FS="${MD5_FILE}.htree"
+create_htree_image $HTREE_IMG $MD5_FILE_FS
+OUT_FILE="${OUT}.htree.ext4.out"
+test_htree $HTREE_IMG > ${OUT_FILE} 2>&1
+check_htree_results $OUT_FILE $MD5_FILE_FS
+TOTAL_FAIL=$((TOTAL_FAIL + FAIL))
+TOTAL_PASS=$((TOTAL_PASS + PASS))
+echo "Summary: PASS: $PASS FAIL: $FAIL"
+echo "--------------------------------------------"
+
 echo "Total Summary: TOTAL PASS: $TOTAL_PASS TOTAL FAIL: $TOTAL_FAIL"
 echo "--------------------------------------------"
 if [ $TOTAL_FAIL -eq 0 ]; then
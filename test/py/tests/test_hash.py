@@ -0,0 +1,26 @@
+# SPDX-License-Identifier: GPL-2.0
+
+import pytest
+import u_boot_utils
+
+@pytest.mark.buildconfigspec('cmd_hash')
+def test_hash_bench(u_boot_console):
+    """Test that 'hash bench' reports a throughput for each algorithm."""
+
+    response = u_boot_console.run_command('hash bench 10000')
+    assert('Hashing 65536 bytes:' in response)
+    assert('crc32' in response)
+    assert('KB/s' in response)
+
+@pytest.mark.buildconfigspec('cmd_hash')
+@pytest.mark.buildconfigspec('sha256')
+def test_hash_sha256(u_boot_console):
+    """Test the SHA256 digest of a memory area spanning many blocks, which
+    takes the bulk block-processing path."""
+
+    addr = '%08x' % u_boot_utils.find_ram_base(u_boot_console)
+    u_boot_console.run_command('mw.b %s 61 1000' % addr)
+    response = u_boot_console.run_command('hash sha256 %s 1000' % addr)
+    expected = ('c93eee2d0db02f10acc7460d9576e122'
+                'dcf8cd53c4bf8dfcae1b3e74ebcfff5a')
+    assert(expected in response)
@@ -0,0 +1,521 @@
+/*
+ * Convert a device tree binary into C platform data for SPL
+ *
+ * Each enabled node with a compatible string becomes a U_BOOT_DEVICE()
+ * whose platdata holds the node's properties. Drivers then read their
+ * configuration from a C structure, so SPL needs neither the device tree
+ * nor libfdt.
+ *
+ * Two outputs are produced from the same .dtb:
+ *
+ *   structs	- a header with one 'struct dtd_<compatible>' per compatible
+ *		  string, holding every property used by nodes of that type
+ *   platdata	- C source declaring a struct and a U_BOOT_DEVICE() for each
+ *		  node
+ *
+ * The driver name is the first compatible string with every character
+ * which is not valid in a C identifier replaced by '_', so a driver with
+ * .name = "rockchip_rk3288_uart" picks up nodes compatible with
+ * "rockchip,rk3288-uart".
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <../include/libfdt.h>
+
+/* Property types, in order of increasing generality */
+enum prop_type {
+	TYPE_BOOL,	/* Empty property */
+	TYPE_INT,	/* One or more 32-bit cells */
+	TYPE_STRING,	/* One or more strings */
+	TYPE_BYTE,	/* Anything else */
+};
+
+/* A member of a struct dtd_..., merged across all nodes of that type */
+struct member {
+	const char *name;	/* Property name in the device tree */
+	enum prop_type type;
+	int count;		/* Number of cells, strings or bytes (max) */
+	int size;		/* Size of the value in bytes (max) */
+	bool present;		/* Also add <name>_present (some values empty) */
+	struct member *next;
+};
+
+/* A struct dtd_... generated for a compatible string */
+struct dtd {
+	const char *compat;	/* First compatible string */
+	struct member *members;	/* Sorted by name */
+	struct dtd *next;	/* Sorted by compatible string */
+};
+
+/* Properties which are used to find devices, not to configure them */
+static const char *const prop_ignore[] = {
+	"#address-cells",
+	"#gpio-cells",
+	"#size-cells",
+	"compatible",
+	"linux,phandle",
+	"phandle",
+	"status",
+	"u-boot,dm-pre-reloc",
+};
+
+static const char *prog;
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: %s [-o <output>] structs|platdata <dtb>\n",
+		prog);
+	exit(EXIT_FAILURE);
+}
+
+static void *xalloc(size_t size)
+{
+	void *ptr = calloc(1, size);
+
+	if (!ptr) {
+		fprintf(stderr, "%s: Out of memory\n", prog);
+		exit(EXIT_FAILURE);
+	}
+
+	return ptr;
+}
+
+static void *read_dtb(const char *fname)
+{
+	void *blob;
+	long size;
+	FILE *fd;
+	int ret;
+
+	fd = fopen(fname, "rb");
+	if (!fd || fseek(fd, 0, SEEK_END) || (size = ftell(fd)) < 0) {
+		fprintf(stderr, "%s: Cannot open '%s': %s\n", prog, fname,
+			strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	rewind(fd);
+	blob = xalloc(size);
+	if (fread(blob, 1, size, fd) != size) {
+		fprintf(stderr, "%s: Cannot read '%s'\n", prog, fname);
+		exit(EXIT_FAILURE);
+	}
+	fclose(fd);
+	ret = fdt_check_header(blob);
+	if (ret || fdt_totalsize(blob) > size) {
+		fprintf(stderr, "%s: '%s' is not a valid device tree: %s\n",
+			prog, fname, fdt_strerror(ret ? ret : -FDT_ERR_TRUNCATED));
+		exit(EXIT_FAILURE);
+	}
+
+	return blob;
+}
+
+/* Write a name as a C identifier */
+static void put_ident(FILE *out, const char *name)
+{
+	for (; *name; name++)
+		fputc(isalnum((unsigned char)*name) ? *name : '_', out);
+}
+
+static bool ident_eq(const char *a, const char *b)
+{
+	for (; *a && *b; a++, b++) {
+		if ((isalnum((unsigned char)*a) ? *a : '_') !=
+		    (isalnum((unsigned char)*b) ? *b : '_'))
+			return false;
+	}
+
+	return !*a && !*b;
+}
+
+static bool prop_ignored(const char *name)
+{
+	int i;
+
+	for (i = 0; i < sizeof(prop_ignore) / sizeof(prop_ignore[0]); i++) {
+		if (!strcmp(name, prop_ignore[i]))
+			return true;
+	}
+
+	return false;
+}
+
+/* Count the strings in a property, or return 0 if it is not a string list */
+static int count_strings(const char *val, int len)
+{
+	const char *end = val + len;
+	int count = 0;
+
+	if (!len || val[len - 1])
+		return 0;
+	while (val < end) {
+		const char *start = val;
+
+		while (*val && isprint((unsigned char)*val))
+			val++;
+		if (*val || val == start)
+			return 0;
+		val++;
+		count++;
+	}
+
+	return count;
+}
+
+static enum prop_type prop_type(const void *val, int len, int *countp)
+{
+	int count;
+
+	if (!len) {
+		*countp = 0;
+		return TYPE_BOOL;
+	}
+	count = count_strings(val, len);
+	if (count) {
+		*countp = count;
+		return TYPE_STRING;
+	}
+	if (!(len % 4)) {
+		*countp = len / 4;
+		return TYPE_INT;
+	}
+	*countp = len;
+
+	return TYPE_BYTE;
+}
+
+/* Check whether a node should become a device */
+static const char *node_compat(const void *blob, int node)
+{
+	const char *status;
+
+	status = fdt_getprop(blob, node, "status", NULL);
+	if (status && strcmp(status, "okay") && strcmp(status, "ok"))
+		return NULL;
+
+	return fdt_getprop(blob, node, "compatible", NULL);
+}
+
+static struct dtd *find_dtd(struct dtd **headp, const char *compat)
+{
+	struct dtd **dp, *dtd;
+	int cmp = 1;
+
+	for (dp = headp; *dp; dp = &(*dp)->next) {
+		cmp = strcmp((*dp)->compat, compat);
+		if (cmp >= 0)
+			break;
+	}
+	if (*dp && !cmp)
+		return *dp;
+	dtd = xalloc(sizeof(*dtd));
+	dtd->compat = compat;
+	dtd->next = *dp;
+	*dp = dtd;
+
+	return dtd;
+}
+
+static void add_member(struct dtd *dtd, const char *name, enum prop_type type,
+		       int count, int size)
+{
+	struct member **mp, *member;
+	int cmp = 1;
+
+	for (mp = &dtd->members; *mp; mp = &(*mp)->next) {
+		cmp = strcmp((*mp)->name, name);
+		if (cmp >= 0)
+			break;
+	}
+	if (*mp && !cmp) {
+		member = *mp;
+		/*
+		 * An empty value has nowhere to go in a value member, so record
+		 * that the property was there in a separate bool instead.
+		 */
+		if (type == TYPE_BOOL && member->type != TYPE_BOOL) {
+			member->present = true;
+		} else if (type != TYPE_BOOL && member->type == TYPE_BOOL) {
+			member->present = true;
+			member->type = type;
+		} else if (type != member->type) {
+			/* Nodes disagree on the type, so fall back to bytes */
+			member->type = TYPE_BYTE;
+		}
+	} else {
+		member = xalloc(sizeof(*member));
+		member->name = name;
+		member->type = type;
+		member->next = *mp;
+		*mp = member;
+	}
+	if (count > member->count)
+		member->count = count;
+	if (size > member->size)
+		member->size = size;
+
+	/* Every value is copied as it is, so the array must hold the largest */
+	if (member->type == TYPE_BYTE)
+		member->count = member->size;
+}
+
+/* Build the list of structures needed by all the devices in the tree */
+static struct dtd *scan_tree(const void *blob)
+{
+	struct dtd *head = NULL;
+	int node, prop;
+
+	for (node = fdt_next_node(blob, 0, NULL); node >= 0;
+	     node = fdt_next_node(blob, node, NULL)) {
+		const char *compat = node_compat(blob, node);
+		struct dtd *dtd;
+
+		if (!compat)
+			continue;
+		dtd = find_dtd(&head, compat);
+		for (prop = fdt_first_property_offset(blob, node); prop >= 0;
+		     prop = fdt_next_property_offset(blob, prop)) {
+			const char *name;
+			const void *val;
+			int len, count;
+			enum prop_type type;
+
+			val = fdt_getprop_by_offset(blob, prop, &name, &len);
+			if (prop_ignored(name))
+				continue;
+			type = prop_type(val, len, &count);
+			add_member(dtd, name, type, count, len);
+		}
+	}
+
+	return head;
+}
+
+static struct member *find_member(struct dtd *dtd, const char *name)
+{
+	struct member *member;
+
+	for (member = dtd->members; member; member = member->next) {
+		if (!strcmp(member->name, name))
+			return member;
+	}
+
+	return NULL;
+}
+
+static void write_structs(FILE *out, struct dtd *head)
+{
+	static const char *const ctype[] = {
+		[TYPE_BOOL] = "bool",
+		[TYPE_INT] = "u32",
+		[TYPE_STRING] = "const char *",
+		[TYPE_BYTE] = "unsigned char",
+	};
+	struct member *member;
+	struct dtd *dtd;
+
+	fprintf(out, "#include <linux/types.h>\n");
+	for (dtd = head; dtd; dtd = dtd->next) {
+		fprintf(out, "\nstruct dtd_");
+		put_ident(out, dtd->compat);
+		fprintf(out, " {\n");
+		for (member = dtd->members; member; member = member->next) {
+			fprintf(out, "\t%s%s", ctype[member->type],
+				member->type == TYPE_STRING ? "" : "\t");
+			put_ident(out, member->name);
+			if (member->type != TYPE_BOOL &&
+			    (member->count > 1 || member->type == TYPE_BYTE))
+				fprintf(out, "[%d]", member->count);
+			fprintf(out, ";\n");
+			if (member->present) {
+				fprintf(out, "\t%s\t", ctype[TYPE_BOOL]);
+				put_ident(out, member->name);
+				fprintf(out, "_present;\n");
+			}
+		}
+		fprintf(out, "};\n");
+	}
+}
+
+static void write_value(FILE *out, const struct member *member,
+			const void *val, int len)
+{
+	const unsigned char *ptr = val;
+	const char *str = val;
+	int i;
+
+	switch (member->type) {
+	case TYPE_BOOL:
+		fprintf(out, "true");
+		return;
+	case TYPE_STRING:
+		if (member->count > 1)
+			fprintf(out, "{");
+		for (i = 0; str < (const char *)val + len; i++) {
+			fprintf(out, "%s\"", i ? ", " : "");
+			for (; *str; str++) {
+				if (*str == '"' || *str == '\\')
+					fputc('\\', out);
+				fputc(*str, out);
+			}
+			fprintf(out, "\"");
+			str++;
+		}
+		if (member->count > 1)
+			fprintf(out, "}");
+		return;
+	case TYPE_INT:
+		if (member->count == 1) {
+			fprintf(out, "0x%x", fdt32_to_cpu(*(fdt32_t *)val));
+			return;
+		}
+		fprintf(out, "{");
+		for (i = 0; i < len / 4; i++)
+			fprintf(out, "%s0x%x", i ? ", " : "",
+				fdt32_to_cpu(((fdt32_t *)val)[i]));
+		fprintf(out, "}");
+		return;
+	case TYPE_BYTE:
+		fprintf(out, "{");
+		for (i = 0; i < len; i++)
+			fprintf(out, "%s0x%02x", i ? ", " : "", ptr[i]);
+		fprintf(out, "}");
+		return;
+	}
+}
+
+/*
+ * Write out the name used for a node's variables. Nodes are named after
+ * the device tree node, with a suffix if an earlier node had the same name.
+ */
+static void put_node_ident(FILE *out, const void *blob, int node)
+{
+	const char *name = fdt_get_name(blob, node, NULL);
+	int other, dup = 0;
+
+	for (other = fdt_next_node(blob, 0, NULL); other >= 0 && other < node;
+	     other = fdt_next_node(blob, other, NULL)) {
+		if (node_compat(blob, other) &&
+		    ident_eq(fdt_get_name(blob, other, NULL), name))
+			dup++;
+	}
+	put_ident(out, name);
+	if (dup)
+		fprintf(out, "_%d", dup);
+}
+
+static void write_platdata(FILE *out, const void *blob, struct dtd *head)
+{
+	int node, prop;
+
+	fprintf(out, "#include <common.h>\n");
+	fprintf(out, "#include <dm.h>\n");
+	fprintf(out, "#include <dt-structs.h>\n");
+	for (node = fdt_next_node(blob, 0, NULL); node >= 0;
+	     node = fdt_next_node(blob, node, NULL)) {
+		const char *compat = node_compat(blob, node);
+		struct dtd *dtd;
+
+		if (!compat)
+			continue;
+		dtd = find_dtd(&head, compat);
+		fprintf(out, "\nstatic struct dtd_");
+		put_ident(out, compat);
+		fprintf(out, " dtv_");
+		put_node_ident(out, blob, node);
+		fprintf(out, " = {\n");
+		for (prop = fdt_first_property_offset(blob, node); prop >= 0;
+		     prop = fdt_next_property_offset(blob, prop)) {
+			const struct member *member;
+			const char *name;
+			const void *val;
+			int len;
+
+			val = fdt_getprop_by_offset(blob, prop, &name, &len);
+			if (prop_ignored(name))
+				continue;
+			member = find_member(dtd, name);
+			if (len || member->type == TYPE_BOOL) {
+				fprintf(out, "\t.");
+				put_ident(out, name);
+				fprintf(out, " = ");
+				write_value(out, member, val, len);
+				fprintf(out, ",\n");
+			}
+			if (member->present) {
+				fprintf(out, "\t.");
+				put_ident(out, name);
+				fprintf(out, "_present = true,\n");
+			}
+		}
+		fprintf(out, "};\n");
+		fprintf(out, "U_BOOT_DEVICE(");
+		put_node_ident(out, blob, node);
+		fprintf(out, ") = {\n\t.name\t\t= \"");
+		put_ident(out, compat);
+		fprintf(out, "\",\n\t.platdata\t= &dtv_");
+		put_node_ident(out, blob, node);
+		fprintf(out, ",\n};\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const char *outname = NULL;
+	struct dtd *head;
+	FILE *out = stdout;
+	void *blob;
+	int opt;
+
+	prog = argv[0];
+	while ((opt = getopt(argc, argv, "o:")) != -1) {
+		switch (opt) {
+		case 'o':
+			outname = optarg;
+			break;
+		default:
+			usage();
+		}
+	}
+	if (argc - optind != 2)
+		usage();
+
+	if (strcmp(argv[optind], "structs") && strcmp(argv[optind], "platdata")) {
+		fprintf(stderr, "%s: Unknown output type '%s'\n", prog,
+			argv[optind]);
+		usage();
+	}
+
+	blob = read_dtb(argv[optind + 1]);
+	head = scan_tree(blob);
+	if (outname) {
+		out = fopen(outname, "w");
+		if (!out) {
+			fprintf(stderr, "%s: Cannot create '%s': %s\n", prog,
+				outname, strerror(errno));
+			return EXIT_FAILURE;
+		}
+	}
+	fprintf(out, "/*\n * DO NOT MODIFY\n *\n");
+	fprintf(out, " * This file was generated by dtoc from a .dtb (device tree binary) file.\n */\n\n");
+	if (!strcmp(argv[optind], "structs"))
+		write_structs(out, head);
+	else
+		write_platdata(out, blob, head);
+	if (outname && fclose(out)) {
+		fprintf(stderr, "%s: Cannot write '%s'\n", prog, outname);
+		unlink(outname);
+		return EXIT_FAILURE;
+	}
+
+	return 0;
+}
@@ -22,6 +22,7 @@
 #include <trace.h>
 
 #define MAX_LINE_LEN 500
+#define MAX_CALL_DEPTH 256	/* Deepest call stack tracked by dump-json */
 
 enum {
 	FUNCF_TRACE	= 1 << 0,	/* Include this function in trace */
@@ -32,6 +33,7 @@ struct func_info {
 	const char *name;
 	unsigned long code_size;
 	unsigned long call_count;
+	unsigned long sample_count;	/* profiler samples in this function */
 	unsigned flags;
 	/* the section this function is in */
 	struct objsection_info *objsection;
@@ -56,6 +58,10 @@ struct func_info *func_list;
 int func_count;
 struct trace_call *call_list;
 int call_count;
+struct trace_output_mark *mark_list;
+int mark_count;
+struct trace_sample *sample_list;
+int sample_count;
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
@@ -86,6 +92,9 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-json\t\tDump out Chrome trace-event JSON\n"
+		"   dump-profile\t\tDump out a flat profile from samples\n"
+		"   dump-callers\t\tDump out a caller profile from samples\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
@@ -227,6 +236,49 @@ static int read_calls(FILE *fin, int count)
 	return 0;
 }
 
+static int read_marks(FILE *fin, int count)
+{
+	struct trace_output_mark *mark;
+	int i;
+
+	notice("bootstage mark count: %d\n", count);
+	mark_list = (struct trace_output_mark *)calloc(count, sizeof(*mark));
+	if (!mark_list) {
+		error("Cannot allocate mark_list\n");
+		return -1;
+	}
+	mark_count = count;
+
+	mark = mark_list;
+	for (i = 0; i < count; i++, mark++) {
+		if (read_data(fin, mark, sizeof(*mark)))
+			return 1;
+		mark->name[TRACE_MARK_NAME_LEN - 1] = '\0';
+	}
+	return 0;
+}
+
+static int read_samples(FILE *fin, int count)
+{
+	struct trace_sample *sample;
+	int i;
+
+	notice("profiler sample count: %d\n", count);
+	sample_list = (struct trace_sample *)calloc(count, sizeof(*sample));
+	if (!sample_list) {
+		error("Cannot allocate sample_list\n");
+		return -1;
+	}
+	sample_count = count;
+
+	sample = sample_list;
+	for (i = 0; i < count; i++, sample++) {
+		if (read_data(fin, sample, sizeof(*sample)))
+			return 1;
+	}
+	return 0;
+}
+
 static int read_profile(FILE *fin, int *not_found)
 {
 	struct trace_output_hdr hdr;
@@ -250,6 +302,16 @@ static int read_profile(FILE *fin, int *not_found)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_BOOTSTAGE:
+			if (read_marks(fin, hdr.rec_count))
+				return 1;
+			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -533,6 +595,248 @@ static int make_ftrace(void)
 	return 0;
 }
 
+static void out_json_string(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			putchar('\\');
+		if ((unsigned char)*str >= ' ')
+			putchar(*str);
+	}
+	putchar('"');
+}
+
+static void out_json_event(const char *name, const char *cat,
+			   ulong start, long duration, int tid)
+{
+	printf(",\n{\"name\":");
+	out_json_string(name);
+	printf(",\"cat\":\"%s\",", cat);
+	if (duration < 0)
+		printf("\"ph\":\"i\",\"s\":\"g\",\"ts\":%lu", start);
+	else
+		printf("\"ph\":\"X\",\"ts\":%lu,\"dur\":%ld", start, duration);
+	printf(",\"pid\":1,\"tid\":%d}", tid);
+}
+
+/*
+ * Write the trace in the Chrome trace-event format, as read by
+ * chrome://tracing and Perfetto. Each traced call becomes a complete ('X')
+ * event, so the viewer nests them by time. Bootstage marks are instant
+ * events and initcalls are intervals, on a second thread so they line up
+ * with the calls:
+ *
+ * {"traceEvents":[
+ * {"name":"process_name","ph":"M",...},
+ * {"name":"board_init_f","cat":"bootstage","ph":"i","s":"g","ts":1804,...},
+ * {"name":"initr_dm","cat":"func","ph":"X","ts":2010,"dur":460,...},
+ * ...
+ * ],"displayTimeUnit":"ms"}
+ */
+static int make_json(void)
+{
+	struct {
+		uint32_t func;
+		ulong time;
+	} stack[MAX_CALL_DEPTH];
+	struct trace_output_mark *mark;
+	struct trace_call *call;
+	int missing_count = 0, skip_count = 0;
+	int depth = 0;
+	int i;
+
+	printf("{\"traceEvents\":[\n"
+	       "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"U-Boot\"}},\n"
+	       "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"functions\"}},\n"
+	       "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"bootstage\"}}");
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		struct func_info *func = find_func_by_offset(call->func);
+		ulong time = call->flags & FUNCF_TIMESTAMP_MASK;
+
+		if (TRACE_CALL_TYPE(call) == FUNCF_ENTRY) {
+			if (!func) {
+				warn("Cannot find function at %lx\n",
+				     text_offset + call->func);
+				missing_count++;
+				continue;
+			}
+			if (!(func->flags & FUNCF_TRACE)) {
+				skip_count++;
+				continue;
+			}
+			if (depth < MAX_CALL_DEPTH) {
+				stack[depth].func = call->func;
+				stack[depth].time = time;
+			}
+			depth++;
+		} else if (TRACE_CALL_TYPE(call) == FUNCF_EXIT) {
+			int level;
+
+			/* Find the matching entry; unmatched exits are ignored */
+			for (level = MIN(depth, MAX_CALL_DEPTH) - 1; level >= 0;
+			     level--) {
+				if (stack[level].func == call->func)
+					break;
+			}
+			if (level < 0)
+				continue;
+			out_json_event(func->name, "func", stack[level].time,
+				       time - stack[level].time, 1);
+			depth = level;
+		}
+	}
+	for (i = 0, mark = mark_list; i < mark_count; i++, mark++) {
+		if (mark->duration_us)
+			out_json_event(mark->name, "initcall", mark->start_us,
+				       mark->duration_us, 2);
+		else
+			out_json_event(mark->name, "bootstage", mark->start_us,
+				       -1, 2);
+	}
+	printf("\n],\"displayTimeUnit\":\"ms\"}\n");
+	info("json: %d functions not found, %d excluded\n", missing_count,
+	     skip_count);
+
+	return 0;
+}
+
+/* The number of samples taken in a function, called from a caller */
+struct sample_edge {
+	int func;	/* index into func_list */
+	int caller;	/* index into func_list, or -1 if unknown */
+	unsigned long count;
+};
+
+static int h_cmp_sample_count(const void *v1, const void *v2)
+{
+	const struct func_info *f1 = *(struct func_info **)v1;
+	const struct func_info *f2 = *(struct func_info **)v2;
+
+	if (f1->sample_count != f2->sample_count)
+		return f1->sample_count < f2->sample_count ? 1 : -1;
+
+	return f1 < f2 ? -1 : f1 > f2;
+}
+
+static int h_cmp_edge(const void *v1, const void *v2)
+{
+	const struct sample_edge *e1 = v1, *e2 = v2;
+
+	if (e1->func != e2->func)
+		return e1->func - e2->func;
+
+	return e1->caller - e2->caller;
+}
+
+static int h_cmp_edge_count(const void *v1, const void *v2)
+{
+	const struct sample_edge *e1 = v1, *e2 = v2;
+	unsigned long c1 = func_list[e1->func].sample_count;
+	unsigned long c2 = func_list[e2->func].sample_count;
+
+	/* Keep each function's callers together, in profile order */
+	if (c1 != c2)
+		return c1 < c2 ? 1 : -1;
+	if (e1->func != e2->func)
+		return e1->func - e2->func;
+	if (e1->count != e2->count)
+		return e1->count < e2->count ? 1 : -1;
+
+	return e1->caller - e2->caller;
+}
+
+static const char *edge_caller_name(struct sample_edge *edge)
+{
+	return edge->caller < 0 ? "(unknown)" : func_list[edge->caller].name;
+}
+
+/*
+ * Write a profile from the profiler samples. The flat profile lists the
+ * functions where the samples landed, most first:
+ *
+ *  Samples   Self  Cumul  Function
+ *      412  38.2%  38.2%  lzma_decode
+ *      108  10.0%  48.2%  memcpy
+ *
+ * With callers, each function is followed by the functions it was called
+ * from, with the number of samples for each.
+ */
+static int make_profile(int callers)
+{
+	struct sample_edge *edges, *edge, *end;
+	struct func_info **order, *func;
+	unsigned long total = 0, cumul = 0;
+	int missing_count = 0, edge_count = 0;
+	int i;
+
+	edges = calloc(sample_count + 1, sizeof(*edges));
+	order = calloc(func_count + 1, sizeof(*order));
+	if (!edges || !order) {
+		error("Cannot allocate profile\n");
+		return -1;
+	}
+	for (i = 0; i < sample_count; i++) {
+		struct trace_sample *sample = &sample_list[i];
+		struct func_info *caller = NULL;
+
+		func = find_caller_by_offset(sample->pc);
+		if (!func) {
+			missing_count++;
+			continue;
+		}
+		func->sample_count++;
+		total++;
+		if (sample->caller != TRACE_SAMPLE_NONE)
+			caller = find_caller_by_offset(sample->caller);
+		edge = &edges[edge_count++];
+		edge->func = func - func_list;
+		edge->caller = caller ? caller - func_list : -1;
+		edge->count = 1;
+	}
+
+	/* Merge the samples for each caller of each function */
+	qsort(edges, edge_count, sizeof(*edges), h_cmp_edge);
+	for (i = 1, end = edges; i < edge_count; i++) {
+		if (!h_cmp_edge(end, &edges[i]))
+			end->count++;
+		else
+			*++end = edges[i];
+	}
+	if (edge_count)
+		end++;
+	edge_count = end - edges;
+	qsort(edges, edge_count, sizeof(*edges), h_cmp_edge_count);
+
+	for (i = 0; i < func_count; i++)
+		order[i] = &func_list[i];
+	qsort(order, func_count, sizeof(*order), h_cmp_sample_count);
+
+	printf("%8s %6s %6s  %s\n", "Samples", "Self", "Cumul", "Function");
+	for (i = 0, edge = edges; i < func_count; i++) {
+		func = order[i];
+		if (!func->sample_count)
+			break;
+		cumul += func->sample_count;
+		printf("%8lu %5.1f%% %5.1f%%  %s\n", func->sample_count,
+		       func->sample_count * 100.0 / total,
+		       cumul * 100.0 / total, func->name);
+		for (; edge < end && edge->func == func - func_list; edge++) {
+			if (callers)
+				printf("%8lu %22s<- %s\n", edge->count, "",
+				       edge_caller_name(edge));
+		}
+	}
+	printf("%8lu samples\n", total);
+	if (missing_count)
+		warn("profile: %d samples not found in map file\n",
+		     missing_count);
+	free(order);
+	free(edges);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
 		     const char *trace_config_fname)
@@ -553,6 +857,12 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-json"))
+			err = make_json();
+		else if (0 == strcmp(cmd, "dump-profile"))
+			err = make_profile(0);
+		else if (0 == strcmp(cmd, "dump-callers"))
+			err = make_profile(1);
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}